@@ -0,0 +1,303 @@
+#include "ExportIndex.h"
+#include "proc.h"
+#include "mem.h"
+
+namespace hax {
+
+	namespace proc {
+
+		// the pe headers of a module lie within its first page
+		static constexpr size_t HEADERS_SIZE = 0x1000u;
+
+		static bool isInRange(DWORD rva, size_t size, DWORD rangeRva, DWORD rangeSize);
+
+		ExportIndex::ExportIndex() :
+			_base{}, _dirRva{}, _dirSize{}, _ordinalBase{}, _functionCount{}, _nameCount{},
+			_directory{}, _functions{}, _nameRvas{}, _ordinals{}, _names{},
+			_ownDirectory{}, _ownFunctions{}, _ownNameRvas{}, _ownOrdinals{}, _ownNames{} {}
+
+
+		ExportIndex::~ExportIndex() {
+			this->clear();
+
+			return;
+		}
+
+
+		bool ExportIndex::build(IMemorySource* pSource, HMODULE hMod) {
+			this->clear();
+
+			if (!pSource || !hMod) return false;
+
+			const BYTE* const pBase = reinterpret_cast<const BYTE*>(hMod);
+			const BYTE* headers = pSource->view(pBase, HEADERS_SIZE);
+			BYTE headersCopy[HEADERS_SIZE]{};
+
+			if (!headers) {
+
+				if (!pSource->read(pBase, headersCopy, HEADERS_SIZE)) return false;
+
+				headers = headersCopy;
+			}
+
+			const IMAGE_DOS_HEADER* const pDosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(headers);
+
+			// getPeHeaders does not check if the headers fit into the buffer
+			if (pDosHeader->e_magic != IMAGE_DOS_SIGNATURE || pDosHeader->e_lfanew < 0 || static_cast<size_t>(pDosHeader->e_lfanew) + sizeof(IMAGE_NT_HEADERS64) > HEADERS_SIZE) return false;
+
+			PeHeaders peHeaders{};
+
+			if (!in::getPeHeaders(reinterpret_cast<HMODULE>(const_cast<BYTE*>(headers)), &peHeaders)) return false;
+
+			IMAGE_DATA_DIRECTORY dirEntryExport{};
+
+			if (peHeaders.pOptHeader64) {
+				dirEntryExport = peHeaders.pOptHeader64->DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+			}
+			else if (peHeaders.pOptHeader32) {
+				dirEntryExport = peHeaders.pOptHeader32->DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+			}
+			else {
+				return false;
+			}
+
+			if (!dirEntryExport.VirtualAddress || dirEntryExport.Size < sizeof(IMAGE_EXPORT_DIRECTORY)) return false;
+
+			this->_base = pBase;
+			this->_dirRva = dirEntryExport.VirtualAddress;
+			this->_dirSize = dirEntryExport.Size;
+
+			// the directory usually contains the tables, the names and the forwards, so it is mostly the only read
+			this->_directory = pSource->view(pBase + this->_dirRva, this->_dirSize);
+
+			if (!this->_directory) {
+				// terminated so strings at the end of a malformed directory are terminated as well
+				this->_ownDirectory = new BYTE[this->_dirSize + 1u]{};
+
+				if (!pSource->read(pBase + this->_dirRva, this->_ownDirectory, this->_dirSize)) {
+					this->clear();
+
+					return false;
+				}
+
+				this->_directory = this->_ownDirectory;
+			}
+
+			IMAGE_EXPORT_DIRECTORY exportDir{};
+			memcpy(&exportDir, this->_directory, sizeof(IMAGE_EXPORT_DIRECTORY));
+
+			this->_ordinalBase = exportDir.Base;
+			this->_functions = reinterpret_cast<const DWORD*>(this->getTable(pSource, exportDir.AddressOfFunctions, exportDir.NumberOfFunctions * sizeof(DWORD), &this->_ownFunctions));
+			this->_nameRvas = reinterpret_cast<const DWORD*>(this->getTable(pSource, exportDir.AddressOfNames, exportDir.NumberOfNames * sizeof(DWORD), &this->_ownNameRvas));
+			this->_ordinals = reinterpret_cast<const WORD*>(this->getTable(pSource, exportDir.AddressOfNameOrdinals, exportDir.NumberOfNames * sizeof(WORD), &this->_ownOrdinals));
+
+			if (!this->_functions || !this->_nameRvas || !this->_ordinals) {
+				this->clear();
+
+				return false;
+			}
+
+			this->_functionCount = exportDir.NumberOfFunctions;
+			this->_nameCount = exportDir.NumberOfNames;
+
+			for (DWORD i = 0ul; i < this->_nameCount; i++) {
+
+				if (!isInRange(this->_nameRvas[i], 1u, this->_dirRva, this->_dirSize)) {
+					this->indexOutsideNames(pSource);
+
+					break;
+				}
+
+			}
+
+			return true;
+		}
+
+
+		DWORD ExportIndex::getFunctionRva(const char* funcName) const {
+
+			if (!this->_functions) return 0ul;
+
+			// export by ordinal if everything but the lowest word of name param is zero
+			const bool byOrdinal = (reinterpret_cast<uintptr_t>(funcName) >> sizeof(WORD) * 0x8) == 0u;
+
+			if (byOrdinal) {
+				const DWORD index = static_cast<DWORD>(reinterpret_cast<uintptr_t>(funcName) & MAXWORD) - this->_ordinalBase;
+
+				if (index >= this->_functionCount) return 0ul;
+
+				return this->_functions[index];
+			}
+
+			// the linker sorts the name table case sensitive, the loader relies on this as well
+			size_t low = 0u;
+			size_t high = this->_nameCount;
+
+			while (low < high) {
+				const size_t mid = low + (high - low) / 2u;
+				const int cmp = strcmp(this->getName(mid), funcName);
+
+				if (!cmp) return this->getFunctionRvaByNameIndex(mid);
+
+				if (cmp < 0) {
+					low = mid + 1u;
+				}
+				else {
+					high = mid;
+				}
+
+			}
+
+			// lookups are case insensitive like GetProcAddress, so names that only differ in case are searched linearly
+			for (size_t i = 0u; i < this->_nameCount; i++) {
+
+				if (!_stricmp(funcName, this->getName(i))) return this->getFunctionRvaByNameIndex(i);
+
+			}
+
+			return 0ul;
+		}
+
+
+		const char* ExportIndex::getForward(DWORD funcRva) const {
+
+			if (!this->_directory || !isInRange(funcRva, 1u, this->_dirRva, this->_dirSize)) return nullptr;
+
+			return reinterpret_cast<const char*>(this->_directory + (funcRva - this->_dirRva));
+		}
+
+
+		const BYTE* ExportIndex::base() const {
+
+			return this->_base;
+		}
+
+
+		size_t ExportIndex::nameCount() const {
+
+			return this->_nameCount;
+		}
+
+
+		void ExportIndex::clear() {
+			delete[] this->_ownDirectory;
+			delete[] this->_ownFunctions;
+			delete[] this->_ownNameRvas;
+			delete[] this->_ownOrdinals;
+			delete[] this->_names;
+			this->_ownNames.resize(0u);
+
+			this->_base = nullptr;
+			this->_dirRva = 0ul;
+			this->_dirSize = 0ul;
+			this->_ordinalBase = 0ul;
+			this->_functionCount = 0ul;
+			this->_nameCount = 0ul;
+			this->_directory = nullptr;
+			this->_functions = nullptr;
+			this->_nameRvas = nullptr;
+			this->_ordinals = nullptr;
+			this->_names = nullptr;
+			this->_ownDirectory = nullptr;
+			this->_ownFunctions = nullptr;
+			this->_ownNameRvas = nullptr;
+			this->_ownOrdinals = nullptr;
+
+			return;
+		}
+
+
+		const void* ExportIndex::getTable(IMemorySource* pSource, DWORD rva, size_t size, BYTE** pOwnTable) const {
+
+			if (isInRange(rva, size, this->_dirRva, this->_dirSize)) return this->_directory + (rva - this->_dirRva);
+
+			const BYTE* const table = pSource->view(this->_base + rva, size);
+
+			if (table) return table;
+
+			*pOwnTable = new BYTE[size ? size : 1u];
+
+			if (!pSource->read(this->_base + rva, *pOwnTable, size)) return nullptr;
+
+			return *pOwnTable;
+		}
+
+
+		void ExportIndex::indexOutsideNames(IMemorySource* pSource) {
+			this->_names = new const char*[this->_nameCount]{};
+			// the owned names vector might be reallocated while names are appended, so offsets are stored until all names are copied
+			size_t* const ownNameOffsets = new size_t[this->_nameCount]{};
+
+			for (DWORD i = 0ul; i < this->_nameCount; i++) {
+				const DWORD rva = this->_nameRvas[i];
+				ownNameOffsets[i] = SIZE_MAX;
+
+				if (isInRange(rva, 1u, this->_dirRva, this->_dirSize)) {
+					this->_names[i] = reinterpret_cast<const char*>(this->_directory + (rva - this->_dirRva));
+
+					continue;
+				}
+
+				const char* const name = reinterpret_cast<const char*>(pSource->view(this->_base + rva, MAX_PATH));
+
+				if (name) {
+					this->_names[i] = name;
+
+					continue;
+				}
+
+				char curName[MAX_PATH]{};
+
+				// unreadable names are indexed as empty names
+				if (!mem::helper::copyString(pSource, curName, this->_base + rva, MAX_PATH)) {
+					curName[0] = '\0';
+				}
+
+				ownNameOffsets[i] = this->_ownNames.size();
+
+				for (size_t j = 0u; j == 0u || curName[j - 1u]; j++) {
+					this->_ownNames.append(curName[j]);
+				}
+
+			}
+
+			for (DWORD i = 0ul; i < this->_nameCount; i++) {
+
+				if (ownNameOffsets[i] != SIZE_MAX) {
+					this->_names[i] = this->_ownNames.data() + ownNameOffsets[i];
+				}
+
+			}
+
+			delete[] ownNameOffsets;
+
+			return;
+		}
+
+
+		const char* ExportIndex::getName(size_t index) const {
+
+			if (this->_names) return this->_names[index];
+
+			return reinterpret_cast<const char*>(this->_directory + (this->_nameRvas[index] - this->_dirRva));
+		}
+
+
+		DWORD ExportIndex::getFunctionRvaByNameIndex(size_t index) const {
+			// the function rva is in the export table indexed by the ordinal in the ordinal table at the same index as the name in the name table
+			const WORD ordinal = this->_ordinals[index];
+
+			if (ordinal >= this->_functionCount) return 0ul;
+
+			return this->_functions[ordinal];
+		}
+
+
+		static bool isInRange(DWORD rva, size_t size, DWORD rangeRva, DWORD rangeSize) {
+
+			return rva >= rangeRva && rva - rangeRva <= rangeSize && size <= rangeSize - (rva - rangeRva);
+		}
+
+	}
+
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include "scan\IMemorySource.h"
+#include "Vector.h"
+
+// Class to look up exports of a module without walking its export directory for every lookup.
+// The export directory is read with a few bulk reads once and the sorted name table is binary searched.
+
+namespace hax {
+
+	namespace proc {
+
+		class ExportIndex {
+		private:
+			const BYTE* _base;
+			DWORD _dirRva;
+			DWORD _dirSize;
+			DWORD _ordinalBase;
+			DWORD _functionCount;
+			DWORD _nameCount;
+			// point into the module if the memory source can be accessed in place and into the owned buffers otherwise
+			const BYTE* _directory;
+			const DWORD* _functions;
+			const DWORD* _nameRvas;
+			const WORD* _ordinals;
+			// only set if a name lies outside of the export directory, names are taken from the directory otherwise
+			const char** _names;
+			BYTE* _ownDirectory;
+			BYTE* _ownFunctions;
+			BYTE* _ownNameRvas;
+			BYTE* _ownOrdinals;
+			// copies of names outside of the export directory
+			Vector<char> _ownNames;
+
+		public:
+			ExportIndex();
+
+			ExportIndex(ExportIndex&&) = delete;
+
+			ExportIndex(const ExportIndex&) = delete;
+
+			ExportIndex& operator=(ExportIndex&&) = delete;
+
+			ExportIndex& operator=(const ExportIndex&) = delete;
+
+			~ExportIndex();
+
+			// Builds the index of the exports of a module. Replaces a previously built index.
+			// The export directory and its tables are read in bulk. If the memory source can be accessed in place nothing is copied.
+			// 
+			// Parameters:
+			// 
+			// [in] pSource:
+			// The memory source that contains the module, eg. a hax::ex::MemorySource for a module of an external process.
+			// 
+			// [in] hMod:
+			// Handle to the module within the address space of the memory source.
+			// 
+			// Return:
+			// True on success, false on failure or if the module has no exports.
+			bool build(IMemorySource* pSource, HMODULE hMod);
+
+			// Gets the relative virtual address of an exported function.
+			// Names are binary searched in the name table, which the linker sorts. Names that only match case insensitive are found by a linear search.
+			// 
+			// Parameters:
+			// 
+			// [in] funcName:
+			// Export name or ordinal of the exported function.
+			// 
+			// Return:
+			// The relative virtual address of the function or zero if it was not found.
+			DWORD getFunctionRva(const char* funcName) const;
+
+			// Gets the forward string of a forwarded function.
+			// Forwarders are not resolved when the index is built, they have to be resolved by the caller when they are looked up.
+			// 
+			// Parameters:
+			// 
+			// [in] funcRva:
+			// Relative virtual address of the function as returned by getFunctionRva.
+			// 
+			// Return:
+			// The forward in the format "module.function" or "module.#ordinal" or nullptr if the function is not forwarded.
+			const char* getForward(DWORD funcRva) const;
+
+			// Gets the base address of the indexed module.
+			// 
+			// Return:
+			// The base address within the address space of the memory source or nullptr if no index was built.
+			const BYTE* base() const;
+
+			// Gets the amount of functions exported by name.
+			// 
+			// Return:
+			// The amount of names in the name table.
+			size_t nameCount() const;
+
+			// Frees the index.
+			void clear();
+
+		private:
+			const void* getTable(IMemorySource* pSource, DWORD rva, size_t size, BYTE** pOwnTable) const;
+			void indexOutsideNames(IMemorySource* pSource);
+			const char* getName(size_t index) const;
+			DWORD getFunctionRvaByNameIndex(size_t index) const;
+		};
+
+	}
+
+}
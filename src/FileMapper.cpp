@@ -3,7 +3,7 @@
 
 namespace hax {
 	
-	FileMapper::FileMapper(const char* path) : _path{ path }, _data{}, _size{} {
+	FileMapper::FileMapper(const char* path) : _path{ path }, _data{}, _size{}, _image{} {
 		const size_t length = strlen(path);
 		
 		this->_path = new char[length + 1];
@@ -62,6 +62,7 @@ namespace hax {
 		}
 
 		CloseHandle(hMapping);
+		this->_image = image;
 
 		return ERROR_SUCCESS;
 	}
@@ -74,6 +75,8 @@ namespace hax {
 			this->_data = nullptr;
 		}
 
+		this->_image = false;
+
 		return;
 	}
 
@@ -95,4 +98,10 @@ namespace hax {
 		return this->_size;
 	}
 
+
+	bool FileMapper::isImage() const {
+
+		return this->_image;
+	}
+
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ namespace hax {
 		const char* _path;
 		const BYTE* _data;
 		size_t _size;
+		bool _image;
 
 	public:
 		// Initializes members.
@@ -52,6 +53,12 @@ namespace hax {
 		// Return:
 		// Size of the file in bytes.
 		size_t size() const;
+
+		// Gets if the file is mapped as a PE image.
+		// 
+		// Return:
+		// True if the file was mapped as a PE image, false if it was mapped as a raw file or is not mapped.
+		bool isImage() const;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,515 @@
+#include "ModuleCache.h"
+#include "proc.h"
+#include "scan\ReadBatch.h"
+#include <stddef.h>
+
+namespace hax {
+
+	namespace proc {
+
+		// guards against loops in a corrupted loader list
+		static constexpr size_t MAX_MODULES = 0x1000u;
+
+		// the fields of a loader table entry that are cached, independent of the architecture
+		typedef struct LoaderEntry {
+			uint64_t flink;
+			uint64_t blink;
+			uint64_t dllBase;
+			DWORD sizeOfImage;
+			uint64_t nameBuffer;
+			USHORT nameLength;
+		}LoaderEntry;
+
+		static bool readLoaderEntry(IMemorySource* pSource, uint64_t address, bool x86, LoaderEntry* pEntry);
+		static size_t toLowerWide(const char* name, wchar_t* wName, size_t size);
+		static wchar_t toLower(wchar_t c);
+		static uint32_t hashName(const wchar_t* name, size_t length);
+		static size_t hashBase(HMODULE hMod);
+
+		ModuleCache::ModuleCache(HANDLE hProc) :
+			_pOwnSource{}, _pSource{}, _pLdrData{}, _x86{}, _valid{}, _headFlink{}, _headBlink{},
+			_modules{}, _names{}, _nameTable{}, _baseTable{}, _tableCapacity{} {
+			this->_pOwnSource = new hax::ex::MemorySource(hProc);
+			this->_pSource = this->_pOwnSource;
+
+			BOOL isWow64 = FALSE;
+			IsWow64Process(hProc, &isWow64);
+
+			if (isWow64) {
+				// if the target is x86 (running in the WOW64 evironment on x64 Windows) the x86 loader data is cached
+				const PEB32* const pPeb32 = ex::getPeb32Address(hProc);
+				PEB32 peb{};
+
+				if (pPeb32 && this->_pSource->read(pPeb32, &peb, sizeof(PEB32))) {
+					// static cast to convert from ULONG (4 bytes) to uintptr_t (4 bytes for x86, 8 bytes for x64)
+					this->_pLdrData = reinterpret_cast<const BYTE*>(static_cast<uintptr_t>(peb.Ldr));
+					this->_x86 = true;
+				}
+
+			}
+			else {
+
+				#ifdef _WIN64
+
+				const PEB64* const pPeb64 = ex::getPeb64Address(hProc);
+				PEB64 peb{};
+
+				if (pPeb64 && this->_pSource->read(pPeb64, &peb, sizeof(PEB64))) {
+					this->_pLdrData = reinterpret_cast<const BYTE*>(peb.Ldr);
+				}
+
+				#endif // _WIN64
+
+			}
+
+			return;
+		}
+
+
+		ModuleCache::ModuleCache(IMemorySource* pSource, const void* pLdrData, bool x86) :
+			_pOwnSource{}, _pSource{ pSource }, _pLdrData{ reinterpret_cast<const BYTE*>(pLdrData) }, _x86{ x86 }, _valid{}, _headFlink{}, _headBlink{},
+			_modules{}, _names{}, _nameTable{}, _baseTable{}, _tableCapacity{} {}
+
+
+		ModuleCache::~ModuleCache() {
+			this->invalidate();
+			delete this->_pOwnSource;
+
+			return;
+		}
+
+
+		HMODULE ModuleCache::getModuleHandle(const char* modName) {
+			wchar_t wModName[MAX_PATH]{};
+			size_t length = 0u;
+			uint32_t hash = 0u;
+
+			if (modName) {
+				length = toLowerWide(modName, wModName, MAX_PATH);
+				hash = hashName(wModName, length);
+			}
+
+			// a lookup that turns out to be stale is repeated once with a new snapshot
+			for (size_t attempt = 0u; attempt < 2u; attempt++) {
+
+				if (!this->_valid && !this->snapshot()) return nullptr;
+
+				// the first module in load order is the module of the .exe file
+				const CachedModule* const pModule = modName ? this->findByName(wModName, length, hash) : this->_modules.addr(0u);
+
+				if (this->isLookupValid(pModule)) return pModule ? pModule->hMod : nullptr;
+
+				this->invalidate();
+			}
+
+			return nullptr;
+		}
+
+
+		FARPROC ModuleCache::getProcAddress(HMODULE hMod, const char* funcName) {
+			CachedModule* pModule = nullptr;
+
+			for (size_t attempt = 0u; attempt < 2u; attempt++) {
+
+				if (!this->_valid && !this->snapshot()) return nullptr;
+
+				pModule = this->findByBase(hMod);
+
+				if (this->isLookupValid(pModule)) break;
+
+				pModule = nullptr;
+				this->invalidate();
+			}
+
+			if (!pModule) return nullptr;
+
+			if (!pModule->pExportIndex) {
+				pModule->pExportIndex = new ExportIndex();
+
+				if (!pModule->pExportIndex->build(this->_pSource, hMod)) {
+					delete pModule->pExportIndex;
+					pModule->pExportIndex = nullptr;
+
+					return nullptr;
+				}
+
+			}
+
+			const ExportIndex* const pExportIndex = pModule->pExportIndex;
+			const DWORD funcRva = pExportIndex->getFunctionRva(funcName);
+
+			if (!funcRva) return nullptr;
+
+			const char* const forward = pExportIndex->getForward(funcRva);
+
+			if (!forward) return reinterpret_cast<FARPROC>(pExportIndex->base() + funcRva);
+
+			// forward has the format "module.function"
+			// it is split a the dot and the ".dll" extension is appended to the module name
+			// it is copied because the lookups of the forward might take a new snapshot that frees the export index
+			// a malformed export table of the module must not raise the invalid parameter handler of the string functions
+			if (strnlen(forward, MAX_PATH) == MAX_PATH) return nullptr;
+
+			char curForward[MAX_PATH]{};
+			strcpy_s(curForward, forward);
+
+			char* forwardModName = nullptr;
+			char* forwardFuncName = nullptr;
+
+			forwardModName = strtok_s(curForward, ".", &forwardFuncName);
+
+			if (!forwardModName || strlen(forwardModName) + sizeof(".dll") > MAX_PATH) return nullptr;
+
+			char forwardModFileName[MAX_PATH]{};
+
+			strcpy_s(forwardModFileName, forwardModName);
+			strcat_s(forwardModFileName, ".dll");
+
+			const HMODULE hForwardMod = this->getModuleHandle(forwardModFileName);
+
+			if (!hForwardMod) return nullptr;
+
+			FARPROC procAddress = nullptr;
+
+			// check if exported by ordinal and looking for the forwarded funcion in the module it was forwarded to
+			if (forwardFuncName[0] == '#') {
+				char* forwardFuncOrdinal = reinterpret_cast<char*>(static_cast<uintptr_t>(atoi(forwardFuncName + 1)));
+				procAddress = this->getProcAddress(hForwardMod, forwardFuncOrdinal);
+			}
+			else {
+				procAddress = this->getProcAddress(hForwardMod, forwardFuncName);
+			}
+
+			return procAddress;
+		}
+
+
+		size_t ModuleCache::moduleCount() {
+
+			if (!this->_valid) {
+				this->snapshot();
+			}
+
+			return this->_modules.size();
+		}
+
+
+		void ModuleCache::invalidate() {
+
+			for (size_t i = 0u; i < this->_modules.size(); i++) {
+				delete this->_modules[i].pExportIndex;
+			}
+
+			this->_modules.resize(0u);
+			this->_names.resize(0u);
+
+			delete[] this->_nameTable;
+			delete[] this->_baseTable;
+			this->_nameTable = nullptr;
+			this->_baseTable = nullptr;
+			this->_tableCapacity = 0u;
+			this->_valid = false;
+
+			return;
+		}
+
+
+		bool ModuleCache::snapshot() {
+			this->invalidate();
+
+			if (!this->_pSource || !this->_pLdrData) return false;
+
+			if (!this->readListHead(&this->_headFlink, &this->_headBlink)) return false;
+
+			const size_t headOffset = this->_x86 ? offsetof(PEB_LDR_DATA32, InLoadOrderModuleList) : offsetof(PEB_LDR_DATA64, InLoadOrderModuleList);
+			const uint64_t headAddress = reinterpret_cast<uintptr_t>(this->_pLdrData) + headOffset;
+			Vector<LoaderEntry> entries{};
+			uint64_t cur = this->_headFlink;
+
+			// the in load order links are the first member of a loader table entry, so the link addresses are the entry addresses
+			while (cur != headAddress && entries.size() < MAX_MODULES) {
+				LoaderEntry entry{};
+
+				if (!readLoaderEntry(this->_pSource, cur, this->_x86, &entry)) break;
+
+				entries.append(entry);
+				this->_modules.append(CachedModule{ cur, entry.flink, entry.blink, reinterpret_cast<HMODULE>(static_cast<uintptr_t>(entry.dllBase)), entry.sizeOfImage, 0u, 0u, 0u, nullptr });
+				cur = entry.flink;
+			}
+
+			// the names are read in one batch since they usually lie close to each other on the loader heap
+			wchar_t* const nameData = new wchar_t[entries.size() * MAX_PATH]{};
+			bool* const nameRead = new bool[entries.size()]{};
+			ReadBatch batch(this->_pSource);
+
+			for (size_t i = 0u; i < entries.size(); i++) {
+				const size_t maxLength = (MAX_PATH - 1u) * sizeof(wchar_t);
+				const size_t length = entries[i].nameLength < maxLength ? entries[i].nameLength : maxLength;
+				batch.add(reinterpret_cast<const void*>(static_cast<uintptr_t>(entries[i].nameBuffer)), nameData + i * MAX_PATH, length, &nameRead[i]);
+			}
+
+			batch.execute();
+
+			for (size_t i = 0u; i < entries.size(); i++) {
+				CachedModule* const pModule = this->_modules + i;
+				pModule->nameOffset = this->_names.size();
+
+				// modules with unreadable names are only found by their base
+				if (nameRead[i]) {
+					const wchar_t* const name = nameData + i * MAX_PATH;
+
+					for (size_t j = 0u; j < MAX_PATH && name[j]; j++) {
+						this->_names.append(toLower(name[j]));
+						pModule->nameLength++;
+					}
+
+				}
+
+				pModule->nameHash = hashName(this->_names.data() + pModule->nameOffset, pModule->nameLength);
+			}
+
+			delete[] nameData;
+			delete[] nameRead;
+
+			// tables are kept at most half full for short probe sequences
+			this->_tableCapacity = 0x10u;
+
+			while (this->_tableCapacity < 2u * this->_modules.size()) {
+				this->_tableCapacity *= 2u;
+			}
+
+			this->_nameTable = new size_t[this->_tableCapacity]{};
+			this->_baseTable = new size_t[this->_tableCapacity]{};
+
+			for (size_t i = 0u; i < this->_modules.size(); i++) {
+				this->insertIntoTables(i);
+			}
+
+			this->_valid = true;
+
+			return true;
+		}
+
+
+		bool ModuleCache::readListHead(uint64_t* pFlink, uint64_t* pBlink) const {
+
+			if (this->_x86) {
+				LIST_ENTRY32 head{};
+
+				if (!this->_pSource->read(this->_pLdrData + offsetof(PEB_LDR_DATA32, InLoadOrderModuleList), &head, sizeof(LIST_ENTRY32))) return false;
+
+				*pFlink = head.Flink;
+				*pBlink = head.Blink;
+			}
+			else {
+				LIST_ENTRY64 head{};
+
+				if (!this->_pSource->read(this->_pLdrData + offsetof(PEB_LDR_DATA64, InLoadOrderModuleList), &head, sizeof(LIST_ENTRY64))) return false;
+
+				*pFlink = head.Flink;
+				*pBlink = head.Blink;
+			}
+
+			return true;
+		}
+
+
+		bool ModuleCache::readPointer(uint64_t address, uint64_t* pPointer) const {
+			const void* const pAddress = reinterpret_cast<const void*>(static_cast<uintptr_t>(address));
+
+			if (this->_x86) {
+				DWORD pointer = 0ul;
+
+				if (!this->_pSource->read(pAddress, &pointer, sizeof(DWORD))) return false;
+
+				*pPointer = pointer;
+			}
+			else {
+
+				if (!this->_pSource->read(pAddress, pPointer, sizeof(uint64_t))) return false;
+
+			}
+
+			return true;
+		}
+
+
+		bool ModuleCache::isLookupValid(const CachedModule* pModule) const {
+
+			if (!pModule) {
+				// modules are loaded at the end of the list, so a module that was not found and got loaded since the snapshot changed the head
+				uint64_t flink = 0u;
+				uint64_t blink = 0u;
+
+				if (!this->readListHead(&flink, &blink)) return false;
+
+				return flink == this->_headFlink && blink == this->_headBlink;
+			}
+
+			LoaderEntry entry{};
+
+			if (!readLoaderEntry(this->_pSource, pModule->entry, this->_x86, &entry)) return false;
+
+			if (entry.flink != pModule->flink || entry.blink != pModule->blink || entry.dllBase != reinterpret_cast<uintptr_t>(pModule->hMod)) return false;
+
+			// an unlinked entry keeps its own links, so the link of its predecessor has to point to it as well
+			uint64_t prevFlink = 0u;
+
+			if (!this->readPointer(pModule->blink, &prevFlink)) return false;
+
+			return prevFlink == pModule->entry;
+		}
+
+
+		ModuleCache::CachedModule* ModuleCache::findByName(const wchar_t* name, size_t length, uint32_t hash) const {
+
+			if (!this->_tableCapacity) return nullptr;
+
+			for (size_t slot = hash & (this->_tableCapacity - 1u); this->_nameTable[slot]; slot = (slot + 1u) & (this->_tableCapacity - 1u)) {
+				CachedModule* const pModule = this->_modules + (this->_nameTable[slot] - 1u);
+
+				if (pModule->nameHash != hash || pModule->nameLength != length) continue;
+
+				if (!memcmp(this->_names.data() + pModule->nameOffset, name, length * sizeof(wchar_t))) return pModule;
+
+			}
+
+			return nullptr;
+		}
+
+
+		ModuleCache::CachedModule* ModuleCache::findByBase(HMODULE hMod) const {
+
+			if (!this->_tableCapacity) return nullptr;
+
+			for (size_t slot = hashBase(hMod) & (this->_tableCapacity - 1u); this->_baseTable[slot]; slot = (slot + 1u) & (this->_tableCapacity - 1u)) {
+				CachedModule* const pModule = this->_modules + (this->_baseTable[slot] - 1u);
+
+				if (pModule->hMod == hMod) return pModule;
+
+			}
+
+			return nullptr;
+		}
+
+
+		void ModuleCache::insertIntoTables(size_t index) {
+			const CachedModule* const pModule = this->_modules + index;
+			const size_t mask = this->_tableCapacity - 1u;
+
+			// the first module with a name is kept, like the loader list is searched from the start
+			if (!this->findByName(this->_names.data() + pModule->nameOffset, pModule->nameLength, pModule->nameHash)) {
+				size_t slot = pModule->nameHash & mask;
+
+				while (this->_nameTable[slot]) {
+					slot = (slot + 1u) & mask;
+				}
+
+				this->_nameTable[slot] = index + 1u;
+			}
+
+			if (!this->findByBase(pModule->hMod)) {
+				size_t slot = hashBase(pModule->hMod) & mask;
+
+				while (this->_baseTable[slot]) {
+					slot = (slot + 1u) & mask;
+				}
+
+				this->_baseTable[slot] = index + 1u;
+			}
+
+			return;
+		}
+
+
+		static bool readLoaderEntry(IMemorySource* pSource, uint64_t address, bool x86, LoaderEntry* pEntry) {
+			const void* const pAddress = reinterpret_cast<const void*>(static_cast<uintptr_t>(address));
+
+			if (x86) {
+				LDR_DATA_TABLE_ENTRY32 entry{};
+
+				if (!pSource->read(pAddress, &entry, sizeof(LDR_DATA_TABLE_ENTRY32))) return false;
+
+				pEntry->flink = entry.InLoadOrderLinks.Flink;
+				pEntry->blink = entry.InLoadOrderLinks.Blink;
+				pEntry->dllBase = entry.DllBase;
+				pEntry->sizeOfImage = entry.SizeOfImage;
+				pEntry->nameBuffer = entry.BaseDllName.Buffer;
+				pEntry->nameLength = entry.BaseDllName.Length;
+			}
+			else {
+				LDR_DATA_TABLE_ENTRY64 entry{};
+
+				if (!pSource->read(pAddress, &entry, sizeof(LDR_DATA_TABLE_ENTRY64))) return false;
+
+				pEntry->flink = entry.InLoadOrderLinks.Flink;
+				pEntry->blink = entry.InLoadOrderLinks.Blink;
+				pEntry->dllBase = entry.DllBase;
+				pEntry->sizeOfImage = entry.SizeOfImage;
+				pEntry->nameBuffer = entry.BaseDllName.Buffer;
+				pEntry->nameLength = entry.BaseDllName.Length;
+			}
+
+			return true;
+		}
+
+
+		static size_t toLowerWide(const char* name, wchar_t* wName, size_t size) {
+			size_t length = 0u;
+
+			// ascii names are widened directly, only other names need a code page conversion
+			while (name[length] && static_cast<unsigned char>(name[length]) < 0x80u && length + 1u < size) {
+				wName[length] = static_cast<wchar_t>(name[length]);
+				length++;
+			}
+
+			if (name[length] && length + 1u < size) {
+				MultiByteToWideChar(CP_ACP, MB_PRECOMPOSED, name, -1, wName, static_cast<int>(size));
+				wName[size - 1u] = L'\0';
+				length = 0u;
+
+				while (wName[length]) {
+					length++;
+				}
+
+			}
+
+			wName[length] = L'\0';
+
+			for (size_t i = 0u; i < length; i++) {
+				wName[i] = toLower(wName[i]);
+			}
+
+			return length;
+		}
+
+
+		static wchar_t toLower(wchar_t c) {
+
+			if (c >= L'A' && c <= L'Z') return c - L'A' + L'a';
+
+			return c;
+		}
+
+
+		static uint32_t hashName(const wchar_t* name, size_t length) {
+			uint32_t hash = 0x811C9DC5u;
+
+			for (size_t i = 0u; i < length; i++) {
+				hash = (hash ^ static_cast<uint32_t>(name[i])) * 0x01000193u;
+			}
+
+			return hash;
+		}
+
+
+		static size_t hashBase(HMODULE hMod) {
+			// module bases are aligned to 64 KB
+			const uint64_t base = reinterpret_cast<uintptr_t>(hMod) >> 16u;
+
+			return static_cast<size_t>((base * 0x9E3779B97F4A7C15ull) >> 32u);
+		}
+
+	}
+
+}
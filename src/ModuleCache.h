@@ -0,0 +1,132 @@
+#pragma once
+#include "ExportIndex.h"
+#include "scan\MemorySource.h"
+#include "Vector.h"
+#include <stdint.h>
+
+// Class to look up modules and exports of a process without walking its loader data for every lookup.
+
+namespace hax {
+
+	namespace proc {
+
+		// Caches the modules of the loader data of a process and the exports of these modules.
+		// The loader list is walked once and modules are looked up in hash tables by name and base address.
+		// Every lookup revalidates the snapshot with two small reads: the head of the loader list and the loader entry of the found module.
+		// If either changed because a module was loaded or unloaded, the snapshot is taken again.
+		// Export indices of modules are built on the first lookup of an export and kept until the module is unloaded.
+		class ModuleCache {
+		private:
+			typedef struct CachedModule {
+				// address of the loader table entry within the address space of the process
+				uint64_t entry;
+				uint64_t flink;
+				uint64_t blink;
+				HMODULE hMod;
+				DWORD size;
+				// offset of the lower case name in the names vector
+				size_t nameOffset;
+				size_t nameLength;
+				uint32_t nameHash;
+				ExportIndex* pExportIndex;
+			}CachedModule;
+
+			hax::ex::MemorySource* _pOwnSource;
+			IMemorySource* _pSource;
+			const BYTE* _pLdrData;
+			bool _x86;
+			bool _valid;
+			uint64_t _headFlink;
+			uint64_t _headBlink;
+			Vector<CachedModule> _modules;
+			Vector<wchar_t> _names;
+			// open addressing tables of module indices plus one, zero marks an empty slot
+			size_t* _nameTable;
+			size_t* _baseTable;
+			size_t _tableCapacity;
+
+		public:
+			// Initializes members for an external process.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the process. Has to stay valid for the lifetime of the object.
+			// Needs at least PROCESS_QUERY_LIMITED_INFORMATION and PROCESS_VM_READ access rights.
+			ModuleCache(HANDLE hProc);
+
+			// Initializes members for the loader data of any memory source, eg. a fake process.
+			// 
+			// Parameters:
+			// 
+			// [in] pSource:
+			// The memory source that contains the loader data. Has to stay valid for the lifetime of the object.
+			// 
+			// [in] pLdrData:
+			// Address of the loader data (PEB_LDR_DATA32 or PEB_LDR_DATA64) within the memory source.
+			// 
+			// [in] x86:
+			// True if the loader data is in the x86 format, false if it is in the x64 format.
+			ModuleCache(IMemorySource* pSource, const void* pLdrData, bool x86);
+
+			ModuleCache(ModuleCache&&) = delete;
+
+			ModuleCache(const ModuleCache&) = delete;
+
+			ModuleCache& operator=(ModuleCache&&) = delete;
+
+			ModuleCache& operator=(const ModuleCache&) = delete;
+
+			~ModuleCache();
+
+			// Gets a handle to a module of the process.
+			// Works like GetModuleHandle of the Win32 API.
+			// 
+			// Parameters:
+			// 
+			// [in] modName:
+			// The name of the module. If nullptr returns a handle to module of the file used to create the process (.exe file).
+			// 
+			// Return:
+			// Handle to the module or nullptr if the module was not found.
+			HMODULE getModuleHandle(const char* modName);
+
+			// Gets the address of an exported function of a module of the process.
+			// Works like GetProcAddress of the Win32 API. Forwarded functions are resolved with the modules of the cache.
+			// Supports function forwarding but NOT WITH VIRTUAL DLLS (e.g. api-ms-win-...dll) using the ApiSetSchema.
+			// 
+			// Parameters:
+			// 
+			// [in] hMod:
+			// Handle to the module that exports the function.
+			// 
+			// [in] funcName:
+			// Export name or ordinal of the exported function.
+			// 
+			// Return:
+			// Address of the exported function within the address space of the process or nullptr on failure or if the function was not found.
+			FARPROC getProcAddress(HMODULE hMod, const char* funcName);
+
+			// Gets the amount of modules in the snapshot of the loader list. Takes a snapshot if there is none.
+			// 
+			// Return:
+			// The amount of modules.
+			size_t moduleCount();
+
+			// Drops the snapshot and all export indices, so the next lookup takes a new snapshot.
+			void invalidate();
+
+		private:
+			bool snapshot();
+			bool readListHead(uint64_t* pFlink, uint64_t* pBlink) const;
+			bool readPointer(uint64_t address, uint64_t* pPointer) const;
+			// checks with the fewest reads if the result of a lookup in the snapshot is still valid
+			bool isLookupValid(const CachedModule* pModule) const;
+			CachedModule* findByName(const wchar_t* name, size_t length, uint32_t hash) const;
+			CachedModule* findByBase(HMODULE hMod) const;
+			void insertIntoTables(size_t index);
+		};
+
+	}
+
+}
@@ -0,0 +1,622 @@
+#include "PeImage.h"
+
+namespace hax {
+
+	namespace pe {
+
+		// the system always maps the first page of an image, which contains the headers
+		static constexpr size_t HEADERS_SIZE = 0x1000u;
+
+		static DWORD getRawSize(const IMAGE_SECTION_HEADER* pSection);
+
+		Image::Image() : _data{}, _size{}, _mappedAsImage{}, _headers{}, _dataDirs{}, _dataDirCount{}, _sections{}, _sectionCount{} {}
+
+
+		Image::~Image() {
+			this->clear();
+
+			return;
+		}
+
+
+		bool Image::parse(const FileMapper* pFile) {
+
+			if (!pFile || !pFile->data()) return false;
+
+			// an image mapped by the system is as large as the image and not as the file
+			return this->parse(pFile->data(), pFile->isImage() ? 0u : pFile->size(), pFile->isImage());
+		}
+
+
+		bool Image::parse(const void* data, size_t size, bool mappedAsImage) {
+			this->clear();
+
+			if (!data || (!size && !mappedAsImage)) return false;
+
+			const BYTE* const pBase = reinterpret_cast<const BYTE*>(data);
+			const size_t headersSize = size ? size : HEADERS_SIZE;
+
+			if (headersSize < sizeof(IMAGE_DOS_HEADER)) return false;
+
+			const IMAGE_DOS_HEADER* const pDosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(pBase);
+
+			if (pDosHeader->e_magic != IMAGE_DOS_SIGNATURE || pDosHeader->e_lfanew < 0) return false;
+
+			const size_t fileHeaderOffset = static_cast<size_t>(pDosHeader->e_lfanew) + sizeof(DWORD);
+
+			if (fileHeaderOffset + sizeof(IMAGE_FILE_HEADER) > headersSize) return false;
+
+			const IMAGE_FILE_HEADER* const pFileHeader = reinterpret_cast<const IMAGE_FILE_HEADER*>(pBase + fileHeaderOffset);
+			const size_t sectionsOffset = fileHeaderOffset + sizeof(IMAGE_FILE_HEADER) + pFileHeader->SizeOfOptionalHeader;
+
+			// getPeHeaders does not check if the headers fit into the buffer
+			if (sectionsOffset + pFileHeader->NumberOfSections * sizeof(IMAGE_SECTION_HEADER) > headersSize) return false;
+
+			if (!proc::in::getPeHeaders(reinterpret_cast<HMODULE>(const_cast<BYTE*>(pBase)), &this->_headers)) {
+				this->clear();
+
+				return false;
+			}
+
+			DWORD sizeOfImage = 0ul;
+
+			if (this->_headers.pOptHeader64 && this->_headers.pOptHeader64->Magic == IMAGE_NT_OPTIONAL_HDR64_MAGIC) {
+				this->_dataDirs = this->_headers.pOptHeader64->DataDirectory;
+				this->_dataDirCount = this->_headers.pOptHeader64->NumberOfRvaAndSizes;
+				sizeOfImage = this->_headers.pOptHeader64->SizeOfImage;
+			}
+			else if (this->_headers.pOptHeader32 && this->_headers.pOptHeader32->Magic == IMAGE_NT_OPTIONAL_HDR32_MAGIC) {
+				this->_dataDirs = this->_headers.pOptHeader32->DataDirectory;
+				this->_dataDirCount = this->_headers.pOptHeader32->NumberOfRvaAndSizes;
+				sizeOfImage = this->_headers.pOptHeader32->SizeOfImage;
+			}
+			else {
+				this->clear();
+
+				return false;
+			}
+
+			if (this->_dataDirCount > IMAGE_NUMBEROF_DIRECTORY_ENTRIES) {
+				this->_dataDirCount = IMAGE_NUMBEROF_DIRECTORY_ENTRIES;
+			}
+
+			this->_data = pBase;
+			this->_size = size ? size : sizeOfImage;
+			this->_mappedAsImage = mappedAsImage;
+			this->_sections = reinterpret_cast<const IMAGE_SECTION_HEADER*>(pBase + sectionsOffset);
+			this->_sectionCount = pFileHeader->NumberOfSections;
+
+			return true;
+		}
+
+
+		void Image::clear() {
+			this->_data = nullptr;
+			this->_size = 0u;
+			this->_mappedAsImage = false;
+			this->_headers = proc::PeHeaders{};
+			this->_dataDirs = nullptr;
+			this->_dataDirCount = 0ul;
+			this->_sections = nullptr;
+			this->_sectionCount = 0u;
+
+			return;
+		}
+
+
+		bool Image::is64() const {
+
+			return this->_data && this->_headers.pOptHeader64;
+		}
+
+
+		const proc::PeHeaders* Image::headers() const {
+
+			return &this->_headers;
+		}
+
+
+		uint64_t Image::imageBase() const {
+
+			if (!this->_data) return 0u;
+
+			return this->is64() ? this->_headers.pOptHeader64->ImageBase : this->_headers.pOptHeader32->ImageBase;
+		}
+
+
+		DWORD Image::sizeOfImage() const {
+
+			if (!this->_data) return 0ul;
+
+			return this->is64() ? this->_headers.pOptHeader64->SizeOfImage : this->_headers.pOptHeader32->SizeOfImage;
+		}
+
+
+		const IMAGE_DATA_DIRECTORY* Image::getDataDirectory(DWORD index) const {
+
+			if (index >= this->_dataDirCount) return nullptr;
+
+			const IMAGE_DATA_DIRECTORY* const pDataDir = &this->_dataDirs[index];
+
+			if (!pDataDir->VirtualAddress || !pDataDir->Size) return nullptr;
+
+			return pDataDir;
+		}
+
+
+		WORD Image::sectionCount() const {
+
+			return this->_sectionCount;
+		}
+
+
+		const IMAGE_SECTION_HEADER* Image::getSection(WORD index) const {
+
+			if (index >= this->_sectionCount) return nullptr;
+
+			return &this->_sections[index];
+		}
+
+
+		const IMAGE_SECTION_HEADER* Image::findSection(const char* name) const {
+
+			for (WORD i = 0u; i < this->_sectionCount; i++) {
+
+				if (!strncmp(reinterpret_cast<const char*>(this->_sections[i].Name), name, IMAGE_SIZEOF_SHORT_NAME)) return &this->_sections[i];
+
+			}
+
+			return nullptr;
+		}
+
+
+		const IMAGE_SECTION_HEADER* Image::getSectionOfRva(DWORD rva) const {
+
+			for (WORD i = 0u; i < this->_sectionCount; i++) {
+				const IMAGE_SECTION_HEADER* const pSection = &this->_sections[i];
+				const DWORD virtualSize = pSection->Misc.VirtualSize ? pSection->Misc.VirtualSize : pSection->SizeOfRawData;
+
+				if (rva >= pSection->VirtualAddress && rva - pSection->VirtualAddress < virtualSize) return pSection;
+
+			}
+
+			return nullptr;
+		}
+
+
+		const BYTE* Image::getSectionData(const IMAGE_SECTION_HEADER* pSection, size_t* pSize) const {
+			*pSize = 0u;
+
+			if (!this->_data || !pSection) return nullptr;
+
+			size_t offset = 0u;
+			size_t size = 0u;
+
+			if (this->_mappedAsImage) {
+				offset = pSection->VirtualAddress;
+				size = pSection->Misc.VirtualSize ? pSection->Misc.VirtualSize : pSection->SizeOfRawData;
+			}
+			else {
+				offset = pSection->PointerToRawData;
+				size = getRawSize(pSection);
+			}
+
+			if (!size || offset >= this->_size) return nullptr;
+
+			if (size > this->_size - offset) {
+				size = this->_size - offset;
+			}
+
+			*pSize = size;
+
+			return this->_data + offset;
+		}
+
+
+		const BYTE* Image::rvaToPointer(DWORD rva, size_t size) const {
+			size_t available = 0u;
+			const BYTE* const pointer = this->translate(rva, &available);
+
+			if (!pointer || available < size) return nullptr;
+
+			return pointer;
+		}
+
+
+		size_t Image::rvaToOffset(DWORD rva) const {
+			size_t available = 0u;
+			const BYTE* const pointer = this->translate(rva, &available);
+
+			if (!pointer) return SIZE_MAX;
+
+			return static_cast<size_t>(pointer - this->_data);
+		}
+
+
+		DWORD Image::offsetToRva(size_t offset) const {
+
+			if (!this->_data || offset >= this->_size) return 0ul;
+
+			if (this->_mappedAsImage) return static_cast<DWORD>(offset);
+
+			const DWORD sizeOfHeaders = this->is64() ? this->_headers.pOptHeader64->SizeOfHeaders : this->_headers.pOptHeader32->SizeOfHeaders;
+
+			if (offset < sizeOfHeaders) return static_cast<DWORD>(offset);
+
+			for (WORD i = 0u; i < this->_sectionCount; i++) {
+				const IMAGE_SECTION_HEADER* const pSection = &this->_sections[i];
+
+				if (offset >= pSection->PointerToRawData && offset - pSection->PointerToRawData < getRawSize(pSection)) {
+
+					return pSection->VirtualAddress + static_cast<DWORD>(offset - pSection->PointerToRawData);
+				}
+
+			}
+
+			return 0ul;
+		}
+
+
+		DWORD Image::getExportRva(const char* funcName) const {
+			const DWORD* functions = nullptr;
+			const DWORD* nameRvas = nullptr;
+			const WORD* ordinals = nullptr;
+			const IMAGE_EXPORT_DIRECTORY* const pExportDir = this->getExportDirectory(&functions, &nameRvas, &ordinals);
+
+			if (!pExportDir) return 0ul;
+
+			// export by ordinal if everything but the lowest word of name param is zero
+			const bool byOrdinal = (reinterpret_cast<uintptr_t>(funcName) >> sizeof(WORD) * 0x8) == 0u;
+
+			if (byOrdinal) {
+				const DWORD index = static_cast<DWORD>(reinterpret_cast<uintptr_t>(funcName) & MAXWORD) - pExportDir->Base;
+
+				if (index >= pExportDir->NumberOfFunctions) return 0ul;
+
+				return functions[index];
+			}
+
+			// the linker sorts the name table case sensitive, unreadable names are compared as empty names
+			size_t low = 0u;
+			size_t high = pExportDir->NumberOfNames;
+
+			while (low < high) {
+				const size_t mid = low + (high - low) / 2u;
+				const char* const name = this->getString(nameRvas[mid]);
+				const int cmp = strcmp(name ? name : "", funcName);
+
+				if (!cmp) {
+
+					if (ordinals[mid] >= pExportDir->NumberOfFunctions) return 0ul;
+
+					return functions[ordinals[mid]];
+				}
+
+				if (cmp < 0) {
+					low = mid + 1u;
+				}
+				else {
+					high = mid;
+				}
+
+			}
+
+			// lookups are case insensitive like GetProcAddress, so names that only differ in case are searched linearly
+			for (DWORD i = 0ul; i < pExportDir->NumberOfNames; i++) {
+				const char* const name = this->getString(nameRvas[i]);
+
+				if (name && !_stricmp(funcName, name)) {
+
+					if (ordinals[i] >= pExportDir->NumberOfFunctions) return 0ul;
+
+					return functions[ordinals[i]];
+				}
+
+			}
+
+			return 0ul;
+		}
+
+
+		const char* Image::getForward(DWORD funcRva) const {
+			const IMAGE_DATA_DIRECTORY* const pDataDir = this->getDataDirectory(IMAGE_DIRECTORY_ENTRY_EXPORT);
+
+			// forwarded functions point to a string within the export directory instead of code
+			if (!pDataDir || funcRva < pDataDir->VirtualAddress || funcRva - pDataDir->VirtualAddress >= pDataDir->Size) return nullptr;
+
+			return this->getString(funcRva);
+		}
+
+
+		size_t Image::enumExports(tExportCallback callback, void* pArg) const {
+			const DWORD* functions = nullptr;
+			const DWORD* nameRvas = nullptr;
+			const WORD* ordinals = nullptr;
+			const IMAGE_EXPORT_DIRECTORY* const pExportDir = this->getExportDirectory(&functions, &nameRvas, &ordinals);
+
+			if (!pExportDir) return 0u;
+
+			// the name table is indexed by name, so the name of every function index is looked up in advance
+			DWORD* const nameIndices = new DWORD[pExportDir->NumberOfFunctions ? pExportDir->NumberOfFunctions : 1u];
+
+			for (DWORD i = 0ul; i < pExportDir->NumberOfFunctions; i++) {
+				nameIndices[i] = MAXDWORD;
+			}
+
+			for (DWORD i = 0ul; i < pExportDir->NumberOfNames; i++) {
+
+				if (ordinals[i] < pExportDir->NumberOfFunctions && nameIndices[ordinals[i]] == MAXDWORD) {
+					nameIndices[ordinals[i]] = i;
+				}
+
+			}
+
+			size_t count = 0u;
+
+			for (DWORD i = 0ul; i < pExportDir->NumberOfFunctions; i++) {
+
+				// unused ordinals have no function
+				if (!functions[i]) continue;
+
+				Export curExport{};
+				curExport.name = nameIndices[i] != MAXDWORD ? this->getString(nameRvas[nameIndices[i]]) : nullptr;
+				curExport.ordinal = static_cast<WORD>(pExportDir->Base + i);
+				curExport.rva = functions[i];
+				curExport.forward = this->getForward(functions[i]);
+				count++;
+
+				if (!callback(&curExport, pArg)) break;
+
+			}
+
+			delete[] nameIndices;
+
+			return count;
+		}
+
+
+		size_t Image::enumImports(tImportCallback callback, void* pArg) const {
+			const IMAGE_DATA_DIRECTORY* const pDataDir = this->getDataDirectory(IMAGE_DIRECTORY_ENTRY_IMPORT);
+
+			if (!pDataDir) return 0u;
+
+			const size_t thunkSize = this->is64() ? sizeof(IMAGE_THUNK_DATA64) : sizeof(IMAGE_THUNK_DATA32);
+			const uint64_t ordinalFlag = this->is64() ? IMAGE_ORDINAL_FLAG64 : IMAGE_ORDINAL_FLAG32;
+			size_t count = 0u;
+
+			// the descriptor array is terminated by a zeroed descriptor
+			for (DWORD descriptorRva = pDataDir->VirtualAddress; ; descriptorRva += sizeof(IMAGE_IMPORT_DESCRIPTOR)) {
+				const IMAGE_IMPORT_DESCRIPTOR* const pDescriptor = reinterpret_cast<const IMAGE_IMPORT_DESCRIPTOR*>(this->rvaToPointer(descriptorRva, sizeof(IMAGE_IMPORT_DESCRIPTOR)));
+
+				if (!pDescriptor || (!pDescriptor->Name && !pDescriptor->FirstThunk)) break;
+
+				const char* const moduleName = this->getString(pDescriptor->Name);
+
+				if (!moduleName) continue;
+
+				// the import address table of a bound image contains addresses instead of names, so the lookup table is preferred
+				const DWORD lookupRva = pDescriptor->OriginalFirstThunk ? pDescriptor->OriginalFirstThunk : pDescriptor->FirstThunk;
+
+				for (DWORD i = 0ul; ; i++) {
+					const BYTE* const pThunk = this->rvaToPointer(lookupRva + i * static_cast<DWORD>(thunkSize), thunkSize);
+
+					if (!pThunk) break;
+
+					uint64_t thunk = 0u;
+					memcpy(&thunk, pThunk, thunkSize);
+
+					if (!thunk) break;
+
+					Import curImport{};
+					curImport.moduleName = moduleName;
+					curImport.iatRva = pDescriptor->FirstThunk + i * static_cast<DWORD>(thunkSize);
+
+					if (thunk & ordinalFlag) {
+						curImport.ordinal = static_cast<WORD>(thunk & MAXWORD);
+					}
+					else {
+						const BYTE* const pImportByName = this->rvaToPointer(static_cast<DWORD>(thunk), sizeof(WORD));
+
+						if (!pImportByName) continue;
+
+						memcpy(&curImport.ordinal, pImportByName, sizeof(WORD));
+						curImport.name = this->getString(static_cast<DWORD>(thunk) + sizeof(WORD));
+
+						if (!curImport.name) continue;
+
+					}
+
+					count++;
+
+					if (!callback(&curImport, pArg)) return count;
+
+				}
+
+			}
+
+			return count;
+		}
+
+
+		size_t Image::enumRelocations(tRelocationCallback callback, void* pArg) const {
+			const IMAGE_DATA_DIRECTORY* const pDataDir = this->getDataDirectory(IMAGE_DIRECTORY_ENTRY_BASERELOC);
+
+			if (!pDataDir) return 0u;
+
+			size_t count = 0u;
+			DWORD offset = 0ul;
+
+			// the directory consists of blocks of entries for one page each
+			while (pDataDir->Size - offset >= sizeof(IMAGE_BASE_RELOCATION)) {
+				const IMAGE_BASE_RELOCATION* const pBlock = reinterpret_cast<const IMAGE_BASE_RELOCATION*>(this->rvaToPointer(pDataDir->VirtualAddress + offset, sizeof(IMAGE_BASE_RELOCATION)));
+
+				if (!pBlock || pBlock->SizeOfBlock < sizeof(IMAGE_BASE_RELOCATION) || pBlock->SizeOfBlock > pDataDir->Size - offset) break;
+
+				const DWORD entryCount = (pBlock->SizeOfBlock - sizeof(IMAGE_BASE_RELOCATION)) / sizeof(WORD);
+				const BYTE* const entries = this->rvaToPointer(pDataDir->VirtualAddress + offset + sizeof(IMAGE_BASE_RELOCATION), entryCount * sizeof(WORD));
+
+				if (!entries) break;
+
+				for (DWORD i = 0ul; i < entryCount; i++) {
+					WORD entry = 0u;
+					memcpy(&entry, entries + i * sizeof(WORD), sizeof(WORD));
+
+					// the upper four bits are the type, the lower twelve bits the offset into the page
+					Relocation curRelocation{};
+					curRelocation.type = entry >> 12u;
+					curRelocation.rva = pBlock->VirtualAddress + (entry & 0xFFFu);
+
+					// padding to align the next block
+					if (curRelocation.type == IMAGE_REL_BASED_ABSOLUTE) continue;
+
+					count++;
+
+					if (!callback(&curRelocation, pArg)) return count;
+
+				}
+
+				offset += pBlock->SizeOfBlock;
+			}
+
+			return count;
+		}
+
+
+		const IMAGE_RUNTIME_FUNCTION_ENTRY* Image::getRuntimeFunctions(size_t* pCount) const {
+			*pCount = 0u;
+
+			// other architectures use different entry formats
+			if (!this->is64() || this->_headers.pFileHeader->Machine != IMAGE_FILE_MACHINE_AMD64) return nullptr;
+
+			const IMAGE_DATA_DIRECTORY* const pDataDir = this->getDataDirectory(IMAGE_DIRECTORY_ENTRY_EXCEPTION);
+
+			if (!pDataDir) return nullptr;
+
+			const size_t count = pDataDir->Size / sizeof(IMAGE_RUNTIME_FUNCTION_ENTRY);
+			const IMAGE_RUNTIME_FUNCTION_ENTRY* const entries = reinterpret_cast<const IMAGE_RUNTIME_FUNCTION_ENTRY*>(this->rvaToPointer(pDataDir->VirtualAddress, count * sizeof(IMAGE_RUNTIME_FUNCTION_ENTRY)));
+
+			if (!entries) return nullptr;
+
+			*pCount = count;
+
+			return entries;
+		}
+
+
+		const IMAGE_RUNTIME_FUNCTION_ENTRY* Image::findRuntimeFunction(DWORD rva) const {
+			size_t count = 0u;
+			const IMAGE_RUNTIME_FUNCTION_ENTRY* const entries = this->getRuntimeFunctions(&count);
+
+			if (!entries) return nullptr;
+
+			size_t low = 0u;
+			size_t high = count;
+
+			while (low < high) {
+				const size_t mid = low + (high - low) / 2u;
+
+				if (rva < entries[mid].BeginAddress) {
+					high = mid;
+				}
+				else if (rva >= entries[mid].EndAddress) {
+					low = mid + 1u;
+				}
+				else {
+					return &entries[mid];
+				}
+
+			}
+
+			return nullptr;
+		}
+
+
+		const BYTE* Image::translate(DWORD rva, size_t* pAvailable) const {
+			*pAvailable = 0u;
+
+			if (!this->_data) return nullptr;
+
+			if (this->_mappedAsImage) {
+
+				if (rva >= this->_size) return nullptr;
+
+				*pAvailable = this->_size - rva;
+
+				return this->_data + rva;
+			}
+
+			const DWORD sizeOfHeaders = this->is64() ? this->_headers.pOptHeader64->SizeOfHeaders : this->_headers.pOptHeader32->SizeOfHeaders;
+			size_t offset = SIZE_MAX;
+			size_t available = 0u;
+
+			// the headers are mapped at the same offset in the file and in the image
+			if (rva < sizeOfHeaders) {
+				offset = rva;
+				available = sizeOfHeaders - rva;
+			}
+			else {
+
+				for (WORD i = 0u; i < this->_sectionCount; i++) {
+					const IMAGE_SECTION_HEADER* const pSection = &this->_sections[i];
+
+					if (rva >= pSection->VirtualAddress && rva - pSection->VirtualAddress < getRawSize(pSection)) {
+						offset = pSection->PointerToRawData + static_cast<size_t>(rva - pSection->VirtualAddress);
+						available = getRawSize(pSection) - (rva - pSection->VirtualAddress);
+
+						break;
+					}
+
+				}
+
+			}
+
+			if (offset >= this->_size) return nullptr;
+
+			*pAvailable = available < this->_size - offset ? available : this->_size - offset;
+
+			return this->_data + offset;
+		}
+
+
+		const char* Image::getString(DWORD rva) const {
+			size_t available = 0u;
+			const char* const string = reinterpret_cast<const char*>(this->translate(rva, &available));
+
+			// the terminator has to lie within the buffer as well
+			if (!string || !memchr(string, '\0', available)) return nullptr;
+
+			return string;
+		}
+
+
+		const IMAGE_EXPORT_DIRECTORY* Image::getExportDirectory(const DWORD** pFunctions, const DWORD** pNameRvas, const WORD** pOrdinals) const {
+			const IMAGE_DATA_DIRECTORY* const pDataDir = this->getDataDirectory(IMAGE_DIRECTORY_ENTRY_EXPORT);
+
+			if (!pDataDir) return nullptr;
+
+			const IMAGE_EXPORT_DIRECTORY* const pExportDir = reinterpret_cast<const IMAGE_EXPORT_DIRECTORY*>(this->rvaToPointer(pDataDir->VirtualAddress, sizeof(IMAGE_EXPORT_DIRECTORY)));
+
+			// the tables cannot be larger than the buffer, this also prevents the sizes from overflowing
+			if (!pExportDir || pExportDir->NumberOfFunctions > this->_size / sizeof(DWORD) || pExportDir->NumberOfNames > this->_size / sizeof(DWORD)) return nullptr;
+
+			*pFunctions = reinterpret_cast<const DWORD*>(this->rvaToPointer(pExportDir->AddressOfFunctions, pExportDir->NumberOfFunctions * sizeof(DWORD)));
+			*pNameRvas = reinterpret_cast<const DWORD*>(this->rvaToPointer(pExportDir->AddressOfNames, pExportDir->NumberOfNames * sizeof(DWORD)));
+			*pOrdinals = reinterpret_cast<const WORD*>(this->rvaToPointer(pExportDir->AddressOfNameOrdinals, pExportDir->NumberOfNames * sizeof(WORD)));
+
+			if (!*pFunctions || !*pNameRvas || !*pOrdinals) return nullptr;
+
+			return pExportDir;
+		}
+
+
+		static DWORD getRawSize(const IMAGE_SECTION_HEADER* pSection) {
+
+			// raw data beyond the virtual size is not mapped by the loader
+			if (pSection->Misc.VirtualSize && pSection->Misc.VirtualSize < pSection->SizeOfRawData) return pSection->Misc.VirtualSize;
+
+			return pSection->SizeOfRawData;
+		}
+
+	}
+
+}
@@ -0,0 +1,369 @@
+#pragma once
+#include "FileMapper.h"
+#include "proc.h"
+#include <stdint.h>
+
+// Class to analyze PE files on disk without loading them into a process.
+
+namespace hax {
+
+	namespace pe {
+
+		typedef struct Export {
+			// nullptr if the function is only exported by ordinal
+			const char* name;
+			WORD ordinal;
+			DWORD rva;
+			// nullptr if the function is not forwarded
+			const char* forward;
+		}Export;
+
+		typedef struct Import {
+			const char* moduleName;
+			// nullptr if the function is imported by ordinal
+			const char* name;
+			// the ordinal if imported by ordinal, the hint into the export name table of the module otherwise
+			WORD ordinal;
+			// relative virtual address of the slot in the import address table the loader writes the function address to
+			DWORD iatRva;
+		}Import;
+
+		typedef struct Relocation {
+			DWORD rva;
+			// one of the IMAGE_REL_BASED_... types
+			WORD type;
+		}Relocation;
+
+		// Called for every export of an image in ascending order of the ordinals.
+		// 
+		// Parameters:
+		// 
+		// [in] pExport:
+		// The export. Only valid during the call.
+		// 
+		// [in] pArg:
+		// The argument passed to the enumeration.
+		// 
+		// Return:
+		// True to continue the enumeration, false to stop it.
+		typedef bool (*tExportCallback)(const Export* pExport, void* pArg);
+
+		// Called for every imported function of an image in the order of the import directory.
+		// 
+		// Parameters:
+		// 
+		// [in] pImport:
+		// The import. Only valid during the call.
+		// 
+		// [in] pArg:
+		// The argument passed to the enumeration.
+		// 
+		// Return:
+		// True to continue the enumeration, false to stop it.
+		typedef bool (*tImportCallback)(const Import* pImport, void* pArg);
+
+		// Called for every base relocation of an image in the order of the relocation directory.
+		// 
+		// Parameters:
+		// 
+		// [in] pRelocation:
+		// The relocation. Only valid during the call.
+		// 
+		// [in] pArg:
+		// The argument passed to the enumeration.
+		// 
+		// Return:
+		// True to continue the enumeration, false to stop it.
+		typedef bool (*tRelocationCallback)(const Relocation* pRelocation, void* pArg);
+
+		// Parses a PE32 or PE32+ file in place. Nothing is copied, all returned pointers point into the parsed buffer.
+		// The buffer can be the raw file, eg. mapped by a FileMapper, or an image mapped by the system. Relative virtual addresses are translated accordingly.
+		// Every access is bounds checked, so malformed files fail gracefully.
+		// Example of a signature scan of the code section of a file:
+		// hax::FileMapper file("C:\\Windows\\System32\\kernel32.dll");
+		// file.map();
+		// hax::pe::Image image;
+		// image.parse(&file);
+		// const IMAGE_SECTION_HEADER* const pText = image.findSection(".text");
+		// size_t size = 0u;
+		// const BYTE* const pData = image.getSectionData(pText, &size);
+		// hax::BufferMemorySource source(pData, size, reinterpret_cast<void*>(image.imageBase() + pText->VirtualAddress));
+		// hax::SigScanner scanner(&source);
+		class Image {
+		private:
+			const BYTE* _data;
+			size_t _size;
+			bool _mappedAsImage;
+			proc::PeHeaders _headers;
+			const IMAGE_DATA_DIRECTORY* _dataDirs;
+			DWORD _dataDirCount;
+			const IMAGE_SECTION_HEADER* _sections;
+			WORD _sectionCount;
+
+		public:
+			Image();
+
+			Image(Image&&) = delete;
+
+			Image(const Image&) = delete;
+
+			Image& operator=(Image&&) = delete;
+
+			Image& operator=(const Image&) = delete;
+
+			~Image();
+
+			// Parses the file of a file mapper. The file has to stay mapped while the image is used.
+			// 
+			// Parameters:
+			// 
+			// [in] pFile:
+			// The file mapper that mapped the file, either as a raw file or as an image.
+			// 
+			// Return:
+			// True on success, false if the file is not mapped or is no valid PE file.
+			bool parse(const FileMapper* pFile);
+
+			// Parses a PE file in a buffer. The buffer has to stay valid while the image is used.
+			// 
+			// Parameters:
+			// 
+			// [in] data:
+			// The buffer that contains the file.
+			// 
+			// [in] size:
+			// Size of the buffer. Zero for an image mapped by the system, the size of the image is taken from its headers then.
+			// 
+			// [in] mappedAsImage:
+			// True if the sections lie at their relative virtual addresses within the buffer, false if the buffer contains the raw file.
+			// 
+			// Return:
+			// True on success, false if the buffer does not contain a valid PE file.
+			bool parse(const void* data, size_t size, bool mappedAsImage);
+
+			// Resets the image to the unparsed state.
+			void clear();
+
+			// Checks if the image is a PE32+ image.
+			// 
+			// Return:
+			// True for PE32+ (x64) images, false for PE32 (x86) images or if nothing is parsed.
+			bool is64() const;
+
+			// Gets the pointers to the headers of the image.
+			// 
+			// Return:
+			// The header pointers within the parsed buffer. Only the members matching the architecture of the image are set.
+			const proc::PeHeaders* headers() const;
+
+			// Gets the preferred base address of the image from the optional header.
+			// 
+			// Return:
+			// The preferred base address or zero if nothing is parsed.
+			uint64_t imageBase() const;
+
+			// Gets the size of the image when it is loaded.
+			// 
+			// Return:
+			// The size of the image or zero if nothing is parsed.
+			DWORD sizeOfImage() const;
+
+			// Gets a data directory of the image.
+			// 
+			// Parameters:
+			// 
+			// [in] index:
+			// The index of the data directory, eg. IMAGE_DIRECTORY_ENTRY_EXPORT.
+			// 
+			// Return:
+			// The data directory or nullptr if the image has no such directory or it is empty.
+			const IMAGE_DATA_DIRECTORY* getDataDirectory(DWORD index) const;
+
+			// Gets the amount of sections of the image.
+			// 
+			// Return:
+			// The amount of section headers.
+			WORD sectionCount() const;
+
+			// Gets a section header by index.
+			// 
+			// Parameters:
+			// 
+			// [in] index:
+			// Index of the section header.
+			// 
+			// Return:
+			// The section header or nullptr if the index is out of range.
+			const IMAGE_SECTION_HEADER* getSection(WORD index) const;
+
+			// Gets a section header by name.
+			// 
+			// Parameters:
+			// 
+			// [in] name:
+			// Name of the section, eg. ".text". Only the first eight characters are compared.
+			// 
+			// Return:
+			// The first section header with the name or nullptr if there is none.
+			const IMAGE_SECTION_HEADER* findSection(const char* name) const;
+
+			// Gets the section header of the section that contains a relative virtual address.
+			// 
+			// Parameters:
+			// 
+			// [in] rva:
+			// The relative virtual address.
+			// 
+			// Return:
+			// The section header or nullptr if the address is outside of all sections.
+			const IMAGE_SECTION_HEADER* getSectionOfRva(DWORD rva) const;
+
+			// Gets the data of a section that is present in the parsed buffer.
+			// For raw files this is the raw data of the section, uninitialized data at the end of a section is not included.
+			// 
+			// Parameters:
+			// 
+			// [in] pSection:
+			// The section header as returned by getSection, findSection or getSectionOfRva.
+			// 
+			// [out] pSize:
+			// Receives the size of the data.
+			// 
+			// Return:
+			// Pointer to the data within the parsed buffer or nullptr if the section has no data in the buffer.
+			const BYTE* getSectionData(const IMAGE_SECTION_HEADER* pSection, size_t* pSize) const;
+
+			// Translates a relative virtual address into a pointer into the parsed buffer.
+			// 
+			// Parameters:
+			// 
+			// [in] rva:
+			// The relative virtual address.
+			// 
+			// [in] size:
+			// The amount of bytes that have to be present in the buffer at the address.
+			// 
+			// Return:
+			// Pointer into the parsed buffer or nullptr if the bytes are not present in the buffer.
+			const BYTE* rvaToPointer(DWORD rva, size_t size) const;
+
+			// Translates a relative virtual address into an offset into the parsed buffer.
+			// 
+			// Parameters:
+			// 
+			// [in] rva:
+			// The relative virtual address.
+			// 
+			// Return:
+			// The offset or SIZE_MAX if the address is not present in the buffer.
+			size_t rvaToOffset(DWORD rva) const;
+
+			// Translates an offset into the parsed buffer into a relative virtual address.
+			// 
+			// Parameters:
+			// 
+			// [in] offset:
+			// The offset into the buffer.
+			// 
+			// Return:
+			// The relative virtual address or zero if the offset is not mapped by the headers or a section.
+			DWORD offsetToRva(size_t offset) const;
+
+			// Gets the relative virtual address of an exported function.
+			// Works like ExportIndex::getFunctionRva: names are binary searched in the sorted name table and names that only match case insensitive are found by a linear search.
+			// 
+			// Parameters:
+			// 
+			// [in] funcName:
+			// Export name or ordinal of the exported function.
+			// 
+			// Return:
+			// The relative virtual address of the function or zero if it was not found.
+			DWORD getExportRva(const char* funcName) const;
+
+			// Gets the forward string of a forwarded function.
+			// 
+			// Parameters:
+			// 
+			// [in] funcRva:
+			// Relative virtual address of the function as returned by getExportRva.
+			// 
+			// Return:
+			// The forward in the format "module.function" or "module.#ordinal" or nullptr if the function is not forwarded.
+			const char* getForward(DWORD funcRva) const;
+
+			// Enumerates the exports of the image.
+			// 
+			// Parameters:
+			// 
+			// [in] callback:
+			// Called for every export.
+			// 
+			// [in] pArg:
+			// Argument passed to the callback.
+			// 
+			// Return:
+			// The amount of exports passed to the callback.
+			size_t enumExports(tExportCallback callback, void* pArg) const;
+
+			// Enumerates the imported functions of the image. Delay load imports are not enumerated.
+			// 
+			// Parameters:
+			// 
+			// [in] callback:
+			// Called for every imported function.
+			// 
+			// [in] pArg:
+			// Argument passed to the callback.
+			// 
+			// Return:
+			// The amount of imports passed to the callback.
+			size_t enumImports(tImportCallback callback, void* pArg) const;
+
+			// Enumerates the base relocations of the image. Padding entries of the type IMAGE_REL_BASED_ABSOLUTE are skipped.
+			// 
+			// Parameters:
+			// 
+			// [in] callback:
+			// Called for every relocation.
+			// 
+			// [in] pArg:
+			// Argument passed to the callback.
+			// 
+			// Return:
+			// The amount of relocations passed to the callback.
+			size_t enumRelocations(tRelocationCallback callback, void* pArg) const;
+
+			// Gets the function table of the exception directory of an x64 image.
+			// 
+			// Parameters:
+			// 
+			// [out] pCount:
+			// Receives the amount of entries.
+			// 
+			// Return:
+			// The entries sorted by their begin address within the parsed buffer or nullptr if the image is no x64 image or has no exception directory.
+			const IMAGE_RUNTIME_FUNCTION_ENTRY* getRuntimeFunctions(size_t* pCount) const;
+
+			// Gets the entry of the exception directory of an x64 image for the function that contains a relative virtual address.
+			// The entry is binary searched. Chained unwind information is not followed, so the entry can describe only a part of the function.
+			// 
+			// Parameters:
+			// 
+			// [in] rva:
+			// The relative virtual address within the function.
+			// 
+			// Return:
+			// The entry or nullptr if no entry contains the address.
+			const IMAGE_RUNTIME_FUNCTION_ENTRY* findRuntimeFunction(DWORD rva) const;
+
+		private:
+			// gets a pointer to the bytes at an rva and the amount of bytes that follow it contiguously in the buffer
+			const BYTE* translate(DWORD rva, size_t* pAvailable) const;
+			const char* getString(DWORD rva) const;
+			const IMAGE_EXPORT_DIRECTORY* getExportDirectory(const DWORD** pFunctions, const DWORD** pNameRvas, const WORD** pOrdinals) const;
+		};
+
+	}
+
+}
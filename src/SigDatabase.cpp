@@ -0,0 +1,350 @@
+#include "SigDatabase.h"
+
+namespace hax {
+
+	typedef struct SigDatabaseFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t capacity;
+		uint64_t entryCount;
+		uint64_t tableOffset;
+		uint64_t namesOffset;
+		uint64_t namesSize;
+	}SigDatabaseFileHeader;
+
+	// "HXSD"
+	static constexpr uint32_t SIG_DATABASE_MAGIC = 0x44535848u;
+	static constexpr uint32_t SIG_DATABASE_VERSION = 1u;
+	static constexpr size_t MIN_CAPACITY = 0x40u;
+
+	static uint32_t hashName(const char* name);
+	static size_t hashSlot(uint64_t moduleKey, uint32_t nameHash);
+	static bool writeAll(HANDLE hFile, const void* buffer, size_t size);
+
+	SigDatabase::SigDatabase() : _ownTable{}, _ownNames{}, _table{}, _capacity{}, _entryCount{}, _names{}, _namesSize{} {}
+
+
+	SigDatabase::~SigDatabase() {
+		this->clear();
+
+		return;
+	}
+
+
+	uint64_t SigDatabase::getModuleKey(const proc::PeHeaders* pPeHeaders) {
+
+		if (!pPeHeaders || !pPeHeaders->pFileHeader) return 0u;
+
+		DWORD sizeOfImage = 0ul;
+
+		if (pPeHeaders->pOptHeader64) {
+			sizeOfImage = pPeHeaders->pOptHeader64->SizeOfImage;
+		}
+		else if (pPeHeaders->pOptHeader32) {
+			sizeOfImage = pPeHeaders->pOptHeader32->SizeOfImage;
+		}
+		else {
+			return 0u;
+		}
+
+		return static_cast<uint64_t>(pPeHeaders->pFileHeader->TimeDateStamp) << 32u | sizeOfImage;
+	}
+
+
+	uint64_t SigDatabase::getContentKey(const void* data, size_t size) {
+		const BYTE* const bytes = reinterpret_cast<const BYTE*>(data);
+		uint64_t hash = 0xCBF29CE484222325ull;
+		size_t i = 0u;
+
+		// fnv-1a over eight bytes at once, files of a few megabytes are hashed in milliseconds
+		for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+			uint64_t word = 0u;
+			memcpy(&word, bytes + i, sizeof(uint64_t));
+			hash = (hash ^ word) * 0x100000001B3ull;
+		}
+
+		for (; i < size; i++) {
+			hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+		}
+
+		return hash;
+	}
+
+
+	bool SigDatabase::open(const BYTE* data, size_t size) {
+		this->clear();
+
+		if (!data || size < sizeof(SigDatabaseFileHeader)) return false;
+
+		const SigDatabaseFileHeader* const pHeader = reinterpret_cast<const SigDatabaseFileHeader*>(data);
+
+		if (pHeader->magic != SIG_DATABASE_MAGIC || pHeader->version != SIG_DATABASE_VERSION) return false;
+
+		// lookups rely on a power of two capacity and at least one empty slot
+		if (!pHeader->capacity || (pHeader->capacity & (pHeader->capacity - 1u)) || pHeader->entryCount >= pHeader->capacity) return false;
+
+		if (pHeader->tableOffset % sizeof(uint64_t) || pHeader->tableOffset > size || pHeader->capacity > (size - pHeader->tableOffset) / sizeof(Entry)) return false;
+
+		if (pHeader->namesOffset > size || pHeader->namesSize > size - pHeader->namesOffset) return false;
+
+		const char* const names = reinterpret_cast<const char*>(data + pHeader->namesOffset);
+
+		// names are only compared with strcmp if the pool is terminated
+		if (pHeader->namesSize && names[pHeader->namesSize - 1u] != '\0') return false;
+
+		this->_table = reinterpret_cast<const Entry*>(data + pHeader->tableOffset);
+		this->_capacity = static_cast<size_t>(pHeader->capacity);
+		this->_entryCount = static_cast<size_t>(pHeader->entryCount);
+		this->_names = names;
+		this->_namesSize = static_cast<size_t>(pHeader->namesSize);
+
+		return true;
+	}
+
+
+	DWORD SigDatabase::save(const char* path) const {
+		const HANDLE hFile = CreateFileA(path, GENERIC_WRITE, 0ul, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (hFile == INVALID_HANDLE_VALUE) {
+
+			return GetLastError();
+		}
+
+		// an empty database is saved with an empty table, so it can be opened again
+		const Entry emptyTable[1]{};
+		const Entry* const table = this->_capacity ? this->_table : emptyTable;
+
+		SigDatabaseFileHeader header{};
+		header.magic = SIG_DATABASE_MAGIC;
+		header.version = SIG_DATABASE_VERSION;
+		header.capacity = this->_capacity ? this->_capacity : 1u;
+		header.entryCount = this->_entryCount;
+		header.tableOffset = sizeof(SigDatabaseFileHeader);
+		header.namesOffset = header.tableOffset + header.capacity * sizeof(Entry);
+		header.namesSize = this->_namesSize;
+
+		const bool written = writeAll(hFile, &header, sizeof(header)) && writeAll(hFile, table, static_cast<size_t>(header.capacity) * sizeof(Entry)) &&
+			writeAll(hFile, this->_names, this->_namesSize);
+
+		if (!written) {
+			const DWORD error = GetLastError();
+			CloseHandle(hFile);
+
+			return error;
+		}
+
+		CloseHandle(hFile);
+
+		return ERROR_SUCCESS;
+	}
+
+
+	bool SigDatabase::lookup(uint64_t moduleKey, const char* name, DWORD* pRva) const {
+
+		if (!this->_capacity) return false;
+
+		const size_t slot = this->findSlot(moduleKey, name, hashName(name));
+
+		if (slot == SIZE_MAX || !this->_table[slot].used) return false;
+
+		*pRva = this->_table[slot].rva;
+
+		return true;
+	}
+
+
+	void SigDatabase::add(uint64_t moduleKey, const char* name, DWORD rva) {
+		this->makeOwn();
+
+		// the table is kept at most half full for short probe sequences
+		if ((this->_entryCount + 1u) * 2u > this->_capacity) {
+			this->rehash(this->_capacity ? this->_capacity * 2u : MIN_CAPACITY);
+		}
+
+		const uint32_t nameHash = hashName(name);
+		const size_t slot = this->findSlot(moduleKey, name, nameHash);
+		Entry* const pEntry = &this->_ownTable[slot];
+
+		if (pEntry->used) {
+			pEntry->rva = rva;
+
+			return;
+		}
+
+		const size_t nameOffset = this->_ownNames.size();
+
+		for (size_t i = 0u; i == 0u || name[i - 1u]; i++) {
+			this->_ownNames.append(name[i]);
+		}
+
+		this->_names = this->_ownNames.data();
+		this->_namesSize = this->_ownNames.size();
+
+		pEntry->moduleKey = moduleKey;
+		pEntry->nameHash = nameHash;
+		pEntry->nameOffset = static_cast<uint32_t>(nameOffset);
+		pEntry->rva = rva;
+		pEntry->used = 1u;
+		this->_entryCount++;
+
+		return;
+	}
+
+
+	size_t SigDatabase::removeModule(uint64_t moduleKey) {
+		this->makeOwn();
+
+		size_t count = 0u;
+
+		for (size_t i = 0u; i < this->_capacity; i++) {
+
+			if (this->_ownTable[i].used && this->_ownTable[i].moduleKey == moduleKey) {
+				this->_ownTable[i].used = 0u;
+				count++;
+			}
+
+		}
+
+		if (!count) return 0u;
+
+		this->_entryCount -= count;
+		// removed slots would break the probe sequences of following entries, so the table is rebuilt
+		this->rehash(this->_capacity);
+
+		return count;
+	}
+
+
+	size_t SigDatabase::entryCount() const {
+
+		return this->_entryCount;
+	}
+
+
+	void SigDatabase::clear() {
+		delete[] this->_ownTable;
+		this->_ownTable = nullptr;
+		this->_ownNames.resize(0u);
+
+		this->_table = nullptr;
+		this->_capacity = 0u;
+		this->_entryCount = 0u;
+		this->_names = nullptr;
+		this->_namesSize = 0u;
+
+		return;
+	}
+
+
+	size_t SigDatabase::findSlot(uint64_t moduleKey, const char* name, uint32_t nameHash) const {
+		const size_t mask = this->_capacity - 1u;
+		size_t slot = hashSlot(moduleKey, nameHash) & mask;
+
+		for (size_t i = 0u; i < this->_capacity; i++) {
+			const Entry* const pEntry = &this->_table[slot];
+
+			if (!pEntry->used) return slot;
+
+			if (pEntry->moduleKey == moduleKey && pEntry->nameHash == nameHash && pEntry->nameOffset < this->_namesSize && !strcmp(this->_names + pEntry->nameOffset, name)) return slot;
+
+			slot = (slot + 1u) & mask;
+		}
+
+		return SIZE_MAX;
+	}
+
+
+	void SigDatabase::makeOwn() {
+
+		if (this->_table == this->_ownTable) return;
+
+		// copies the table and names of an opened file
+		this->_ownTable = new Entry[this->_capacity]{};
+		memcpy(this->_ownTable, this->_table, this->_capacity * sizeof(Entry));
+
+		this->_ownNames.resize(0u);
+		this->_ownNames.reserve(this->_namesSize);
+
+		for (size_t i = 0u; i < this->_namesSize; i++) {
+			this->_ownNames.append(this->_names[i]);
+		}
+
+		this->_table = this->_ownTable;
+		this->_names = this->_ownNames.data();
+
+		return;
+	}
+
+
+	void SigDatabase::rehash(size_t capacity) {
+		Entry* const oldTable = this->_ownTable;
+		const size_t oldCapacity = this->_capacity;
+		Vector<char> oldNames(static_cast<Vector<char>&&>(this->_ownNames));
+
+		this->_ownTable = new Entry[capacity]{};
+		this->_table = this->_ownTable;
+		this->_capacity = capacity;
+
+		for (size_t i = 0u; i < oldCapacity; i++) {
+			const Entry* const pOldEntry = &oldTable[i];
+
+			if (!pOldEntry->used || pOldEntry->nameOffset >= oldNames.size()) continue;
+
+			const char* const name = oldNames.data() + pOldEntry->nameOffset;
+			Entry* const pEntry = &this->_ownTable[this->findSlot(pOldEntry->moduleKey, name, pOldEntry->nameHash)];
+			*pEntry = *pOldEntry;
+			pEntry->nameOffset = static_cast<uint32_t>(this->_ownNames.size());
+
+			for (size_t j = 0u; j == 0u || name[j - 1u]; j++) {
+				this->_ownNames.append(name[j]);
+			}
+
+			// following probes compare against the names appended so far
+			this->_names = this->_ownNames.data();
+			this->_namesSize = this->_ownNames.size();
+		}
+
+		this->_names = this->_ownNames.data();
+		this->_namesSize = this->_ownNames.size();
+
+		delete[] oldTable;
+
+		return;
+	}
+
+
+	static uint32_t hashName(const char* name) {
+		uint32_t hash = 0x811C9DC5u;
+
+		for (size_t i = 0u; name[i]; i++) {
+			hash = (hash ^ static_cast<BYTE>(name[i])) * 0x01000193u;
+		}
+
+		return hash;
+	}
+
+
+	static size_t hashSlot(uint64_t moduleKey, uint32_t nameHash) {
+
+		return static_cast<size_t>(((moduleKey ^ nameHash) * 0x9E3779B97F4A7C15ull) >> 32u);
+	}
+
+
+	static bool writeAll(HANDLE hFile, const void* buffer, size_t size) {
+		const BYTE* cur = reinterpret_cast<const BYTE*>(buffer);
+
+		// WriteFile takes sizes of 32 bits
+		while (size) {
+			const DWORD toWrite = size > 0x40000000u ? 0x40000000ul : static_cast<DWORD>(size);
+			DWORD written = 0ul;
+
+			if (!WriteFile(hFile, cur, toWrite, &written, nullptr) || !written) return false;
+
+			cur += written;
+			size -= written;
+		}
+
+		return true;
+	}
+
+}
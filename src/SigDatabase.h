@@ -0,0 +1,169 @@
+#pragma once
+#include "proc.h"
+#include "Vector.h"
+#include <stdint.h>
+
+// Class to store resolved signature results per module build in a file that is mapped into memory.
+
+namespace hax {
+
+	// Database of relative virtual addresses keyed by the identity of a module and a name.
+	// Signatures only have to be scanned for once per module build, the results are looked up in constant time on following runs.
+	// The database is an open addressing hash table that is saved as is, so an opened file is used in place without parsing or copying.
+	// Example:
+	// hax::FileMapper file("offsets.bin");
+	// hax::SigDatabase database;
+	// database.open(file.map() == ERROR_SUCCESS ? file.data() : nullptr, file.size());
+	// const uint64_t moduleKey = hax::SigDatabase::getModuleKey(&peHeaders);
+	// DWORD rva = 0ul;
+	// // only scans if the module build changed
+	// const bool found = database.lookup(moduleKey, "LocalPlayer", &rva);
+	class SigDatabase {
+	public:
+		// Slot of the hash table. Layout is shared with the file format.
+		typedef struct Entry {
+			uint64_t moduleKey;
+			uint32_t nameHash;
+			// offset of the name within the name pool
+			uint32_t nameOffset;
+			uint32_t rva;
+			// zero for empty slots
+			uint32_t used;
+		}Entry;
+
+	private:
+		Entry* _ownTable;
+		Vector<char> _ownNames;
+
+		// either the own table and names or memory of an opened file
+		const Entry* _table;
+		size_t _capacity;
+		size_t _entryCount;
+		const char* _names;
+		size_t _namesSize;
+
+	public:
+		SigDatabase();
+
+		SigDatabase(SigDatabase&&) = delete;
+
+		SigDatabase(const SigDatabase&) = delete;
+
+		SigDatabase& operator=(SigDatabase&&) = delete;
+
+		SigDatabase& operator=(const SigDatabase&) = delete;
+
+		~SigDatabase();
+
+		// Gets the key of a module build from its headers. Works for modules of processes as well as for files on disk.
+		// 
+		// Parameters:
+		// 
+		// [in] pPeHeaders:
+		// The headers of the module, eg. from proc::ex::getPeHeaders or pe::Image::headers.
+		// 
+		// Return:
+		// The key made of the TimeDateStamp of the file header and the SizeOfImage of the optional header or zero on failure.
+		static uint64_t getModuleKey(const proc::PeHeaders* pPeHeaders);
+
+		// Gets the key of a module build from the content of its file.
+		// Slower than getModuleKey but also distinguishes builds with equal headers, eg. patched files.
+		// 
+		// Parameters:
+		// 
+		// [in] data:
+		// The content of the file, eg. FileMapper::data().
+		// 
+		// [in] size:
+		// Size of the content in bytes.
+		// 
+		// Return:
+		// A 64 bit hash of the content.
+		static uint64_t getContentKey(const void* data, size_t size);
+
+		// Opens a database from memory that holds a saved database file. The memory is used in place and has to stay valid until the database is modified, cleared or destroyed.
+		// Replaces the current content of the database.
+		// 
+		// Parameters:
+		// 
+		// [in] data:
+		// Pointer to the file content, eg. FileMapper::data().
+		// 
+		// [in] size:
+		// Size of the file content in bytes.
+		// 
+		// Return:
+		// True on success, false if the memory does not hold a valid database file.
+		bool open(const BYTE* data, size_t size);
+
+		// Saves the database to a file that can be mapped and opened again.
+		// 
+		// Parameters:
+		// 
+		// [in] path:
+		// Path of the file. An existing file is overwritten, so a file the database was opened from has to be unmapped first.
+		// 
+		// Return:
+		// ERROR_SUCCESS on success, last WinError on failure.
+		DWORD save(const char* path) const;
+
+		// Looks up a relative virtual address.
+		// 
+		// Parameters:
+		// 
+		// [in] moduleKey:
+		// Key of the module build as returned by getModuleKey or getContentKey.
+		// 
+		// [in] name:
+		// Name the address was added with. Compared case sensitive.
+		// 
+		// [out] pRva:
+		// Receives the relative virtual address.
+		// 
+		// Return:
+		// True if the address was found, false if it has to be resolved again.
+		bool lookup(uint64_t moduleKey, const char* name, DWORD* pRva) const;
+
+		// Adds or replaces a relative virtual address. The content of an opened file is copied on the first modification.
+		// 
+		// Parameters:
+		// 
+		// [in] moduleKey:
+		// Key of the module build as returned by getModuleKey or getContentKey.
+		// 
+		// [in] name:
+		// Name of the address, eg. the name of the signature it was resolved with.
+		// 
+		// [in] rva:
+		// The relative virtual address within the module.
+		void add(uint64_t moduleKey, const char* name, DWORD rva);
+
+		// Removes all addresses of a module build, eg. of an outdated build.
+		// 
+		// Parameters:
+		// 
+		// [in] moduleKey:
+		// Key of the module build.
+		// 
+		// Return:
+		// The amount of removed addresses.
+		size_t removeModule(uint64_t moduleKey);
+
+		// Gets the amount of stored addresses.
+		// 
+		// Return:
+		// The amount of addresses of all modules.
+		size_t entryCount() const;
+
+		// Removes all addresses.
+		void clear();
+
+	private:
+		// gets the slot of an entry or the empty slot it would be inserted at, SIZE_MAX if the table is full
+		size_t findSlot(uint64_t moduleKey, const char* name, uint32_t nameHash) const;
+		void makeOwn();
+		// reinserts all used slots into a table with the capacity and drops the names of unused slots
+		void rehash(size_t capacity);
+	};
+
+}
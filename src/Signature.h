@@ -0,0 +1,160 @@
+#pragma once
+#include <Windows.h>
+
+// Byte signature that is parsed only once, either at compile time or at runtime.
+// Holds the packed bytes and a mask for the wildcards, so scanning with it does not need to parse or allocate anything.
+// Patterns that are parsed at compile time and are malformed fail to compile.
+// Example:
+// constexpr hax::mem::Signature sig("DE AD ?? EF");
+// void* const address = hax::mem::in::findSigAddress(base, size, sig);
+
+namespace hax {
+
+	namespace mem {
+
+		class Signature {
+		public:
+			// Maximum amount of bytes of a signature.
+			static constexpr size_t MAX_SIZE = 0x80u;
+
+		private:
+			BYTE _bytes[MAX_SIZE];
+			BYTE _mask[MAX_SIZE];
+			size_t _size;
+			bool _valid;
+
+		public:
+			// Parses a byte signature from a string.
+			// The object is invalid if the string is malformed or the signature has more than MAX_SIZE bytes.
+			// If the object is constructed at compile time a malformed string is a compile error.
+			// 
+			// Parameters:
+			// 
+			// [in] pattern:
+			// The byte signature base hex as null terminated string.
+			// Bytes have to be two characters and separeted by spaces. "??" or "?" can be used as wildcards.
+			// Example: "DE AD ?? EF"
+			constexpr Signature(const char* pattern) : _bytes{}, _mask{}, _size{}, _valid{} {
+
+				if (!pattern) {
+					malformed();
+
+					return;
+				}
+
+				size_t size = 0u;
+				const char* cur = pattern;
+
+				while (*cur) {
+
+					if (*cur == ' ') {
+						cur++;
+
+						continue;
+					}
+
+					if (size == MAX_SIZE) {
+						malformed();
+
+						return;
+					}
+
+					if (*cur == '?') {
+						cur++;
+
+						if (*cur == '?') {
+							cur++;
+						}
+
+						this->_bytes[size] = 0x00;
+						this->_mask[size] = 0x00;
+					}
+					else {
+						const int high = hexToInt(cur[0]);
+						const int low = high != -1 ? hexToInt(cur[1]) : -1;
+
+						if (low == -1) {
+							malformed();
+
+							return;
+						}
+
+						cur += 2;
+
+						this->_bytes[size] = static_cast<BYTE>(high << 4 | low);
+						this->_mask[size] = 0xFF;
+					}
+
+					// bytes have to be separated by spaces
+					if (*cur && *cur != ' ') {
+						malformed();
+
+						return;
+					}
+
+					size++;
+				}
+
+				if (!size) {
+					malformed();
+
+					return;
+				}
+
+				this->_size = size;
+
+				this->_valid = true;
+
+				return;
+			}
+
+
+			// Checks if the pattern the signature was constructed from was well formed.
+			// 
+			// Return:
+			// True if the signature can be used for scanning, false otherwise.
+			constexpr bool valid() const {
+
+				return this->_valid;
+			}
+
+
+			constexpr const BYTE* bytes() const {
+
+				return this->_bytes;
+			}
+
+
+			// A byte of the mask is 0x00 for a wildcard and 0xFF otherwise.
+			constexpr const BYTE* mask() const {
+
+				return this->_mask;
+			}
+
+
+			constexpr size_t size() const {
+
+				return this->_size;
+			}
+
+		private:
+			// Deliberately not constexpr: reaching it during constant evaluation turns a malformed pattern into a compile error.
+			static void malformed() {}
+
+
+			static constexpr int hexToInt(char c) {
+
+				if (c >= '0' && c <= '9') return c - '0';
+
+				if (c >= 'A' && c <= 'F') return c - 'A' + 0xA;
+
+				if (c >= 'a' && c <= 'f') return c - 'a' + 0xA;
+
+				return -1;
+			}
+
+		};
+
+	}
+
+}
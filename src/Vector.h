@@ -217,10 +217,21 @@ namespace hax {
 		// Number of elements the vector should be grown by.
 		void grow(size_t n) {
 
+			// reserve once for the whole range instead of reallocating while appending
+			if (this->_size + n > this->_capacity) {
+				const size_t capacity = 2u * this->_capacity;
+				this->reserve(capacity > this->_size + n ? capacity : this->_size + n);
+
+				if (this->_size + n > this->_capacity) return;
+
+			}
+
 			for (size_t i = 0u; i < n; i++) {
-				this->append(T());
+				new(&this->_data[this->_size + i]) T();
 			}
 
+			this->_size += n;
+
 			return;
 		}
 
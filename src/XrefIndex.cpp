@@ -0,0 +1,409 @@
+#include "XrefIndex.h"
+#include "scan\ModuleScanner.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace hax {
+
+	namespace pe {
+
+		// legacy prefixes plus the REX prefix that are looked at in front of an opcode
+		static constexpr size_t MAX_PREFIX_COUNT = 4u;
+
+		typedef struct SweepContext {
+			const Image* pImage;
+			const Vector<ModuleScanner::SectionRange>* pCodeRanges;
+			DWORD sizeOfImage;
+			DWORD types;
+			Vector<Xref>* pXrefs;
+		}SweepContext;
+
+		static void sweepCode(const BYTE* code, size_t size, DWORD rva, const SweepContext* pContext);
+		// gets the size of the immediate of a one byte opcode with a memory operand, SIZE_MAX if the opcode can not have a RIP-relative memory operand
+		static size_t getImmediateSize(BYTE opcode, BYTE modRm);
+		// gets the size of the immediate of a two byte opcode (0F xx) with a memory operand, SIZE_MAX if the opcode can not have a RIP-relative memory operand
+		static size_t getTwoByteImmediateSize(BYTE opcode);
+		static bool isInRanges(const Vector<ModuleScanner::SectionRange>* pRanges, DWORD rva);
+		static bool addAbsoluteXref(const Relocation* pRelocation, void* pArg);
+		// orders references by target and source for qsort
+		static int compareXrefs(const void* pXref1, const void* pXref2);
+
+		XrefIndex::XrefIndex() : _xrefs{} {}
+
+
+		XrefIndex::~XrefIndex() {
+			this->clear();
+
+			return;
+		}
+
+
+		size_t XrefIndex::build(const Image* pImage, DWORD types) {
+			this->clear();
+
+			if (!pImage || !pImage->headers()->pFileHeader || !pImage->sectionCount()) return 0u;
+
+			const DWORD sizeOfImage = pImage->sizeOfImage();
+			Vector<ModuleScanner::SectionRange> codeRanges{};
+			ModuleScanner::getSectionRanges(pImage->getSection(0u), pImage->sectionCount(), pImage->getDataDirectory(IMAGE_DIRECTORY_ENTRY_RESOURCE), sizeOfImage, mem::SECTION_CODE, &codeRanges);
+
+			// RIP-relative addressing only exists in x64 code
+			if (!pImage->is64()) {
+				types &= ~static_cast<DWORD>(XREF_RIP_RELATIVE);
+			}
+
+			SweepContext context{ pImage, &codeRanges, sizeOfImage, types, &this->_xrefs };
+
+			if (types & (XREF_CALL | XREF_JUMP | XREF_RIP_RELATIVE)) {
+
+				for (size_t i = 0u; i < codeRanges.size(); i++) {
+					size_t size = 0u;
+					const BYTE* const code = pImage->getSectionData(pImage->getSectionOfRva(codeRanges[i].rva), &size);
+
+					if (!code) continue;
+
+					// raw data of a section can be larger than its virtual size due to file alignment
+					if (size > codeRanges[i].size) {
+						size = codeRanges[i].size;
+					}
+
+					sweepCode(code, size, codeRanges[i].rva, &context);
+				}
+
+			}
+
+			if (types & XREF_ABSOLUTE) {
+				pImage->enumRelocations(addAbsoluteXref, &context);
+			}
+
+			qsort(this->_xrefs.data(), this->_xrefs.size(), sizeof(Xref), compareXrefs);
+
+			return this->_xrefs.size();
+		}
+
+
+		size_t XrefIndex::findReferences(DWORD targetRva, const Xref** pXrefs) const {
+			const size_t first = this->lowerBound(targetRva);
+			size_t last = first;
+
+			while (last < this->_xrefs.size() && this->_xrefs[last].targetRva == targetRva) {
+				last++;
+			}
+
+			*pXrefs = this->_xrefs.data() + first;
+
+			return last - first;
+		}
+
+
+		size_t XrefIndex::findReferences(DWORD targetRva, DWORD size, const Xref** pXrefs) const {
+			const size_t first = this->lowerBound(targetRva);
+			const size_t last = targetRva + size < targetRva ? this->_xrefs.size() : this->lowerBound(targetRva + size);
+			*pXrefs = this->_xrefs.data() + first;
+
+			return last - first;
+		}
+
+
+		const Xref* XrefIndex::xrefs(size_t* pCount) const {
+			*pCount = this->_xrefs.size();
+
+			return this->_xrefs.data();
+		}
+
+
+		void XrefIndex::clear() {
+			this->_xrefs.resize(0u);
+
+			return;
+		}
+
+
+		size_t XrefIndex::lowerBound(DWORD targetRva) const {
+			size_t low = 0u;
+			size_t high = this->_xrefs.size();
+
+			while (low < high) {
+				const size_t mid = low + (high - low) / 2u;
+
+				if (this->_xrefs[mid].targetRva < targetRva) {
+					low = mid + 1u;
+				}
+				else {
+					high = mid;
+				}
+
+			}
+
+			return low;
+		}
+
+
+		static void sweepCode(const BYTE* code, size_t size, DWORD rva, const SweepContext* pContext) {
+
+			for (size_t i = 0u; i + 5u <= size; i++) {
+				const BYTE cur = code[i];
+
+				// call rel32 and jmp rel32
+				if ((cur == 0xE8u && (pContext->types & XREF_CALL)) || (cur == 0xE9u && (pContext->types & XREF_JUMP))) {
+					const int64_t target = static_cast<int64_t>(rva) + i + 5u + *reinterpret_cast<const int32_t*>(code + i + 1u);
+
+					if (target >= 0 && target < pContext->sizeOfImage && isInRanges(pContext->pCodeRanges, static_cast<DWORD>(target))) {
+						pContext->pXrefs->append(Xref{ static_cast<DWORD>(target), static_cast<DWORD>(rva + i), cur == 0xE8u ? static_cast<DWORD>(XREF_CALL) : static_cast<DWORD>(XREF_JUMP) });
+					}
+
+				}
+
+				// jcc rel32
+				if (cur == 0x0Fu && (code[i + 1u] & 0xF0u) == 0x80u && i + 6u <= size && (pContext->types & XREF_JUMP)) {
+					const int64_t target = static_cast<int64_t>(rva) + i + 6u + *reinterpret_cast<const int32_t*>(code + i + 2u);
+
+					if (target >= 0 && target < pContext->sizeOfImage && isInRanges(pContext->pCodeRanges, static_cast<DWORD>(target))) {
+						pContext->pXrefs->append(Xref{ static_cast<DWORD>(target), static_cast<DWORD>(rva + i), static_cast<DWORD>(XREF_JUMP) });
+					}
+
+				}
+
+				// mod 00 and r/m 101 of a ModRM byte is a RIP-relative disp32 operand in x64
+				if ((cur & 0xC7u) != 0x05u || !i || !(pContext->types & XREF_RIP_RELATIVE)) continue;
+
+				size_t opcode = SIZE_MAX;
+				size_t immediateSize = SIZE_MAX;
+
+				if (i >= 2u && code[i - 2u] == 0x0Fu) {
+					immediateSize = getTwoByteImmediateSize(code[i - 1u]);
+					opcode = i - 2u;
+				}
+
+				if (immediateSize == SIZE_MAX) {
+					immediateSize = getImmediateSize(code[i - 1u], cur);
+					opcode = i - 1u;
+				}
+
+				if (immediateSize == SIZE_MAX) continue;
+
+				// the prefixes in front of the opcode are only needed for the size of the immediate
+				size_t prefix = opcode;
+				bool rexW = false;
+
+				if (prefix && (code[prefix - 1u] & 0xF0u) == 0x40u) {
+					prefix--;
+					rexW = (code[prefix] & 0x08u) != 0u;
+				}
+
+				bool operandSizeOverride = false;
+
+				while (prefix && opcode - prefix < MAX_PREFIX_COUNT && (code[prefix - 1u] == 0x66u || code[prefix - 1u] == 0xF2u || code[prefix - 1u] == 0xF3u)) {
+					prefix--;
+					operandSizeOverride |= code[prefix] == 0x66u;
+				}
+
+				// 32 bit immediates are 16 bit with an operand size override prefix unless REX.W is set
+				if (immediateSize == 4u && operandSizeOverride && !rexW) {
+					immediateSize = 2u;
+				}
+
+				const size_t end = i + 5u + immediateSize;
+
+				if (end > size) continue;
+
+				const int64_t target = static_cast<int64_t>(rva) + end + *reinterpret_cast<const int32_t*>(code + i + 1u);
+
+				if (target >= 0 && target < pContext->sizeOfImage) {
+					pContext->pXrefs->append(Xref{ static_cast<DWORD>(target), static_cast<DWORD>(rva + opcode), static_cast<DWORD>(XREF_RIP_RELATIVE) });
+				}
+
+			}
+
+			return;
+		}
+
+
+		static size_t getImmediateSize(BYTE opcode, BYTE modRm) {
+			const BYTE reg = (modRm >> 3u) & 0x7u;
+
+			// add, or, adc, sbb, and, sub, xor and cmp in their r/m, reg and reg, r/m forms
+			if (opcode < 0x40u && (opcode & 0x7u) < 0x4u) return 0u;
+
+			switch (opcode) {
+			// movsxd, test, xchg, mov, lea, pop, shifts by one and cl, x87
+			case 0x63:
+			case 0x84:
+			case 0x85:
+			case 0x86:
+			case 0x87:
+			case 0x88:
+			case 0x89:
+			case 0x8A:
+			case 0x8B:
+			case 0x8C:
+			case 0x8D:
+			case 0x8E:
+			case 0x8F:
+			case 0xD0:
+			case 0xD1:
+			case 0xD2:
+			case 0xD3:
+			case 0xD8:
+			case 0xD9:
+			case 0xDA:
+			case 0xDB:
+			case 0xDC:
+			case 0xDD:
+			case 0xDE:
+			case 0xDF:
+
+				return 0u;
+			// imul, group 1 and shifts with an 8 bit immediate
+			case 0x6B:
+			case 0x80:
+			case 0x83:
+			case 0xC0:
+			case 0xC1:
+
+				return 1u;
+			// imul and group 1 with a 32 bit immediate
+			case 0x69:
+			case 0x81:
+
+				return 4u;
+			// mov r/m, imm
+			case 0xC6:
+
+				return reg == 0u ? 1u : SIZE_MAX;
+			case 0xC7:
+
+				return reg == 0u ? 4u : SIZE_MAX;
+			// test r/m, imm and not, neg, mul, imul, div, idiv
+			case 0xF6:
+
+				return reg == 0u ? 1u : reg == 1u ? SIZE_MAX : 0u;
+			case 0xF7:
+
+				return reg == 0u ? 4u : reg == 1u ? SIZE_MAX : 0u;
+			// inc, dec
+			case 0xFE:
+
+				return reg < 2u ? 0u : SIZE_MAX;
+			// inc, dec, call, jmp, push
+			case 0xFF:
+
+				return reg == 0u || reg == 1u || reg == 2u || reg == 4u || reg == 6u ? 0u : SIZE_MAX;
+			default:
+
+				return SIZE_MAX;
+			}
+
+		}
+
+
+		static size_t getTwoByteImmediateSize(BYTE opcode) {
+
+			// sse moves and conversions, prefetch and hint nops, cmovcc, sse arithmetic and logic
+			if ((opcode >= 0x10u && opcode <= 0x1Fu) || (opcode >= 0x28u && opcode <= 0x2Fu) || (opcode >= 0x40u && opcode <= 0x6Fu)) return 0u;
+
+			// setcc and sse integer arithmetic
+			if ((opcode >= 0x90u && opcode <= 0x9Fu) || (opcode >= 0xD1u && opcode <= 0xFEu)) return 0u;
+
+			switch (opcode) {
+			// movd, movq, bt, bts, btr, btc, shld, shrd by cl, imul, cmpxchg, movzx, movsx, xadd
+			case 0x7E:
+			case 0x7F:
+			case 0xA3:
+			case 0xA5:
+			case 0xAB:
+			case 0xAD:
+			case 0xAF:
+			case 0xB0:
+			case 0xB1:
+			case 0xB3:
+			case 0xB6:
+			case 0xB7:
+			case 0xBB:
+			case 0xBC:
+			case 0xBD:
+			case 0xBE:
+			case 0xBF:
+			case 0xC0:
+			case 0xC1:
+
+				return 0u;
+			// pshufd, shld, shrd, bt group, cmpps, shufps with an 8 bit immediate
+			case 0x70:
+			case 0xA4:
+			case 0xAC:
+			case 0xBA:
+			case 0xC2:
+			case 0xC6:
+
+				return 1u;
+			default:
+
+				return SIZE_MAX;
+			}
+
+		}
+
+
+		static bool isInRanges(const Vector<ModuleScanner::SectionRange>* pRanges, DWORD rva) {
+
+			for (size_t i = 0u; i < pRanges->size(); i++) {
+
+				if (rva - (*pRanges)[i].rva < (*pRanges)[i].size) return true;
+
+			}
+
+			return false;
+		}
+
+
+		static bool addAbsoluteXref(const Relocation* pRelocation, void* pArg) {
+			const SweepContext* const pContext = reinterpret_cast<const SweepContext*>(pArg);
+
+			if (!isInRanges(pContext->pCodeRanges, pRelocation->rva)) return true;
+
+			uint64_t address = 0u;
+
+			if (pRelocation->type == IMAGE_REL_BASED_HIGHLOW) {
+				const BYTE* const pAddress = pContext->pImage->rvaToPointer(pRelocation->rva, sizeof(uint32_t));
+
+				if (!pAddress) return true;
+
+				address = *reinterpret_cast<const uint32_t*>(pAddress);
+			}
+			else if (pRelocation->type == IMAGE_REL_BASED_DIR64) {
+				const BYTE* const pAddress = pContext->pImage->rvaToPointer(pRelocation->rva, sizeof(uint64_t));
+
+				if (!pAddress) return true;
+
+				address = *reinterpret_cast<const uint64_t*>(pAddress);
+			}
+			else {
+				return true;
+			}
+
+			// the loader writes the actual base into the headers of a loaded image, so the address is relative to the base of the optional header for files as well as for loaded images
+			const uint64_t target = address - pContext->pImage->imageBase();
+
+			if (target < pContext->sizeOfImage) {
+				pContext->pXrefs->append(Xref{ static_cast<DWORD>(target), pRelocation->rva, static_cast<DWORD>(XREF_ABSOLUTE) });
+			}
+
+			return true;
+		}
+
+
+		static int compareXrefs(const void* pXref1, const void* pXref2) {
+			const Xref* const pX1 = reinterpret_cast<const Xref*>(pXref1);
+			const Xref* const pX2 = reinterpret_cast<const Xref*>(pXref2);
+
+			if (pX1->targetRva != pX2->targetRva) return pX1->targetRva < pX2->targetRva ? -1 : 1;
+
+			if (pX1->sourceRva != pX2->sourceRva) return pX1->sourceRva < pX2->sourceRva ? -1 : 1;
+
+			return 0;
+		}
+
+	}
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include "PeImage.h"
+#include "Vector.h"
+
+// Class to look up the code that references an address of a PE image without rescanning the image for every lookup.
+
+namespace hax {
+
+	namespace pe {
+
+		// Types of references in the code of an image. Can be combined.
+		typedef enum XrefType {
+			// call rel32 (E8)
+			XREF_CALL = 0x1,
+			// jmp rel32 (E9) and jcc rel32 (0F 80 - 0F 8F)
+			XREF_JUMP = 0x2,
+			// memory operands addressed relative to the instruction pointer, only in x64 images
+			XREF_RIP_RELATIVE = 0x4,
+			// absolute addresses within the code that are fixed up by base relocations, mostly in x86 images
+			XREF_ABSOLUTE = 0x8,
+			XREF_ALL = XREF_CALL | XREF_JUMP | XREF_RIP_RELATIVE | XREF_ABSOLUTE
+		}XrefType;
+
+		typedef struct Xref {
+			// relative virtual address of the referenced address
+			DWORD targetRva;
+			// relative virtual address of the opcode of the referencing instruction, for absolute references of the address operand
+			// prefixes are not included, since they can not be told apart from the end of the previous instruction without decoding
+			DWORD sourceRva;
+			// one of the XrefType values
+			DWORD type;
+		}Xref;
+
+		// Index of the references from the code sections of an image to addresses within the image.
+		// The code sections are swept once and all references are stored sorted by their targets, so the references to an address are found by a binary search.
+		// The sweep does not decode instructions but matches the encodings of the reference types at every byte.
+		// So references can be found within data that is embedded in code or within other instructions. References to targets outside of the image, or for calls and jumps outside of the code sections, are dropped, which filters most of them.
+		// Example of finding the functions that access a global variable found by a signature:
+		// hax::pe::XrefIndex index;
+		// index.build(&image);
+		// const hax::pe::Xref* pXrefs = nullptr;
+		// const size_t count = index.findReferences(globalRva, &pXrefs);
+		// for (size_t i = 0u; i < count; i++) {
+		//     const IMAGE_RUNTIME_FUNCTION_ENTRY* const pFunction = image.findRuntimeFunction(pXrefs[i].sourceRva);
+		// }
+		class XrefIndex {
+		private:
+			Vector<Xref> _xrefs;
+
+		public:
+			XrefIndex();
+
+			XrefIndex(XrefIndex&&) = delete;
+
+			XrefIndex(const XrefIndex&) = delete;
+
+			XrefIndex& operator=(XrefIndex&&) = delete;
+
+			XrefIndex& operator=(const XrefIndex&) = delete;
+
+			~XrefIndex();
+
+			// Builds the index from the code sections of an image. Replaces the current content of the index.
+			// Works on raw files as well as on images mapped by the system or read from a process.
+			// 
+			// Parameters:
+			// 
+			// [in] pImage:
+			// The parsed image. Only used during the call.
+			// 
+			// [in] types:
+			// Combination of XrefType values of the references that are indexed.
+			// 
+			// Return:
+			// The amount of indexed references.
+			size_t build(const Image* pImage, DWORD types = XREF_ALL);
+
+			// Finds the references to an address.
+			// 
+			// Parameters:
+			// 
+			// [in] targetRva:
+			// Relative virtual address of the referenced address.
+			// 
+			// [out] pXrefs:
+			// Receives a pointer to the first reference. The references are sorted by their source addresses and valid until the index is built again or cleared.
+			// 
+			// Return:
+			// The amount of references to the address.
+			size_t findReferences(DWORD targetRva, const Xref** pXrefs) const;
+
+			// Finds the references to addresses within a range, eg. to any member of a global structure.
+			// 
+			// Parameters:
+			// 
+			// [in] targetRva:
+			// Relative virtual address of the start of the range.
+			// 
+			// [in] size:
+			// Size of the range in bytes.
+			// 
+			// [out] pXrefs:
+			// Receives a pointer to the first reference. The references are sorted by their targets and valid until the index is built again or cleared.
+			// 
+			// Return:
+			// The amount of references to addresses within the range.
+			size_t findReferences(DWORD targetRva, DWORD size, const Xref** pXrefs) const;
+
+			// Gets all references of the index.
+			// 
+			// Parameters:
+			// 
+			// [out] pCount:
+			// Receives the amount of references.
+			// 
+			// Return:
+			// The references sorted by their targets.
+			const Xref* xrefs(size_t* pCount) const;
+
+			// Removes all references.
+			void clear();
+
+		private:
+			// gets the index of the first reference with a target not below the address
+			size_t lowerBound(DWORD targetRva) const;
+		};
+
+	}
+
+}
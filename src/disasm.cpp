@@ -0,0 +1,563 @@
+#include "disasm.h"
+#include <stdint.h>
+
+namespace hax {
+
+	namespace disasm {
+
+		// flags of the opcode tables
+		// the opcode is followed by a ModRM byte
+		static constexpr BYTE MODRM = 0x01u;
+		// 8 bit immediate
+		static constexpr BYTE IMM8 = 0x02u;
+		// 16 bit immediate
+		static constexpr BYTE IMM16 = 0x04u;
+		// 16 or 32 bit immediate depending on the operand size
+		static constexpr BYTE IMMZ = 0x08u;
+		// 16, 32 or 64 bit immediate depending on the operand size
+		static constexpr BYTE IMMV = 0x10u;
+		// 8 bit relative branch offset
+		static constexpr BYTE REL8 = 0x20u;
+		// 16 or 32 bit relative branch offset
+		static constexpr BYTE RELZ = 0x40u;
+		// prefixes, escapes and opcodes that need special decoding in the one byte table, invalid opcodes in the two byte table
+		static constexpr BYTE SPECIAL = 0x80u;
+
+		static constexpr BYTE M = MODRM;
+		static constexpr BYTE S = SPECIAL;
+
+		static constexpr BYTE ONE_BYTE_OPCODES[0x100]{
+			//    x0         x1         x2         x3         x4         x5         x6         x7         x8         x9         xA         xB         xC         xD         xE         xF
+			/*0x*/M,         M,         M,         M,         IMM8,      IMMZ,      0u,        0u,        M,         M,         M,         M,         IMM8,      IMMZ,      0u,        S,
+			/*1x*/M,         M,         M,         M,         IMM8,      IMMZ,      0u,        0u,        M,         M,         M,         M,         IMM8,      IMMZ,      0u,        0u,
+			/*2x*/M,         M,         M,         M,         IMM8,      IMMZ,      S,         0u,        M,         M,         M,         M,         IMM8,      IMMZ,      S,         0u,
+			/*3x*/M,         M,         M,         M,         IMM8,      IMMZ,      S,         0u,        M,         M,         M,         M,         IMM8,      IMMZ,      S,         0u,
+			/*4x*/0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,
+			/*5x*/0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,
+			/*6x*/0u,        0u,        S,         M,         S,         S,         S,         S,         IMMZ,      M | IMMZ,  IMM8,      M | IMM8,  0u,        0u,        0u,        0u,
+			/*7x*/REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,      REL8,
+			/*8x*/M | IMM8,  M | IMMZ,  M | IMM8,  M | IMM8,  M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*9x*/0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        S,         0u,        0u,        0u,        0u,        0u,
+			/*Ax*/S,         S,         S,         S,         0u,        0u,        0u,        0u,        IMM8,      IMMZ,      0u,        0u,        0u,        0u,        0u,        0u,
+			/*Bx*/IMM8,      IMM8,      IMM8,      IMM8,      IMM8,      IMM8,      IMM8,      IMM8,      IMMV,      IMMV,      IMMV,      IMMV,      IMMV,      IMMV,      IMMV,      IMMV,
+			/*Cx*/M | IMM8,  M | IMM8,  IMM16,     0u,        S,         S,         M | IMM8,  M | IMMZ,  S,         0u,        IMM16,     0u,        0u,        IMM8,      0u,        0u,
+			/*Dx*/M,         M,         M,         M,         IMM8,      IMM8,      0u,        0u,        M,         M,         M,         M,         M,         M,         M,         M,
+			/*Ex*/REL8,      REL8,      REL8,      REL8,      IMM8,      IMM8,      IMM8,      IMM8,      RELZ,      RELZ,      S,         REL8,      0u,        0u,        0u,        0u,
+			/*Fx*/S,         0u,        S,         S,         0u,        0u,        S,         S,         0u,        0u,        0u,        0u,        0u,        0u,        M,         M
+		};
+
+		static constexpr BYTE TWO_BYTE_OPCODES[0x100]{
+			//    x0         x1         x2         x3         x4         x5         x6         x7         x8         x9         xA         xB         xC         xD         xE         xF
+			/*0x*/M,         M,         M,         M,         S,         0u,        0u,        0u,        0u,        0u,        S,         0u,        S,         M,         0u,        M | IMM8,
+			/*1x*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*2x*/M,         M,         M,         M,         S,         S,         S,         S,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*3x*/0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,        S,         S,         S,         S,         S,         S,         S,         S,
+			/*4x*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*5x*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*6x*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*7x*/M | IMM8,  M | IMM8,  M | IMM8,  M | IMM8,  M,         M,         M,         0u,        M,         M,         S,         S,         M,         M,         M,         M,
+			/*8x*/RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,      RELZ,
+			/*9x*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*Ax*/0u,        0u,        0u,        M,         M | IMM8,  M,         S,         S,         0u,        0u,        0u,        M,         M | IMM8,  M,         M,         M,
+			/*Bx*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M | IMM8,  M,         M,         M,         M,         M,
+			/*Cx*/M,         M,         M | IMM8,  M,         M | IMM8,  M | IMM8,  M | IMM8,  M,         0u,        0u,        0u,        0u,        0u,        0u,        0u,        0u,
+			/*Dx*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*Ex*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,
+			/*Fx*/M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M,         M
+		};
+
+		// ASM:
+		// jmp 0x00000000
+		static constexpr size_t JMP_REL32_SIZE = 5u;
+		// ASM:
+		// jcc 0x00000000
+		static constexpr size_t JCC_REL32_SIZE = 6u;
+
+		static bool isLegacyPrefix(BYTE b);
+		// checks for opcodes of the one byte table that are only valid in 32 bit mode
+		static bool isInvalidX64(BYTE opcode);
+		// gets the flags of an opcode of a VEX or EVEX map
+		static BYTE getVexFlags(BYTE map, BYTE opcode);
+
+		size_t decode(const BYTE* code, size_t size, bool x64, Instruction* pInstruction) {
+			*pInstruction = Instruction{};
+			const size_t limit = size < MAX_INSTRUCTION_SIZE ? size : MAX_INSTRUCTION_SIZE;
+			size_t pos = 0u;
+			bool operandSizeOverride = false;
+			bool addressSizeOverride = false;
+			bool rexW = false;
+
+			while (pos < limit && isLegacyPrefix(code[pos])) {
+				operandSizeOverride |= code[pos] == 0x66u;
+				addressSizeOverride |= code[pos] == 0x67u;
+				pos++;
+			}
+
+			// a REX prefix has to directly precede the opcode, only the last of multiple REX prefixes counts
+			while (x64 && pos < limit && (code[pos] & 0xF0u) == 0x40u) {
+				rexW = (code[pos] & 0x08u) != 0u;
+				pos++;
+			}
+
+			if (pos >= limit) return 0u;
+
+			pInstruction->opcodeOffset = pos;
+			const BYTE opcode = code[pos];
+			pos++;
+
+			BYTE flags = 0u;
+			// additional immediate bytes of opcodes that are not described by the flags
+			size_t extraImmediateSize = 0u;
+			// not, neg, mul, imul, div and idiv of group 3 have no immediate unlike test
+			bool group3 = false;
+			bool registerOperand = false;
+
+			if (opcode == 0x0Fu) {
+
+				if (pos >= limit) return 0u;
+
+				const BYTE opcode2 = code[pos];
+				pos++;
+
+				if (opcode2 == 0x38u || opcode2 == 0x3Au) {
+
+					// three byte opcodes
+					if (pos >= limit) return 0u;
+
+					pos++;
+					flags = opcode2 == 0x38u ? MODRM : MODRM | IMM8;
+				}
+				else {
+					flags = TWO_BYTE_OPCODES[opcode2];
+
+					if (flags & SPECIAL) return 0u;
+
+					// mov to and from control and debug registers ignores the mod field and always has a register operand
+					registerOperand = opcode2 >= 0x20u && opcode2 <= 0x23u;
+				}
+
+			}
+			// VEX and EVEX prefixes overlay les, lds and bound in 32 bit mode, which can not have a register operand
+			// XOP prefixes overlay pop, which always has a zero reg field
+			else if (
+				((opcode == 0xC4u || opcode == 0xC5u || opcode == 0x62u) && (x64 || (pos < limit && (code[pos] & 0xC0u) == 0xC0u))) ||
+				(opcode == 0x8Fu && pos < limit && (code[pos] & 0x1Fu) >= 0x8u)
+			) {
+
+				if (pos >= limit) return 0u;
+
+				BYTE map = 1u;
+
+				if (opcode == 0xC5u) {
+					pos++;
+				}
+				else if (opcode == 0xC4u || opcode == 0x8Fu) {
+					map = code[pos] & 0x1Fu;
+					pos += 2u;
+				}
+				else {
+					map = code[pos] & 0x07u;
+					pos += 3u;
+				}
+
+				if (pos >= limit) return 0u;
+
+				flags = getVexFlags(map, code[pos]);
+				pos++;
+
+				if (flags & SPECIAL) return 0u;
+
+			}
+			else {
+
+				if (x64 && isInvalidX64(opcode)) return 0u;
+
+				flags = ONE_BYTE_OPCODES[opcode];
+
+				if (flags & SPECIAL) {
+
+					switch (opcode) {
+					// bound, les and lds with a memory operand
+					case 0x62:
+					case 0xC4:
+					case 0xC5:
+						flags = MODRM;
+						break;
+					// far call and far jmp with a 16 bit selector and a 16 or 32 bit offset
+					case 0x9A:
+					case 0xEA:
+						flags = 0u;
+						extraImmediateSize = operandSizeOverride ? 4u : 6u;
+						break;
+					// mov with an absolute memory offset of the address size
+					case 0xA0:
+					case 0xA1:
+					case 0xA2:
+					case 0xA3:
+						flags = 0u;
+
+						if (x64) {
+							extraImmediateSize = addressSizeOverride ? 4u : 8u;
+						}
+						else {
+							extraImmediateSize = addressSizeOverride ? 2u : 4u;
+						}
+
+						break;
+					// enter
+					case 0xC8:
+						flags = 0u;
+						extraImmediateSize = 3u;
+						break;
+					case 0xF6:
+					case 0xF7:
+						flags = MODRM;
+						group3 = true;
+						break;
+					default:
+
+						// legacy prefixes behind a REX prefix
+						return 0u;
+					}
+
+				}
+
+			}
+
+			if (flags & MODRM) {
+
+				if (pos >= limit) return 0u;
+
+				const BYTE modRm = code[pos];
+				pos++;
+
+				const BYTE mod = modRm >> 6u;
+				const BYTE reg = (modRm >> 3u) & 0x7u;
+				const BYTE rm = modRm & 0x7u;
+
+				// test r/m, imm
+				if (group3 && reg < 2u) {
+					flags |= opcode == 0xF6u ? IMM8 : IMMZ;
+				}
+
+				if (mod != 0x3u && !registerOperand) {
+					size_t displacementSize = 0u;
+
+					// 16 bit addressing has no SIB byte
+					if (!x64 && addressSizeOverride) {
+
+						if ((mod == 0x0u && rm == 0x6u) || mod == 0x2u) {
+							displacementSize = 2u;
+						}
+						else if (mod == 0x1u) {
+							displacementSize = 1u;
+						}
+
+					}
+					else {
+
+						if (rm == 0x4u) {
+
+							if (pos >= limit) return 0u;
+
+							// SIB byte without a base register
+							if (mod == 0x0u && (code[pos] & 0x7u) == 0x5u) {
+								displacementSize = 4u;
+							}
+
+							pos++;
+						}
+
+						if (mod == 0x0u && rm == 0x5u) {
+							displacementSize = 4u;
+
+							// absolute in 32 bit mode, relative to the instruction pointer in 64 bit mode
+							if (x64) {
+								pInstruction->relativeOffset = pos;
+								pInstruction->relativeSize = sizeof(int32_t);
+								pInstruction->ripRelative = true;
+							}
+
+						}
+						else if (mod == 0x1u) {
+							displacementSize = 1u;
+						}
+						else if (mod == 0x2u) {
+							displacementSize = 4u;
+						}
+
+					}
+
+					pos += displacementSize;
+				}
+
+			}
+
+			size_t immediateSize = extraImmediateSize;
+
+			if (flags & IMM8) {
+				immediateSize += 1u;
+			}
+
+			if (flags & IMM16) {
+				immediateSize += 2u;
+			}
+
+			if (flags & IMMZ) {
+				immediateSize += operandSizeOverride ? 2u : 4u;
+			}
+
+			if (flags & IMMV) {
+				immediateSize += rexW ? 8u : operandSizeOverride ? 2u : 4u;
+			}
+
+			if (flags & REL8) {
+				pInstruction->relativeOffset = pos;
+				pInstruction->relativeSize = 1u;
+				immediateSize += 1u;
+			}
+
+			if (flags & RELZ) {
+				pInstruction->relativeOffset = pos;
+				// the operand size override is ignored by branches in 64 bit mode
+				pInstruction->relativeSize = !x64 && operandSizeOverride ? 2u : 4u;
+				immediateSize += pInstruction->relativeSize;
+			}
+
+			pos += immediateSize;
+
+			if (pos > limit) {
+				*pInstruction = Instruction{};
+
+				return 0u;
+			}
+
+			pInstruction->length = pos;
+
+			return pos;
+		}
+
+
+		size_t getCopySize(const BYTE* code, size_t size, bool x64, size_t minSize) {
+			size_t copySize = 0u;
+
+			while (copySize < minSize) {
+				Instruction instruction{};
+				const size_t length = decode(code + copySize, size - copySize, x64, &instruction);
+
+				if (!length) return 0u;
+
+				copySize += length;
+			}
+
+			return copySize;
+		}
+
+
+		size_t relocate(const BYTE* code, size_t size, const void* address, bool x64, BYTE* dst, size_t dstSize, const void* dstAddress) {
+			const uintptr_t srcBase = reinterpret_cast<uintptr_t>(address);
+			const uintptr_t dstBase = reinterpret_cast<uintptr_t>(dstAddress);
+			size_t srcOffset = 0u;
+			size_t dstOffset = 0u;
+
+			while (srcOffset < size) {
+				Instruction instruction{};
+				const size_t length = decode(code + srcOffset, size - srcOffset, x64, &instruction);
+
+				if (!length) return 0u;
+
+				const BYTE* const pInstruction = code + srcOffset;
+
+				if (!instruction.relativeSize) {
+
+					if (dst) {
+
+						if (dstOffset + length > dstSize) return 0u;
+
+						memcpy(dst + dstOffset, pInstruction, length);
+					}
+
+					srcOffset += length;
+					dstOffset += length;
+
+					continue;
+				}
+
+				// 16 bit branch offsets only occur with an operand size override in 32 bit mode and would truncate the instruction pointer
+				if (instruction.relativeSize == 2u) return 0u;
+
+				int32_t offset = 0;
+
+				if (instruction.relativeSize == 1u) {
+					offset = *reinterpret_cast<const int8_t*>(pInstruction + instruction.relativeOffset);
+				}
+				else {
+					offset = *reinterpret_cast<const int32_t*>(pInstruction + instruction.relativeOffset);
+				}
+
+				uintptr_t target = srcBase + srcOffset + length + offset;
+
+				// the instruction pointer wraps around at 32 bits in 32 bit mode
+				if (!x64) {
+					target = static_cast<uint32_t>(target);
+				}
+
+				// branches into the copied instructions would have to be remapped
+				if (target - srcBase < size) return 0u;
+
+				size_t newLength = length;
+				size_t newOffsetPos = instruction.relativeOffset;
+
+				if (instruction.relativeSize == 1u) {
+					const BYTE opcode = pInstruction[instruction.opcodeOffset];
+
+					// prefixes of short branches are only branch hints and are dropped
+					if (opcode == 0xEBu) {
+						newLength = JMP_REL32_SIZE;
+						newOffsetPos = 1u;
+					}
+					else if (opcode >= 0x70u && opcode <= 0x7Fu) {
+						newLength = JCC_REL32_SIZE;
+						newOffsetPos = 2u;
+					}
+					else {
+
+						// loop and jcxz have no 32 bit form
+						return 0u;
+					}
+
+				}
+
+				if (dst) {
+
+					if (dstOffset + newLength > dstSize) return 0u;
+
+					const int64_t newOffset = static_cast<int64_t>(target - (dstBase + dstOffset + newLength));
+
+					if (x64 && (newOffset < INT32_MIN || newOffset > INT32_MAX)) return 0u;
+
+					if (instruction.relativeSize == 1u) {
+						const BYTE opcode = pInstruction[instruction.opcodeOffset];
+
+						if (opcode == 0xEBu) {
+							dst[dstOffset] = 0xE9u;
+						}
+						else {
+							dst[dstOffset] = 0x0Fu;
+							dst[dstOffset + 1u] = static_cast<BYTE>(0x80u | (opcode & 0x0Fu));
+						}
+
+					}
+					else {
+						memcpy(dst + dstOffset, pInstruction, length);
+					}
+
+					*reinterpret_cast<int32_t*>(dst + dstOffset + newOffsetPos) = static_cast<int32_t>(newOffset);
+				}
+
+				srcOffset += length;
+				dstOffset += newLength;
+			}
+
+			return dstOffset;
+		}
+
+
+		static bool isLegacyPrefix(BYTE b) {
+
+			switch (b) {
+			case 0x26:
+			case 0x2E:
+			case 0x36:
+			case 0x3E:
+			case 0x64:
+			case 0x65:
+			case 0x66:
+			case 0x67:
+			case 0xF0:
+			case 0xF2:
+			case 0xF3:
+
+				return true;
+			default:
+
+				return false;
+			}
+
+		}
+
+
+		static bool isInvalidX64(BYTE opcode) {
+
+			switch (opcode) {
+			case 0x06:
+			case 0x07:
+			case 0x0E:
+			case 0x16:
+			case 0x17:
+			case 0x1E:
+			case 0x1F:
+			case 0x27:
+			case 0x2F:
+			case 0x37:
+			case 0x3F:
+			case 0x60:
+			case 0x61:
+			case 0x82:
+			case 0x9A:
+			case 0xCE:
+			case 0xD4:
+			case 0xD5:
+			case 0xD6:
+			case 0xEA:
+
+				return true;
+			default:
+
+				return false;
+			}
+
+		}
+
+
+		static BYTE getVexFlags(BYTE map, BYTE opcode) {
+
+			switch (map) {
+			case 0x1:
+
+				// vzeroupper and vzeroall
+				if (opcode == 0x77u) return 0u;
+
+				// vpshufd, vpsrlw and similar, vcmpps, vpinsrw, vpextrw, vshufps
+				if ((opcode >= 0x70u && opcode <= 0x73u) || opcode == 0xC2u || (opcode >= 0xC4u && opcode <= 0xC6u)) return MODRM | IMM8;
+
+				return MODRM;
+			case 0x2:
+			// evex maps of AVX512-FP16
+			case 0x5:
+			case 0x6:
+
+				return MODRM;
+			case 0x3:
+			// xop map with an 8 bit immediate
+			case 0x8:
+
+				return MODRM | IMM8;
+			// xop map without an immediate
+			case 0x9:
+
+				return MODRM;
+			// xop map with a 32 bit immediate
+			case 0xA:
+
+				return MODRM | IMMZ;
+			default:
+
+				return SPECIAL;
+			}
+
+		}
+
+	}
+
+}
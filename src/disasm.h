@@ -0,0 +1,100 @@
+#pragma once
+#include <Windows.h>
+
+// Functions to decode the length of x86 and x64 instructions and to move instructions to another address.
+
+namespace hax {
+
+	namespace disasm {
+
+		// x86 instructions are at most 15 bytes long
+		constexpr size_t MAX_INSTRUCTION_SIZE = 15u;
+
+		typedef struct Instruction {
+			// length of the whole instruction including prefixes
+			size_t length;
+			// offset of the first opcode byte behind the prefixes
+			size_t opcodeOffset;
+			// offset of the relative operand, either the immediate of a relative branch or the displacement of a RIP-relative memory operand, zero if there is none
+			size_t relativeOffset;
+			// size of the relative operand in bytes (1, 2 or 4), zero if there is none
+			size_t relativeSize;
+			// true if the relative operand is the displacement of a RIP-relative memory operand
+			bool ripRelative;
+		}Instruction;
+
+		// Decodes the length and the relative operand of an instruction.
+		// The decoder is table driven and covers the general purpose, x87, SSE and AVX (VEX, EVEX and XOP) encodings. It does not check if an instruction is supported by the processor.
+		// 
+		// Parameters:
+		// 
+		// [in] code:
+		// The bytes of the instruction.
+		// 
+		// [in] size:
+		// Amount of bytes available at code. Only the bytes of the instruction are accessed.
+		// 
+		// [in] x64:
+		// True to decode in 64 bit mode, false to decode in 32 bit mode.
+		// 
+		// [out] pInstruction:
+		// Receives the decoded instruction.
+		// 
+		// Return:
+		// The length of the instruction or zero if the bytes are no valid instruction or the instruction exceeds the available bytes.
+		size_t decode(const BYTE* code, size_t size, bool x64, Instruction* pInstruction);
+
+		// Gets the amount of bytes of the whole instructions that cover a minimum amount of bytes, eg. the bytes overwritten by the jump of a hook.
+		// 
+		// Parameters:
+		// 
+		// [in] code:
+		// The bytes of the instructions.
+		// 
+		// [in] size:
+		// Amount of bytes available at code. Only the bytes of the decoded instructions are accessed.
+		// 
+		// [in] x64:
+		// True to decode in 64 bit mode, false to decode in 32 bit mode.
+		// 
+		// [in] minSize:
+		// Minimum amount of bytes that have to be covered.
+		// 
+		// Return:
+		// The size of the instructions or zero if an instruction could not be decoded.
+		size_t getCopySize(const BYTE* code, size_t size, bool x64, size_t minSize);
+
+		// Copies whole instructions to another address and relocates their relative operands, so the copy executes like the original.
+		// Relative branches with an 8 bit offset that leave the copied instructions are widened to 32 bit offsets, so the copy can be larger than the original.
+		// 
+		// Parameters:
+		// 
+		// [in] code:
+		// The bytes of the instructions.
+		// 
+		// [in] size:
+		// Amount of bytes to copy. Has to end at an instruction boundary, eg. as returned by getCopySize.
+		// 
+		// [in] address:
+		// The address the instructions are executed at.
+		// 
+		// [in] x64:
+		// True to decode in 64 bit mode, false to decode in 32 bit mode.
+		// 
+		// [out] dst:
+		// Buffer that receives the relocated instructions. If nullptr only the size of the relocated instructions is calculated.
+		// 
+		// [in] dstSize:
+		// Size of the buffer.
+		// 
+		// [in] dstAddress:
+		// The address the relocated instructions are executed at.
+		// 
+		// Return:
+		// The size of the relocated instructions or zero on failure.
+		// Fails if an instruction could not be decoded, the buffer is too small, a relative target is out of reach from the destination address or a branch targets the copied instructions themselves.
+		size_t relocate(const BYTE* code, size_t size, const void* address, bool x64, BYTE* dst, size_t dstSize, const void* dstAddress);
+
+	}
+
+}
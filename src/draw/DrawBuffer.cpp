@@ -4,7 +4,17 @@ namespace hax {
 
 	namespace draw {
 
-		DrawBuffer::DrawBuffer() : _pBufferBackend{}, _pLocalVertexBuffer{}, _pLocalIndexBuffer{}, _size{}, _capacity{} {}
+		// multiplier for fibonacci hashing of texture IDs, spreads the aligned pointer values IDs usually are
+		static constexpr uint64_t TEXTURE_HASH_MULTIPLIER = 0x9E3779B97F4A7C15ull;
+		static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+		static constexpr size_t INITIAL_SLOT_COUNT = 0x10u;
+		static constexpr uint32_t NO_CLIP = UINT32_MAX;
+
+		static size_t hashBatchKey(TextureId textureId, uint32_t clip, size_t slotCount);
+
+		DrawBuffer::DrawBuffer() :
+			_textures{}, _batchSlots{}, _curBatch{ EMPTY_SLOT }, _commands{}, _ordered{}, _clipRects{}, _curClip{ NO_CLIP },
+			_pBufferBackend{}, _pLocalVertexBuffer{}, _pLocalIndexBuffer{}, _size{}, _indexCount{}, _capacity{} {}
 
 
 		DrawBuffer::~DrawBuffer() {
@@ -17,11 +27,12 @@ namespace hax {
 		}
 
 
-		bool DrawBuffer::beginFrame(IBufferBackend* pBufferBackend) {
+		bool DrawBuffer::beginFrame(IBufferBackend* pBufferBackend, bool ordered) {
 
 			if (!pBufferBackend) return false;
 
 			this->_pBufferBackend = pBufferBackend;
+			this->_ordered = ordered;
 			this->_capacity = pBufferBackend->capacity();
 
 			if (!this->_pBufferBackend->map(&this->_pLocalVertexBuffer, &this->_pLocalIndexBuffer)) {
@@ -35,51 +46,126 @@ namespace hax {
 
 
 		void DrawBuffer::append(const Vertex* data, uint32_t count, TextureId textureId) {
-			
+			this->append(data, count, nullptr, count, textureId);
+
+			return;
+		}
+
+
+		void DrawBuffer::append(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, TextureId textureId) {
+
 			if (!this->_pLocalVertexBuffer) return;
-			
-			const uint32_t newSize = this->_size + count;
 
-			if (newSize > this->_capacity) {
+			if (this->_curClip != NO_CLIP && this->isClipped(vertices, vertexCount)) return;
 
-				if (!this->reserve(newSize * 2u)) return;
+			if (!this->ensureCapacity(vertexCount, indexCount)) return;
 
-			}
+			uint32_t* const pIndices = this->getIndexRun(textureId, indexCount);
 
-			TextureBatch* pTextureBatch = nullptr;
+			if (!pIndices) return;
 
-			bool found = false;
+			memcpy(this->_pLocalVertexBuffer + this->_size, vertices, vertexCount * sizeof(Vertex));
 
-			for (size_t i = 0u; i < this->_textures.size(); i++) {
-				pTextureBatch = this->_textures + i;
+			if (indices) {
+
+				for (uint32_t i = 0u; i < indexCount; i++) {
+					pIndices[i] = this->_size + indices[i];
+				}
 
-				if (pTextureBatch->id == textureId) {
-					found = true;
+			}
+			else {
 
-					break;
+				for (uint32_t i = 0u; i < indexCount; i++) {
+					pIndices[i] = this->_size + i;
 				}
 
 			}
 
-			if (!found) {
-				const TextureBatch batch{ textureId, {} };
-				this->_textures.append(batch);
-				pTextureBatch = this->_textures + this->_textures.size() - 1u;
+			this->_size += vertexCount;
+			this->_indexCount += indexCount;
+
+			return;
+		}
+
+
+		Vertex* DrawBuffer::appendVertices(uint32_t vertexCount, uint32_t indexCount, uint32_t* pBaseVertex) {
+
+			if (!this->_pLocalVertexBuffer) return nullptr;
+
+			if (!this->ensureCapacity(vertexCount, indexCount)) return nullptr;
+
+			*pBaseVertex = this->_size;
+			Vertex* const pVertices = this->_pLocalVertexBuffer + this->_size;
+			this->_size += vertexCount;
+
+			return pVertices;
+		}
+
+
+		void DrawBuffer::appendIndices(const uint16_t* indices, uint32_t indexCount, uint32_t baseVertex, TextureId textureId) {
+			uint32_t* const pIndices = this->reserveIndices(indexCount, textureId);
+
+			if (!pIndices) return;
+
+			for (uint32_t i = 0u; i < indexCount; i++) {
+				pIndices[i] = baseVertex + indices[i];
 			}
 
-			for (uint32_t i = 0u; i < count; i++) {
-				this->_pLocalVertexBuffer[this->_size] = data[i];
-				pTextureBatch->indices.append(this->_size);
-				this->_size++;
+			return;
+		}
+
+
+		void DrawBuffer::appendIndices(const uint32_t* indices, uint32_t indexCount, uint32_t baseVertex, TextureId textureId) {
+			uint32_t* const pIndices = this->reserveIndices(indexCount, textureId);
+
+			if (!pIndices) return;
+
+			for (uint32_t i = 0u; i < indexCount; i++) {
+				pIndices[i] = baseVertex + indices[i];
 			}
 
 			return;
 		}
 
 
+		void DrawBuffer::setClipRect(const ClipRect* pClipRect) {
+
+			if (!pClipRect) {
+				this->_curClip = NO_CLIP;
+
+				return;
+			}
+
+			// setting the same rectangle again keeps the appends in the same batch
+			if (this->_curClip != NO_CLIP && !memcmp(this->_clipRects.addr(this->_curClip), pClipRect, sizeof(ClipRect))) return;
+
+			// rectangles are usually set again when returning to an outer one, eg. after popping a clip rectangle
+			for (size_t i = this->_clipRects.size(); i > 0u; i--) {
+
+				if (!memcmp(this->_clipRects.addr(i - 1u), pClipRect, sizeof(ClipRect))) {
+					this->_curClip = static_cast<uint32_t>(i - 1u);
+
+					return;
+				}
+
+			}
+
+			this->_clipRects.append(*pClipRect);
+			this->_curClip = static_cast<uint32_t>(this->_clipRects.size() - 1u);
+
+			return;
+		}
+
+
 		void DrawBuffer::endFrame() {
 			
 			if (!this->_pBufferBackend || !this->_pLocalIndexBuffer) return;
+
+			if (this->_ordered) {
+				this->drawCommands();
+
+				return;
+			}
 			
 			uint32_t offset = 0u;
 
@@ -103,7 +189,11 @@ namespace hax {
 
 			for (size_t i = 0u; i < this->_textures.size(); i++) {
 				const uint32_t count = static_cast<uint32_t>(this->_textures[i].indices.size());
-				this->_pBufferBackend->draw(this->_textures[i].id, index, count);
+
+				// batches are kept over frames, so textures not drawn this frame have no indices
+				if (!count) continue;
+
+				this->_pBufferBackend->draw(this->_textures[i].id, index, count, this->getClipRect(this->_textures[i].clip));
 				this->_textures[i].indices.resize(0u);
 				index += count;
 			}
@@ -119,7 +209,16 @@ namespace hax {
 			this->_pLocalVertexBuffer = nullptr;
 			this->_pLocalIndexBuffer = nullptr;
 			this->_size = 0u;
+			this->_indexCount = 0u;
 			this->_capacity = 0u;
+			this->_commands.resize(0u);
+			this->_clipRects.resize(0u);
+			this->_curClip = NO_CLIP;
+
+			for (size_t i = 0u; i < this->_textures.size(); i++) {
+				this->_textures[i].indices.resize(0u);
+			}
+
 		}
 
 
@@ -141,7 +240,8 @@ namespace hax {
 				memcpy(pTmpVertexBuffer, this->_pLocalVertexBuffer, this->_size * sizeof(Vertex));
 			}
 
-			int32_t* const pTmpIndexBuffer = reinterpret_cast<int32_t*>(malloc(this->_size * sizeof(int32_t)));
+			// in ordered mode the indices are written to the mapped buffer directly
+			uint32_t* const pTmpIndexBuffer = reinterpret_cast<uint32_t*>(malloc(this->_indexCount * sizeof(uint32_t)));
 
 			if (!pTmpIndexBuffer) {
 				free(pTmpVertexBuffer);
@@ -151,15 +251,17 @@ namespace hax {
 			}
 
 			if (this->_pLocalIndexBuffer) {
-				memcpy(pTmpIndexBuffer, this->_pLocalIndexBuffer, this->_size * sizeof(uint32_t));
+				memcpy(pTmpIndexBuffer, this->_pLocalIndexBuffer, this->_indexCount * sizeof(uint32_t));
 			}
 
 			const uint32_t oldSize = this->_size;
+			const uint32_t oldIndexCount = this->_indexCount;
 
 			this->_pBufferBackend->destroy();
 			this->_pLocalIndexBuffer = nullptr;
 			this->_pLocalVertexBuffer = nullptr;
 			this->_size = 0u;
+			this->_indexCount = 0u;
 			this->_capacity = 0u;
 
 			if (!this->_pBufferBackend->create(capacity)) {
@@ -182,17 +284,211 @@ namespace hax {
 
 			if (this->_pLocalVertexBuffer && this->_pLocalIndexBuffer) {
 				memcpy(this->_pLocalVertexBuffer, pTmpVertexBuffer, oldSize * sizeof(Vertex));
-				memcpy(this->_pLocalIndexBuffer, pTmpIndexBuffer, oldSize * sizeof(uint32_t));
+				memcpy(this->_pLocalIndexBuffer, pTmpIndexBuffer, oldIndexCount * sizeof(uint32_t));
 				this->_size = oldSize;
+				this->_indexCount = oldIndexCount;
 			}
 
-			
-
 			free(pTmpVertexBuffer);
 			free(pTmpIndexBuffer);
 
 			return true;
 		}
 
+
+		bool DrawBuffer::ensureCapacity(uint32_t vertexCount, uint32_t indexCount) {
+			const uint32_t newSize = this->_size + vertexCount;
+			const uint32_t newIndexCount = this->_indexCount + indexCount;
+			// the index buffer holds as many indices as the vertex buffer holds vertices
+			const uint32_t required = newSize > newIndexCount ? newSize : newIndexCount;
+
+			if (required <= this->_capacity) return true;
+
+			return this->reserve(required * 2u);
+		}
+
+
+		uint32_t* DrawBuffer::getIndexRun(TextureId textureId, uint32_t indexCount) {
+
+			if (this->_ordered) return this->appendCommand(textureId, indexCount);
+
+			TextureBatch* const pTextureBatch = this->getBatch(textureId, this->_curClip);
+
+			if (!pTextureBatch) return nullptr;
+
+			// the index run is reserved once and filled in place
+			const size_t batchIndexCount = pTextureBatch->indices.size();
+			pTextureBatch->indices.resize(batchIndexCount + indexCount);
+
+			return pTextureBatch->indices.data() + batchIndexCount;
+		}
+
+
+		uint32_t* DrawBuffer::reserveIndices(uint32_t indexCount, TextureId textureId) {
+
+			if (!this->_pLocalVertexBuffer) return nullptr;
+
+			// the vertices are already in the buffer, so only an empty clip rectangle drops the indices
+			if (this->_curClip != NO_CLIP && this->isClipped(nullptr, 0u)) return nullptr;
+
+			if (!this->ensureCapacity(0u, indexCount)) return nullptr;
+
+			uint32_t* const pIndices = this->getIndexRun(textureId, indexCount);
+
+			if (!pIndices) return nullptr;
+
+			this->_indexCount += indexCount;
+
+			return pIndices;
+		}
+
+
+		uint32_t* DrawBuffer::appendCommand(TextureId textureId, uint32_t indexCount) {
+			const size_t commandCount = this->_commands.size();
+
+			// adjacent draws with the same texture and clip rectangle are merged, others start a new command to keep the order
+			if (commandCount && this->_commands[commandCount - 1u].textureId == textureId && this->_commands[commandCount - 1u].clip == this->_curClip) {
+				this->_commands[commandCount - 1u].count += indexCount;
+			}
+			else {
+				this->_commands.append(DrawCommand{ textureId, this->_curClip, this->_indexCount, indexCount });
+			}
+
+			return this->_pLocalIndexBuffer + this->_indexCount;
+		}
+
+
+		void DrawBuffer::drawCommands() {
+			this->_pBufferBackend->unmap();
+			this->_pLocalIndexBuffer = nullptr;
+			this->_pLocalVertexBuffer = nullptr;
+
+			if (!this->_pBufferBackend->prepare()) {
+				this->reset();
+
+				return;
+			}
+
+			for (size_t i = 0u; i < this->_commands.size(); i++) {
+				const DrawCommand* const pCommand = this->_commands.addr(i);
+
+				if (!pCommand->count) continue;
+
+				this->_pBufferBackend->draw(pCommand->textureId, pCommand->index, pCommand->count, this->getClipRect(pCommand->clip));
+			}
+
+			this->reset();
+
+			return;
+		}
+
+
+		bool DrawBuffer::isClipped(const Vertex* vertices, uint32_t count) const {
+			const ClipRect* const pClipRect = this->_clipRects.addr(this->_curClip);
+
+			// an empty rectangle clips everything, eg. the intersection of two disjoint rectangles
+			if (pClipRect->right <= pClipRect->left || pClipRect->bottom <= pClipRect->top) return true;
+
+			if (!count) return false;
+
+			Vector2 min = vertices[0].coordinates();
+			Vector2 max = min;
+
+			for (uint32_t i = 1u; i < count; i++) {
+				const Vector2 coordinates = vertices[i].coordinates();
+				min.x = coordinates.x < min.x ? coordinates.x : min.x;
+				min.y = coordinates.y < min.y ? coordinates.y : min.y;
+				max.x = coordinates.x > max.x ? coordinates.x : max.x;
+				max.y = coordinates.y > max.y ? coordinates.y : max.y;
+			}
+
+			return max.x <= pClipRect->left || min.x >= pClipRect->right || max.y <= pClipRect->top || min.y >= pClipRect->bottom;
+		}
+
+
+		const ClipRect* DrawBuffer::getClipRect(uint32_t clip) const {
+
+			if (clip == NO_CLIP) return nullptr;
+
+			return this->_clipRects.addr(clip);
+		}
+
+
+		DrawBuffer::TextureBatch* DrawBuffer::getBatch(TextureId textureId, uint32_t clip) {
+
+			if (this->_curBatch < this->_textures.size() && this->_textures[this->_curBatch].id == textureId && this->_textures[this->_curBatch].clip == clip) return this->_textures + this->_curBatch;
+
+			const size_t slotCount = this->_batchSlots.size();
+
+			if (slotCount) {
+
+				for (size_t i = hashBatchKey(textureId, clip, slotCount); this->_batchSlots[i].batch != EMPTY_SLOT; i = (i + 1u) & (slotCount - 1u)) {
+
+					if (this->_batchSlots[i].id == textureId && this->_batchSlots[i].clip == clip) {
+						this->_curBatch = this->_batchSlots[i].batch;
+
+						return this->_textures + this->_curBatch;
+					}
+
+				}
+
+			}
+
+			const uint32_t batch = static_cast<uint32_t>(this->_textures.size());
+
+			if (!this->insertBatchSlot(textureId, clip, batch)) return nullptr;
+
+			this->_textures.append(TextureBatch{ textureId, clip, {} });
+			this->_curBatch = batch;
+
+			return this->_textures + batch;
+		}
+
+
+		bool DrawBuffer::insertBatchSlot(TextureId textureId, uint32_t clip, uint32_t batch) {
+
+			if (2u * (this->_textures.size() + 1u) > this->_batchSlots.size()) {
+				const size_t slotCount = this->_batchSlots.size() ? 2u * this->_batchSlots.size() : INITIAL_SLOT_COUNT;
+				Vector<BatchSlot> batchSlots(slotCount);
+
+				if (batchSlots.capacity() < slotCount) return false;
+
+				for (size_t i = 0u; i < slotCount; i++) {
+					batchSlots.append(BatchSlot{ 0u, NO_CLIP, EMPTY_SLOT });
+				}
+
+				// rehash the batches into the bigger table
+				for (uint32_t i = 0u; i < this->_textures.size(); i++) {
+					size_t slot = hashBatchKey(this->_textures[i].id, this->_textures[i].clip, slotCount);
+
+					while (batchSlots[slot].batch != EMPTY_SLOT) {
+						slot = (slot + 1u) & (slotCount - 1u);
+					}
+
+					batchSlots[slot] = BatchSlot{ this->_textures[i].id, this->_textures[i].clip, i };
+				}
+
+				this->_batchSlots = static_cast<Vector<BatchSlot>&&>(batchSlots);
+			}
+
+			const size_t slotCount = this->_batchSlots.size();
+			size_t slot = hashBatchKey(textureId, clip, slotCount);
+
+			while (this->_batchSlots[slot].batch != EMPTY_SLOT) {
+				slot = (slot + 1u) & (slotCount - 1u);
+			}
+
+			this->_batchSlots[slot] = BatchSlot{ textureId, clip, batch };
+
+			return true;
+		}
+
+
+		static size_t hashBatchKey(TextureId textureId, uint32_t clip, size_t slotCount) {
+
+			// the upper bits of the product are the best mixed, slot counts are powers of two
+			return static_cast<size_t>(((textureId ^ clip) * TEXTURE_HASH_MULTIPLIER) >> 32u) & (slotCount - 1u);
+		}
+
 	}
 }
\ No newline at end of file
@@ -5,6 +5,10 @@
 #include "..\Vector.h"
 
 // Class for draw buffers that draw with textures. It keeps track of the indices per texture and rearranges them for one draw call per texture.
+// The batch of a texture is looked up in an open addressed table, consecutive appends with the same texture skip the lookup.
+// In ordered mode the indices are kept in the order they were appended instead and only adjacent appends with the same texture are merged into one draw call.
+// Vertices in a different format can be converted into the mapped vertex buffer directly with appendVertices and share it between several appendIndices calls.
+// Appends can be clipped to a rectangle. Batches and draw calls are split per clip rectangle and appends that lie completely outside of it are dropped before they reach the buffer.
 // All methods are intended to be called by an Engine object and not for direct calls.
 
 namespace hax {
@@ -15,16 +19,46 @@ namespace hax {
 		private:
 			typedef struct TextureBatch {
 				TextureId id;
+				// index into _clipRects, UINT32_MAX if the batch is not clipped
+				uint32_t clip;
 				Vector<uint32_t> indices;
 			}TextureBatch;
 
+			// slot of the open addressed table that maps texture IDs and clip rectangles to batches
+			typedef struct BatchSlot {
+				TextureId id;
+				uint32_t clip;
+				// index into _textures, UINT32_MAX if the slot is empty
+				uint32_t batch;
+			}BatchSlot;
+
 			Vector<TextureBatch> _textures;
+			Vector<BatchSlot> _batchSlots;
+			// batch of the last append call, consecutive appends usually draw with the same texture
+			uint32_t _curBatch;
+
+			// draw call of ordered mode covering a range of the index buffer
+			typedef struct DrawCommand {
+				TextureId textureId;
+				uint32_t clip;
+				uint32_t index;
+				uint32_t count;
+			}DrawCommand;
+
+			Vector<DrawCommand> _commands;
+			bool _ordered;
+
+			// clip rectangles of the current frame, batches and commands refer to them by index
+			Vector<ClipRect> _clipRects;
+			// clip rectangle of the following appends, UINT32_MAX if they are not clipped
+			uint32_t _curClip;
 
 			IBufferBackend* _pBufferBackend;
 			Vertex* _pLocalVertexBuffer;
 			uint32_t* _pLocalIndexBuffer;
 
 			uint32_t _size;
+			uint32_t _indexCount;
 			uint32_t _capacity;
 
 		public:
@@ -47,9 +81,12 @@ namespace hax {
 			// [in] pBufferBackend:
 			// Backend for the buffer retrieved from the engine backend.
 			//
+			// [in] ordered:
+			// True to draw in the order of the append calls, false to draw all vertices of a texture with a single draw call.
+			//
 			// Return:
 			// True on success, false on failure.
-			bool beginFrame(IBufferBackend* pBufferBackend);
+			bool beginFrame(IBufferBackend* pBufferBackend, bool ordered = false);
 
 			// Appends vertices to the buffer.
 			//
@@ -68,12 +105,111 @@ namespace hax {
 			// The ID of the texture to draw returned by an IBAckend::loadTexture call
 			void append(const Vertex* data, uint32_t count, TextureId textureId);
 
+			// Appends indexed vertices to the buffer. Vertices shared by several triangles, eg. the corners of a quad, only have to be appended once.
+			//
+			// Parameters:
+			// 
+			// [in] vertices:
+			// Pointer to an array of vertices to be appended to the buffer.
+			//
+			// [in] vertexCount:
+			// Amount of vertices in the vertices array.
+			//
+			// [in] indices:
+			// Pointer to an array of indices into the vertices array. Every three indices form a triangle.
+			// They are offset by the position of the vertices within the buffer. Nullptr to draw the vertices in order.
+			//
+			// [in] indexCount:
+			// Amount of indices in the indices array.
+			//
+			// [in] textureId:
+			// The ID of the texture to draw returned by an IBAckend::loadTexture call
+			void append(const Vertex* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, TextureId textureId);
+
+			// Appends room for vertices that are written to the mapped vertex buffer directly, eg. while converting them from another vertex format.
+			// The vertices are drawn by following appendIndices calls. Unlike append, the vertices are not checked against the clip rectangle.
+			//
+			// Parameters:
+			// 
+			// [in] vertexCount:
+			// Amount of vertices.
+			//
+			// [in] indexCount:
+			// Total amount of indices of the following appendIndices calls. Room for them is reserved as well, so these calls do not move the buffers.
+			//
+			// [out] pBaseVertex:
+			// Receives the position of the first vertex within the buffer.
+			//
+			// Return:
+			// Pointer to the vertices to write. It is only valid until the next append call. Nullptr on failure.
+			Vertex* appendVertices(uint32_t vertexCount, uint32_t indexCount, uint32_t* pBaseVertex);
+
+			// Appends indices to vertices added by appendVertices.
+			//
+			// Parameters:
+			// 
+			// [in] indices:
+			// Pointer to an array of indices. Every three indices form a triangle.
+			//
+			// [in] indexCount:
+			// Amount of indices in the indices array.
+			//
+			// [in] baseVertex:
+			// Value added to every index, eg. the position received from appendVertices.
+			//
+			// [in] textureId:
+			// The ID of the texture to draw returned by an IBAckend::loadTexture call
+			void appendIndices(const uint16_t* indices, uint32_t indexCount, uint32_t baseVertex, TextureId textureId);
+
+			// Appends indices to vertices added by appendVertices.
+			//
+			// Parameters:
+			// 
+			// [in] indices:
+			// Pointer to an array of indices. Every three indices form a triangle.
+			//
+			// [in] indexCount:
+			// Amount of indices in the indices array.
+			//
+			// [in] baseVertex:
+			// Value added to every index, eg. the position received from appendVertices.
+			//
+			// [in] textureId:
+			// The ID of the texture to draw returned by an IBAckend::loadTexture call
+			void appendIndices(const uint32_t* indices, uint32_t indexCount, uint32_t baseVertex, TextureId textureId);
+
+			// Sets the rectangle the following appends are clipped to. The clip rectangle is removed at the end of the frame.
+			//
+			// Parameters:
+			// 
+			// [in] pClipRect:
+			// The clip rectangle in frame coordinates. Nullptr to append without clipping.
+			void setClipRect(const ClipRect* pClipRect);
+
 			// Ends the frame for the buffer and draws the contents. Has to be called after any append calls.
 			void endFrame();
 
 		private:
 			void reset();
 			bool reserve(uint32_t capacity);
+			// makes room for vertices and indices in the mapped buffers
+			bool ensureCapacity(uint32_t vertexCount, uint32_t indexCount);
+			// gets the position to write indices to, either in the batch of the texture and the current clip rectangle or in the mapped index buffer in ordered mode
+			uint32_t* getIndexRun(TextureId textureId, uint32_t indexCount);
+			// makes room for indices to vertices added by appendVertices and gets the position to write them to
+			uint32_t* reserveIndices(uint32_t indexCount, TextureId textureId);
+			// gets the batch of a texture and clip rectangle and adds it if the combination was not drawn before
+			TextureBatch* getBatch(TextureId textureId, uint32_t clip);
+			// adds a batch to the slot table and grows the table if it is more than half full
+			bool insertBatchSlot(TextureId textureId, uint32_t clip, uint32_t batch);
+			// adds indices to the last command or starts a new one and gets the position to write them to in the mapped index buffer
+			uint32_t* appendCommand(TextureId textureId, uint32_t indexCount);
+			// draws the commands of ordered mode
+			void drawCommands();
+			// checks if the bounding box of vertices lies completely outside of the current clip rectangle or if it is empty
+			bool isClipped(const Vertex* vertices, uint32_t count) const;
+			// gets a clip rectangle by index, nullptr for UINT32_MAX
+			const ClipRect* getClipRect(uint32_t clip) const;
 		};
 
 	}
@@ -5,8 +5,11 @@ namespace hax {
 
 	namespace draw {
 
+		// two triangles of a quad whose corners are ordered like top left, top right, bottom left, bottom right
+		static constexpr uint32_t QUAD_INDICES[]{ 0u, 1u, 2u, 3u, 2u, 1u };
+
 		Engine::Engine(IBackend* pBackend, Font font) :
-			_pBackend{ pBackend }, _font{ font }, _init{}, _frame{}, frameWidth {}, frameHeight{} {}
+			_pBackend{ pBackend }, _font{ font }, _clipStack{}, _init{}, _frame{}, _ordered{}, frameWidth {}, frameHeight{} {}
 
 
 		TextureId Engine::loadTexture(const Color* data, uint32_t width, uint32_t height) {
@@ -38,7 +41,7 @@ namespace hax {
 
 			this->_pBackend->getFrameResolution(&this->frameWidth, &this->frameHeight);
 
-			if (!this->_drawBuffer.beginFrame(this->_pBackend->getBufferBackend())) {
+			if (!this->_drawBuffer.beginFrame(this->_pBackend->getBufferBackend(), this->_ordered)) {
 				this->_pBackend->endFrame();
 
 				return;
@@ -56,6 +59,7 @@ namespace hax {
 			
 			this->_drawBuffer.endFrame();
 			this->_pBackend->endFrame();
+			this->_clipStack.resize(0u);
 
 			this->_frame = false;
 
@@ -63,6 +67,47 @@ namespace hax {
 		}
 
 
+		void Engine::setOrdered(bool ordered) {
+			this->_ordered = ordered;
+
+			return;
+		}
+
+
+		void Engine::pushClipRect(const Vector2* topLeft, const Vector2* bottomRight) {
+
+			if (!this->_frame) return;
+
+			ClipRect clipRect{ topLeft->x, topLeft->y, bottomRight->x, bottomRight->y };
+			const size_t size = this->_clipStack.size();
+
+			if (size) {
+				const ClipRect* const pTop = this->_clipStack.addr(size - 1u);
+				clipRect.left = clipRect.left > pTop->left ? clipRect.left : pTop->left;
+				clipRect.top = clipRect.top > pTop->top ? clipRect.top : pTop->top;
+				clipRect.right = clipRect.right < pTop->right ? clipRect.right : pTop->right;
+				clipRect.bottom = clipRect.bottom < pTop->bottom ? clipRect.bottom : pTop->bottom;
+			}
+
+			this->_clipStack.append(clipRect);
+			this->_drawBuffer.setClipRect(&clipRect);
+
+			return;
+		}
+
+
+		void Engine::popClipRect() {
+
+			if (!this->_frame || !this->_clipStack.size()) return;
+
+			const size_t size = this->_clipStack.size() - 1u;
+			this->_clipStack.resize(size);
+			this->_drawBuffer.setClipRect(size ? this->_clipStack.addr(size - 1u) : nullptr);
+
+			return;
+		}
+
+
 		void Engine::drawLine(const Vector2* pos1, const Vector2* pos2, float width, Color color) {
 
 			if (!this->_frame) return;
@@ -97,12 +142,10 @@ namespace hax {
 				{ { pos1->x - cosAtan, pos1->y - sinAtan }, color, this->_font.uvWhiteTexel },
 				{ { pos2->x - cosAtan, pos2->y - sinAtan }, color, this->_font.uvWhiteTexel },
 				{ { pos1->x + cosAtan, pos1->y + sinAtan }, color, this->_font.uvWhiteTexel },
-				{ { pos2->x + cosAtan, pos2->y + sinAtan }, color, this->_font.uvWhiteTexel },
-				{ { pos1->x + cosAtan, pos1->y + sinAtan }, color, this->_font.uvWhiteTexel },
-				{ { pos2->x - cosAtan, pos2->y - sinAtan }, color, this->_font.uvWhiteTexel }
+				{ { pos2->x + cosAtan, pos2->y + sinAtan }, color, this->_font.uvWhiteTexel }
 			};
 
-			this->_drawBuffer.append(corners, _countof(corners), this->_font.textureId);
+			this->_drawBuffer.append(corners, _countof(corners), QUAD_INDICES, _countof(QUAD_INDICES), this->_font.textureId);
 		}
 
 
@@ -130,12 +173,10 @@ namespace hax {
 				{ { pos1->x - cosAtan - omega * sinAtan, pos1->y }, color, this->_font.uvWhiteTexel },
 				{ { pos2->x - cosAtan - omega * sinAtan, pos2->y }, color, this->_font.uvWhiteTexel },
 				{ { pos1->x + cosAtan + omega * sinAtan, pos1->y }, color, this->_font.uvWhiteTexel },
-				{ { pos2->x + cosAtan + omega * sinAtan, pos2->y }, color, this->_font.uvWhiteTexel },
-				{ { pos1->x + cosAtan + omega * sinAtan, pos1->y }, color, this->_font.uvWhiteTexel },
-				{ { pos2->x - cosAtan - omega * sinAtan, pos2->y }, color, this->_font.uvWhiteTexel }
+				{ { pos2->x + cosAtan + omega * sinAtan, pos2->y }, color, this->_font.uvWhiteTexel }
 			};
 
-			this->_drawBuffer.append(corners, _countof(corners), this->_font.textureId);
+			this->_drawBuffer.append(corners, _countof(corners), QUAD_INDICES, _countof(QUAD_INDICES), this->_font.textureId);
 		}
 
 
@@ -149,12 +190,10 @@ namespace hax {
 				{ { topLeft.x, topLeft.y }, color, this->_font.uvWhiteTexel },
 				{ { topLeft.x + width, topLeft.y }, color, this->_font.uvWhiteTexel },
 				{ { topLeft.x, topLeft.y + height }, color, this->_font.uvWhiteTexel },
-				{ { topLeft.x + width, topLeft.y + height }, color, this->_font.uvWhiteTexel },
-				{ { topLeft.x, topLeft.y + height }, color, this->_font.uvWhiteTexel },
-				{ { topLeft.x + width, topLeft.y }, color, this->_font.uvWhiteTexel }
+				{ { topLeft.x + width, topLeft.y + height }, color, this->_font.uvWhiteTexel }
 			};
 
-			this->_drawBuffer.append(corners, _countof(corners), this->_font.textureId);
+			this->_drawBuffer.append(corners, _countof(corners), QUAD_INDICES, _countof(QUAD_INDICES), this->_font.textureId);
 		}
 
 
@@ -168,12 +207,10 @@ namespace hax {
 				{ { topLeft.x, topLeft.y }, abgr::WHITE, { 0.f, 0.f } },
 				{ { topLeft.x + width, topLeft.y }, abgr::WHITE, { 1.f, 0.f }  },
 				{ { topLeft.x, topLeft.y + height }, abgr::WHITE, { 0.f, 1.f }  },
-				{ { topLeft.x + width, topLeft.y + height }, abgr::WHITE, { 1.f, 1.f }  },
-				{ { topLeft.x, topLeft.y + height }, abgr::WHITE, { 0.f, 1.f }  },
-				{ { topLeft.x + width, topLeft.y }, abgr::WHITE, { 1.f, 0.f }  }
+				{ { topLeft.x + width, topLeft.y + height }, abgr::WHITE, { 1.f, 1.f }  }
 			};
 
-			this->_drawBuffer.append(corners, _countof(corners), textureId);
+			this->_drawBuffer.append(corners, _countof(corners), QUAD_INDICES, _countof(QUAD_INDICES), textureId);
 
 			return;
 		}
@@ -214,20 +251,10 @@ namespace hax {
 						{ topLeft.x + (i + 1u) * this->_font.charWidth * sizeFactor, topLeft.y + this->_font.height * sizeFactor },
 						color,
 						{ this->_font.charWidth * (curCharIndex + 1u) / static_cast<float>(this->_font.width), 1.f }
-					},
-					{
-						{ topLeft.x + i * this->_font.charWidth * sizeFactor, topLeft.y + this->_font.height * sizeFactor },
-						color,
-						{ this->_font.charWidth * curCharIndex / static_cast<float>(this->_font.width), 1.f }
-					},
-					{
-						{ topLeft.x + (i + 1u) * this->_font.charWidth * sizeFactor, topLeft.y },
-						color,
-						{ this->_font.charWidth * (curCharIndex + 1u) / static_cast<float>(this->_font.width), 0.f }
 					}
 				};
 
-				this->_drawBuffer.append(corners, _countof(corners), this->_font.textureId);
+				this->_drawBuffer.append(corners, _countof(corners), QUAD_INDICES, _countof(QUAD_INDICES), this->_font.textureId);
 			}
 
 			return;
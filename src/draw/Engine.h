@@ -21,9 +21,12 @@ namespace hax {
 			
 			DrawBuffer _drawBuffer;
 			Font _font;
+			// clip rectangles pushed within the current frame, each one already intersected with the ones below
+			Vector<ClipRect> _clipStack;
 
 			bool _init;
 			bool _frame;
+			bool _ordered;
 
 		public:
 			float frameWidth;
@@ -89,6 +92,31 @@ namespace hax {
 			// Ends a frame within a hook. Has to be called after any drawing calls.
 			void endFrame();
 
+			// Sets the order the primitives of a frame are drawn in. Takes effect with the next call to beginFrame.
+			// By default all primitives with the same texture are drawn with a single draw call, so a primitive can end up below one that was drawn before it with a different texture.
+			// In ordered mode the primitives are drawn in the order of the drawing calls and only consecutive primitives with the same texture share a draw call.
+			//
+			// Parameters:
+			//
+			// [in] ordered:
+			// True to draw in the order of the drawing calls, false to group by texture.
+			void setOrdered(bool ordered);
+
+			// Pushes a clip rectangle. The following drawing calls are clipped to the intersection of the rectangle and the rectangles pushed before.
+			// Primitives that lie completely outside of it are not drawn at all. All clip rectangles are popped at the end of the frame.
+			//
+			// Parameters:
+			//
+			// [in] topLeft:
+			// Screen coordinates of the top left corner of the rectangle.
+			// 
+			// [in] bottomRight:
+			// Screen coordinates of the bottom right corner of the rectangle.
+			void pushClipRect(const Vector2* topLeft, const Vector2* bottomRight);
+
+			// Pops the clip rectangle pushed last. The following drawing calls are clipped to the rectangles pushed before or not clipped if none are left.
+			void popClipRect();
+
 			// Draws a line. The line is a filled rectangle with the ends perpendicular to the middle axis.
 			//
 			// Parameters:
@@ -265,6 +293,7 @@ namespace hax {
 			// ImGui has to be set up properly before calling this function.
 			// Always include imgui.h before this file is included if this function should be called (e.g. by including imgui.h before hax.h).
 			// See demo.h for an example how to get a minimal setup working.
+			// The commands are clipped to their clip rectangles and the clip rectangles pushed before. ImGui windows only overlap correctly in ordered mode, see setOrdered.
 			//
 			// Parameters:
 			//
@@ -292,25 +321,31 @@ namespace hax {
 
 				for (int i = 0; i < pDrawData->CmdLists.size(); i++) {
 					const ImDrawList* const pList = pDrawData->CmdLists[i];
+					const uint32_t vertexCount = static_cast<uint32_t>(pList->VtxBuffer.size());
+
+					if (!vertexCount) continue;
+
+					// the vertices of a list are converted once straight into the buffer and shared by all of its commands
+					uint32_t baseVertex = 0u;
+					Vertex* const pVertices = this->_drawBuffer.appendVertices(vertexCount, static_cast<uint32_t>(pList->IdxBuffer.size()), &baseVertex);
+
+					if (!pVertices) return;
+
+					for (uint32_t j = 0u; j < vertexCount; j++) {
+						const ImDrawVert* const pVertex = &pList->VtxBuffer.Data[j];
+						pVertices[j] = Vertex{ Vector2{ pVertex->pos.x, pVertex->pos.y }, Color{ pVertex->col }, Vector2{ pVertex->uv.x, pVertex->uv.y } };
+					}
 
 					for (int j = 0; j < pList->CmdBuffer.size(); j++) {
 						const ImDrawCmd* const pCmd = &pList->CmdBuffer[j];
-						Vector<Vertex> vertices(pCmd->ElemCount);
-
-						for (unsigned int k = 0; k < pCmd->ElemCount; k++) {
-							// forcing a one-to-one correspondence between vertices and indices
-							// this is suboptimal since vertices might be duplicated but works with the draw buffer append function
-							const ImWchar index = pList->IdxBuffer[k + pCmd->IdxOffset];
-							vertices.append(
-								Vertex{
-									Vector2{pList->VtxBuffer[index].pos.x, pList->VtxBuffer[index].pos.y},
-									Color{pList->VtxBuffer[index].col},
-									Vector2{pList->VtxBuffer[index].uv.x, pList->VtxBuffer[index].uv.y}
-								}
-							);
-						}
-
-						this->_drawBuffer.append(vertices.data(), static_cast<uint32_t>(vertices.size()), pCmd->GetTexID());
+
+						if (!pCmd->ElemCount) continue;
+
+						const Vector2 clipTopLeft{ pCmd->ClipRect.x, pCmd->ClipRect.y };
+						const Vector2 clipBottomRight{ pCmd->ClipRect.z, pCmd->ClipRect.w };
+						this->pushClipRect(&clipTopLeft, &clipBottomRight);
+						this->_drawBuffer.appendIndices(pList->IdxBuffer.Data + pCmd->IdxOffset, pCmd->ElemCount, baseVertex + pCmd->VtxOffset, pCmd->GetTexID());
+						this->popClipRect();
 					}
 
 				}
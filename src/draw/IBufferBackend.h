@@ -12,6 +12,14 @@ namespace hax {
 
 		typedef uint64_t TextureId;
 
+		// Rectangle in frame coordinates, the same coordinates the vertices are in.
+		typedef struct ClipRect {
+			float left;
+			float top;
+			float right;
+			float bottom;
+		}ClipRect;
+
 		class IBufferBackend {
 		public:
 			// Creates internal resources.
@@ -19,7 +27,7 @@ namespace hax {
 			// Parameters:
 			// 
 			// [in] capacity:
-			// Capacity of verticies the buffer backend can hold.
+			// Capacity of verticies the buffer backend can hold. The index buffer holds the same amount of indices.
 			//
 			// Return:
 			// True on success, false on failure.
@@ -70,8 +78,11 @@ namespace hax {
 			// Index into the index buffer where the batch begins.
 			// 
 			// [in] count:
-			// Vertex count in the batch.
-			virtual void draw(TextureId textureId, uint32_t index, uint32_t count) const = 0;
+			// Index count in the batch.
+			// 
+			// [in] pClipRect:
+			// Rectangle in frame coordinates the batch is clipped to. Nullptr to draw the batch without clipping.
+			virtual void draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const = 0;
 		};
 
 	}
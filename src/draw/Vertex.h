@@ -18,6 +18,11 @@ namespace hax {
 
 		public:
 			Vertex(Vector2 coordinates, Color color, Vector2 uv = {}) : _coordinates{ coordinates }, _color{ color }, _uv{ uv } {}
+
+			Vector2 coordinates() const {
+
+				return this->_coordinates;
+			}
 		};
 
 	}
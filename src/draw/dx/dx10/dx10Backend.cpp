@@ -41,7 +41,7 @@ namespace hax {
 
 			Backend::Backend() :
 				_pSwapChain{}, _pDevice{}, _pInputLayout{}, _pVertexShader{}, _pPixelShader{},
-				_pConstantBuffer{}, _pSamplerState{}, _pBlendState{}, _viewport{}, _pRenderTargetView{}, _state{} {}
+				_pConstantBuffer{}, _pSamplerState{}, _pBlendState{}, _pRasterizerState{}, _viewport{}, _pRenderTargetView{}, _state{} {}
 
 
 			Backend::~Backend() {
@@ -59,6 +59,10 @@ namespace hax {
 					this->_pSamplerState->Release();
 				}
 
+				if (this->_pRasterizerState) {
+					this->_pRasterizerState->Release();
+				}
+
 				if (this->_pConstantBuffer) {
 					this->_pConstantBuffer->Release();
 				}
@@ -142,6 +146,12 @@ namespace hax {
 
 				}
 
+				if (!this->_pRasterizerState) {
+
+					if (!this->createRasterizerState()) return false;
+
+				}
+
 				return true;
 			}
 
@@ -224,6 +234,7 @@ namespace hax {
 				
 				constexpr float BLEND_FACTOR[] { 0.f, 0.f, 0.f, 0.f };
 				this->_pDevice->OMSetBlendState(this->_pBlendState, BLEND_FACTOR, 0xffffffffu);
+				this->_pDevice->RSSetState(this->_pRasterizerState);
 
 				return true;
 			}
@@ -321,6 +332,18 @@ namespace hax {
 			}
 
 
+			bool Backend::createRasterizerState() {
+				D3D10_RASTERIZER_DESC rasterizerDesc{};
+				rasterizerDesc.FillMode = D3D10_FILL_SOLID;
+				rasterizerDesc.CullMode = D3D10_CULL_NONE;
+				rasterizerDesc.DepthClipEnable = TRUE;
+				// the buffer backend sets a scissor rectangle for every draw call
+				rasterizerDesc.ScissorEnable = TRUE;
+
+				return SUCCEEDED(this->_pDevice->CreateRasterizerState(&rasterizerDesc, &this->_pRasterizerState));
+			}
+
+
 			bool Backend::getViewport(D3D10_VIEWPORT* pViewport) const {
 
 				if (this->_state.viewportCount) {
@@ -383,6 +406,9 @@ namespace hax {
 			void Backend::saveState() {
 				this->_state.viewportCount = _countof(this->_state.viewports);
 				this->_pDevice->RSGetViewports(&this->_state.viewportCount, this->_state.viewports);
+				this->_state.scissorRectCount = _countof(this->_state.scissorRects);
+				this->_pDevice->RSGetScissorRects(&this->_state.scissorRectCount, this->_state.scissorRects);
+				this->_pDevice->RSGetState(&this->_state.pRasterizerState);
 				this->_pDevice->OMGetRenderTargets(1u, &this->_state.pRenderTargetView, &this->_state.pDepthStencilView);
 				this->_pDevice->IAGetInputLayout(&this->_state.pInputLayout);
 				this->_pDevice->VSGetShader(&this->_state.pVertexShader);
@@ -411,6 +437,8 @@ namespace hax {
 				this->_pDevice->VSSetShader(this->_state.pVertexShader);
 				this->_pDevice->IASetInputLayout(this->_state.pInputLayout);
 				this->_pDevice->OMSetRenderTargets(1u, &this->_state.pRenderTargetView, this->_state.pDepthStencilView);
+				this->_pDevice->RSSetState(this->_state.pRasterizerState);
+				this->_pDevice->RSSetScissorRects(this->_state.scissorRectCount, this->_state.scissorRects);
 				this->_pDevice->RSSetViewports(this->_state.viewportCount, this->_state.viewports);
 
 				this->releaseState();
@@ -476,6 +504,11 @@ namespace hax {
 					this->_state.pDepthStencilView = nullptr;
 				}
 
+				if (this->_state.pRasterizerState) {
+					this->_state.pRasterizerState->Release();
+					this->_state.pRasterizerState = nullptr;
+				}
+
 				return;
 			}
 
@@ -34,6 +34,9 @@ namespace hax {
 				typedef struct State {
 					D3D10_VIEWPORT viewports[D3D10_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
 					UINT viewportCount;
+					D3D10_RECT scissorRects[D3D10_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+					UINT scissorRectCount;
+					ID3D10RasterizerState* pRasterizerState;
 					ID3D10RenderTargetView* pRenderTargetView;
 					ID3D10DepthStencilView* pDepthStencilView;
 					ID3D10InputLayout* pInputLayout;
@@ -68,6 +71,7 @@ namespace hax {
 				ID3D10Buffer* _pConstantBuffer;
 				ID3D10SamplerState* _pSamplerState;
 				ID3D10BlendState* _pBlendState;
+				ID3D10RasterizerState* _pRasterizerState;
 				D3D10_VIEWPORT _viewport;
 				ID3D10RenderTargetView* _pRenderTargetView;
 
@@ -156,6 +160,7 @@ namespace hax {
 				bool createConstantBuffer();
 				bool createSamplerState();
 				bool createBlendState();
+				bool createRasterizerState();
 				bool getViewport(D3D10_VIEWPORT* pViewport) const;
 				bool viewportChanged(const D3D10_VIEWPORT* pViewport) const;
 				bool setVertexShaderConstants() const;
@@ -121,12 +121,20 @@ namespace hax {
 			}
 
 
-			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count) const {
+			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const {
 
 				if (textureId) {
 					this->_pDevice->PSSetShaderResources(0u, 1u, reinterpret_cast<ID3D10ShaderResourceView**>(&textureId));
 				}
 
+				// the rasterizer state of the backend has the scissor test enabled, without a clip rectangle the scissor rectangle covers the whole viewport range
+				D3D10_RECT rect{ D3D10_VIEWPORT_BOUNDS_MIN, D3D10_VIEWPORT_BOUNDS_MIN, D3D10_VIEWPORT_BOUNDS_MAX, D3D10_VIEWPORT_BOUNDS_MAX };
+
+				if (pClipRect) {
+					rect = D3D10_RECT{ static_cast<LONG>(pClipRect->left), static_cast<LONG>(pClipRect->top), static_cast<LONG>(pClipRect->right), static_cast<LONG>(pClipRect->bottom) };
+				}
+
+				this->_pDevice->RSSetScissorRects(1u, &rect);
 				this->_pDevice->DrawIndexed(count, index, 0u);
 
 				return;
@@ -41,7 +41,7 @@ namespace hax {
 
 			Backend::Backend() :
 				_pSwapChain{}, _pDevice{}, _pContext{}, _pInputLayout{}, _pVertexShader{}, _pPixelShader{},
-				_pConstantBuffer{}, _pSamplerState{}, _pBlendState{}, _viewport{}, _pRenderTargetView{}, _state{} {}
+				_pConstantBuffer{}, _pSamplerState{}, _pBlendState{}, _pRasterizerState{}, _viewport{}, _pRenderTargetView{}, _state{} {}
 
 
 			Backend::~Backend() {
@@ -59,6 +59,10 @@ namespace hax {
 					this->_pBlendState->Release();
 				}
 				
+				if (this->_pRasterizerState) {
+					this->_pRasterizerState->Release();
+				}
+
 				if (this->_pConstantBuffer) {
 					this->_pConstantBuffer->Release();
 				}
@@ -152,6 +156,12 @@ namespace hax {
 
 				}
 
+				if (!this->_pRasterizerState) {
+
+					if (!this->createRasterizerState()) return false;
+
+				}
+
 				return true;
 			}
 
@@ -234,6 +244,7 @@ namespace hax {
 
 				constexpr float BLEND_FACTOR[]{ 0.f, 0.f, 0.f, 0.f };
 				this->_pContext->OMSetBlendState(this->_pBlendState, BLEND_FACTOR, 0xffffffffu);
+				this->_pContext->RSSetState(this->_pRasterizerState);
 
 				return true;
 			}
@@ -331,6 +342,18 @@ namespace hax {
 			}
 
 
+			bool Backend::createRasterizerState() {
+				D3D11_RASTERIZER_DESC rasterizerDesc{};
+				rasterizerDesc.FillMode = D3D11_FILL_SOLID;
+				rasterizerDesc.CullMode = D3D11_CULL_NONE;
+				rasterizerDesc.DepthClipEnable = TRUE;
+				// the buffer backend sets a scissor rectangle for every draw call
+				rasterizerDesc.ScissorEnable = TRUE;
+
+				return SUCCEEDED(this->_pDevice->CreateRasterizerState(&rasterizerDesc, &this->_pRasterizerState));
+			}
+
+
 			bool Backend::getViewport(D3D11_VIEWPORT* pViewport) const {
 				
 				if (this->_state.viewportCount) {
@@ -392,6 +415,9 @@ namespace hax {
 			void Backend::saveState() {
 				this->_state.viewportCount = _countof(this->_state.viewports);
 				this->_pContext->RSGetViewports(&this->_state.viewportCount, this->_state.viewports);
+				this->_state.scissorRectCount = _countof(this->_state.scissorRects);
+				this->_pContext->RSGetScissorRects(&this->_state.scissorRectCount, this->_state.scissorRects);
+				this->_pContext->RSGetState(&this->_state.pRasterizerState);
 				this->_pContext->OMGetRenderTargets(1u, &this->_state.pRenderTargetView, &this->_state.pDepthStencilView);
 				this->_pContext->IAGetInputLayout(&this->_state.pInputLayout);
 				this->_state.vsInstancesCount = _countof(this->_state.vsInstances);
@@ -422,6 +448,8 @@ namespace hax {
 				this->_pContext->VSSetShader(this->_state.pVertexShader, this->_state.vsInstances, this->_state.vsInstancesCount);
 				this->_pContext->IASetInputLayout(this->_state.pInputLayout);
 				this->_pContext->OMSetRenderTargets(1u, &this->_state.pRenderTargetView, this->_state.pDepthStencilView);
+				this->_pContext->RSSetState(this->_state.pRasterizerState);
+				this->_pContext->RSSetScissorRects(this->_state.scissorRectCount, this->_state.scissorRects);
 				this->_pContext->RSSetViewports(this->_state.viewportCount, this->_state.viewports);
 
 				this->releaseState();
@@ -501,6 +529,11 @@ namespace hax {
 					this->_state.pDepthStencilView = nullptr;
 				}
 
+				if (this->_state.pRasterizerState) {
+					this->_state.pRasterizerState->Release();
+					this->_state.pRasterizerState = nullptr;
+				}
+
 				return;
 			}
 
@@ -34,6 +34,9 @@ namespace hax {
 				typedef struct State {
 					D3D11_VIEWPORT viewports[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
 					UINT viewportCount;
+					D3D11_RECT scissorRects[D3D11_VIEWPORT_AND_SCISSORRECT_OBJECT_COUNT_PER_PIPELINE];
+					UINT scissorRectCount;
+					ID3D11RasterizerState* pRasterizerState;
 					ID3D11RenderTargetView* pRenderTargetView;
 					ID3D11DepthStencilView* pDepthStencilView;
 					ID3D11InputLayout* pInputLayout;
@@ -73,6 +76,7 @@ namespace hax {
 				ID3D11Buffer* _pConstantBuffer;
 				ID3D11SamplerState* _pSamplerState;
 				ID3D11BlendState* _pBlendState;
+				ID3D11RasterizerState* _pRasterizerState;
 				D3D11_VIEWPORT _viewport;
 				ID3D11RenderTargetView* _pRenderTargetView;
 
@@ -161,6 +165,7 @@ namespace hax {
 				bool createConstantBuffer();
 				bool createSamplerState();
 				bool createBlendState();
+				bool createRasterizerState();
 				bool getViewport(D3D11_VIEWPORT* pViewport) const;
 				bool viewportChanged(const D3D11_VIEWPORT* pViewport) const;
 				bool setVertexShaderConstants() const;
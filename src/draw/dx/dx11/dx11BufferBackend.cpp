@@ -129,12 +129,20 @@ namespace hax {
 			}
 
 
-			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count) const {
+			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const {
 
 				if (textureId) {
 					this->_pContext->PSSetShaderResources(0u, 1u, reinterpret_cast<ID3D11ShaderResourceView**>(&textureId));
 				}
 
+				// the rasterizer state of the backend has the scissor test enabled, without a clip rectangle the scissor rectangle covers the whole viewport range
+				D3D11_RECT rect{ D3D11_VIEWPORT_BOUNDS_MIN, D3D11_VIEWPORT_BOUNDS_MIN, D3D11_VIEWPORT_BOUNDS_MAX, D3D11_VIEWPORT_BOUNDS_MAX };
+
+				if (pClipRect) {
+					rect = D3D11_RECT{ static_cast<LONG>(pClipRect->left), static_cast<LONG>(pClipRect->top), static_cast<LONG>(pClipRect->right), static_cast<LONG>(pClipRect->bottom) };
+				}
+
+				this->_pContext->RSSetScissorRects(1u, &rect);
 				this->_pContext->DrawIndexed(count, index, 0u);
 
 				return;
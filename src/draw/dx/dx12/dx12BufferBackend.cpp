@@ -131,13 +131,21 @@ namespace hax {
 			}
 
 
-			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count) const {
+			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const {
 				
 				if (textureId) {
 					const D3D12_GPU_DESCRIPTOR_HANDLE hTextureDesc{ textureId };
 					this->_pCommandList->SetGraphicsRootDescriptorTable(1u, hTextureDesc);
 				}
-				
+
+				// without a clip rectangle the scissor rectangle covers the whole viewport range
+				D3D12_RECT rect{ D3D12_VIEWPORT_BOUNDS_MIN, D3D12_VIEWPORT_BOUNDS_MIN, D3D12_VIEWPORT_BOUNDS_MAX, D3D12_VIEWPORT_BOUNDS_MAX };
+
+				if (pClipRect) {
+					rect = D3D12_RECT{ static_cast<LONG>(pClipRect->left), static_cast<LONG>(pClipRect->top), static_cast<LONG>(pClipRect->right), static_cast<LONG>(pClipRect->bottom) };
+				}
+
+				this->_pCommandList->RSSetScissorRects(1u, &rect);
 				this->_pCommandList->DrawIndexedInstanced(count, 1u, index, 0, 0u);
 
 				return;
@@ -98,7 +98,10 @@ namespace hax {
 				// 
 				// [in] count:
 				// Vertex count in the batch.
-				void draw(TextureId textureId, uint32_t index, uint32_t count) const override;
+				// 
+				// [in] pClipRect:
+				// Rectangle in frame coordinates the batch is clipped to. Nullptr to draw the batch without clipping.
+				void draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const override;
 
 			private:
 				bool createBuffer(ID3D12Resource** ppBufferResource, uint32_t size) const;
@@ -110,14 +110,26 @@ namespace hax {
 			}
 
 
-			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count) const {
+			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const {
 
 				if (textureId) {
 					if (FAILED(this->_pDevice->SetTexture(0u, reinterpret_cast<IDirect3DTexture9*>(static_cast<uintptr_t>(textureId))))) return;
 				}
 
+				if (pClipRect) {
+					const RECT rect{ static_cast<LONG>(pClipRect->left), static_cast<LONG>(pClipRect->top), static_cast<LONG>(pClipRect->right), static_cast<LONG>(pClipRect->bottom) };
+
+					if (FAILED(this->_pDevice->SetScissorRect(&rect))) return;
+
+					this->_pDevice->SetRenderState(D3DRS_SCISSORTESTENABLE, TRUE);
+				}
+				else {
+					this->_pDevice->SetRenderState(D3DRS_SCISSORTESTENABLE, FALSE);
+				}
+
 				const UINT primitiveCount = count / 3u;
-				this->_pDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0u, 0u, count, index, primitiveCount);
+				// indices of a batch can reference any vertex of the buffer
+				this->_pDevice->DrawIndexedPrimitive(D3DPT_TRIANGLELIST, 0u, 0u, this->_capacity, index, primitiveCount);
 
 				return;
 			}
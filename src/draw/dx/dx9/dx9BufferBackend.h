@@ -94,7 +94,10 @@ namespace hax {
 				// 
 				// [in] count:
 				// Vertex count in the batch.
-				virtual void draw(TextureId textureId, uint32_t index, uint32_t count) const override;
+				// 
+				// [in] pClipRect:
+				// Rectangle in frame coordinates the batch is clipped to. Nullptr to draw the batch without clipping.
+				virtual void draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const override;
 			};
 
 		}
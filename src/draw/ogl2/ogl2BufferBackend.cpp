@@ -7,7 +7,7 @@ namespace hax {
 		namespace ogl2 {
 
 			BufferBackend::BufferBackend() :
-				_f{}, _posIndex{}, _colIndex{}, _uvIndex{}, _vertexBufferId{ UINT_MAX }, _indexBufferId{ UINT_MAX }, _capacity{} {}
+				_f{}, _posIndex{}, _colIndex{}, _uvIndex{}, _vertexBufferId{ UINT_MAX }, _indexBufferId{ UINT_MAX }, _viewport{}, _capacity{} {}
 
 
 			BufferBackend::~BufferBackend() {
@@ -145,16 +145,28 @@ namespace hax {
 
 				this->_f.pGlBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->_indexBufferId);
 
+				glGetIntegerv(GL_VIEWPORT, this->_viewport);
+
 				return true;
 			}
 
 
-			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count) const {
+			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const {
 				
 				if (textureId) {
 					glBindTexture(GL_TEXTURE_2D, static_cast<GLuint>(textureId));
 				}
-					
+
+				if (pClipRect) {
+					// window coordinates start at the bottom left corner, frame coordinates at the top left corner of the viewport
+					const GLint bottom = 2 * this->_viewport[1] + this->_viewport[3] - static_cast<GLint>(pClipRect->bottom);
+					glScissor(static_cast<GLint>(pClipRect->left), bottom, static_cast<GLsizei>(pClipRect->right - pClipRect->left), static_cast<GLsizei>(pClipRect->bottom - pClipRect->top));
+					glEnable(GL_SCISSOR_TEST);
+				}
+				else {
+					glDisable(GL_SCISSOR_TEST);
+				}
+
 				glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, reinterpret_cast<GLvoid*>(index * sizeof(uint32_t)));
 
 				return;
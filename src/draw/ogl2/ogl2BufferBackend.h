@@ -16,6 +16,8 @@ namespace hax {
 				GLuint _uvIndex;
 				GLuint _vertexBufferId;
 				GLuint _indexBufferId;
+				// viewport of the frame for converting clip rectangles to window coordinates
+				GLint _viewport[4];
 
 				uint32_t _capacity;
 
@@ -100,7 +102,10 @@ namespace hax {
 				// 
 				// [in] count:
 				// Vertex count in the batch.
-				virtual void draw(TextureId textureId, uint32_t index, uint32_t count) const override;
+				// 
+				// [in] pClipRect:
+				// Rectangle in frame coordinates the batch is clipped to. Nullptr to draw the batch without clipping.
+				virtual void draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const override;
 
 			private:
 				bool createBuffer(GLenum target, GLenum binding, uint32_t size, GLuint* pId) const;
@@ -156,12 +156,25 @@ namespace hax {
 			}
 
 
-			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count) const {
+			void BufferBackend::draw(TextureId textureId, uint32_t index, uint32_t count, const ClipRect* pClipRect) const {
 
 				if (textureId) {
 					this->_f.pVkCmdBindDescriptorSets(this->_hCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, this->_hPipelineLayout, 0u, 1u, reinterpret_cast<VkDescriptorSet*>(&textureId), 0u, nullptr);
 				}
-				
+
+				// without a clip rectangle the scissor rectangle covers everything, the backend already limits drawing to the render area
+				VkRect2D scissor{ { 0, 0 }, { INT32_MAX, INT32_MAX } };
+
+				if (pClipRect) {
+					// offsets of scissor rectangles must not be negative
+					const float left = pClipRect->left > 0.f ? pClipRect->left : 0.f;
+					const float top = pClipRect->top > 0.f ? pClipRect->top : 0.f;
+					scissor.offset = VkOffset2D{ static_cast<int32_t>(left), static_cast<int32_t>(top) };
+					scissor.extent.width = pClipRect->right > left ? static_cast<uint32_t>(pClipRect->right - left) : 0u;
+					scissor.extent.height = pClipRect->bottom > top ? static_cast<uint32_t>(pClipRect->bottom - top) : 0u;
+				}
+
+				this->_f.pVkCmdSetScissor(this->_hCommandBuffer, 0u, 1u, &scissor);
 				this->_f.pVkCmdDrawIndexed(this->_hCommandBuffer, count, 1u, index, 0u, 0u);
 
 				return;
@@ -2,17 +2,39 @@
 
 // Headers for functionallity not related to graphics apis
 #include "Bench.h"
+#include "disasm.h"
+#include "ExportIndex.h"
 #include "FileMapper.h"
 #include "launch.h"
 #include "mem.h"
+#include "ModuleCache.h"
+#include "PeImage.h"
 #include "proc.h"
+#include "SigDatabase.h"
+#include "Signature.h"
 #include "undocWinTypes.h"
 #include "vecmath.h"
 #include "Vector.h"
+#include "XrefIndex.h"
 
 // Headers for hooks
+#include "hooks\AddressSpace.h"
+#include "hooks\GatewayPool.h"
 #include "hooks\TrampHook.h"
 #include "hooks\IatHook.h"
+#include "hooks\PatchPlan.h"
+#include "hooks\HookTransaction.h"
+
+// Headers for memory scanning
+#include "scan\MemorySource.h"
+#include "scan\ModuleScanner.h"
+#include "scan\PageCache.h"
+#include "scan\ParallelSigScanner.h"
+#include "scan\PointerResolver.h"
+#include "scan\ReadBatch.h"
+#include "scan\SigScanner.h"
+#include "scan\Snapshot.h"
+#include "scan\ValueScanner.h"
 
 // Headers for engine
 #include "draw\Color.h"
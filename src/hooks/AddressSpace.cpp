@@ -0,0 +1,165 @@
+#include "AddressSpace.h"
+
+namespace hax {
+
+	static void getSystemLimits(AddressLimits* pLimits);
+	static void getRegion(const MEMORY_BASIC_INFORMATION* pMbi, AddressRegion* pRegion);
+
+	namespace ex {
+
+		AddressSpace::AddressSpace(HANDLE hProc) : _hProc{ hProc } {}
+
+
+		bool AddressSpace::queryRegion(uintptr_t address, AddressRegion* pRegion) {
+			MEMORY_BASIC_INFORMATION mbi{};
+
+			if (!VirtualQueryEx(this->_hProc, reinterpret_cast<void*>(address), &mbi, sizeof(mbi))) return false;
+
+			getRegion(&mbi, pRegion);
+
+			return true;
+		}
+
+
+		void* AddressSpace::allocate(uintptr_t address, size_t size) {
+
+			return VirtualAllocEx(this->_hProc, reinterpret_cast<void*>(address), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+		}
+
+
+		bool AddressSpace::release(void* address) {
+
+			return VirtualFreeEx(this->_hProc, address, 0, MEM_RELEASE);
+		}
+
+
+		bool AddressSpace::protect(uintptr_t address, size_t size, DWORD protection, DWORD* pOldProtection) {
+
+			return VirtualProtectEx(this->_hProc, reinterpret_cast<void*>(address), size, protection, pOldProtection);
+		}
+
+
+		bool AddressSpace::read(uintptr_t address, void* buffer, size_t size) {
+			SIZE_T bytesRead = 0u;
+
+			if (!ReadProcessMemory(this->_hProc, reinterpret_cast<void*>(address), buffer, size, &bytesRead)) return false;
+
+			return bytesRead == size;
+		}
+
+
+		bool AddressSpace::write(uintptr_t address, const void* buffer, size_t size) {
+			SIZE_T bytesWritten = 0u;
+
+			if (!WriteProcessMemory(this->_hProc, reinterpret_cast<void*>(address), buffer, size, &bytesWritten)) return false;
+
+			return bytesWritten == size;
+		}
+
+
+		bool AddressSpace::flushInstructionCache(uintptr_t address, size_t size) {
+
+			return FlushInstructionCache(this->_hProc, reinterpret_cast<void*>(address), size);
+		}
+
+
+		void AddressSpace::getLimits(AddressLimits* pLimits) {
+			getSystemLimits(pLimits);
+
+			return;
+		}
+
+	}
+
+
+	namespace in {
+
+		bool AddressSpace::queryRegion(uintptr_t address, AddressRegion* pRegion) {
+			MEMORY_BASIC_INFORMATION mbi{};
+
+			if (!VirtualQuery(reinterpret_cast<void*>(address), &mbi, sizeof(mbi))) return false;
+
+			getRegion(&mbi, pRegion);
+
+			return true;
+		}
+
+
+		void* AddressSpace::allocate(uintptr_t address, size_t size) {
+
+			return VirtualAlloc(reinterpret_cast<void*>(address), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+		}
+
+
+		bool AddressSpace::release(void* address) {
+
+			return VirtualFree(address, 0, MEM_RELEASE);
+		}
+
+
+		bool AddressSpace::protect(uintptr_t address, size_t size, DWORD protection, DWORD* pOldProtection) {
+
+			return VirtualProtect(reinterpret_cast<void*>(address), size, protection, pOldProtection);
+		}
+
+
+		bool AddressSpace::read(uintptr_t address, void* buffer, size_t size) {
+			memcpy(buffer, reinterpret_cast<void*>(address), size);
+
+			return true;
+		}
+
+
+		bool AddressSpace::write(uintptr_t address, const void* buffer, size_t size) {
+			memcpy(reinterpret_cast<void*>(address), buffer, size);
+
+			return true;
+		}
+
+
+		bool AddressSpace::flushInstructionCache(uintptr_t address, size_t size) {
+
+			return FlushInstructionCache(GetCurrentProcess(), reinterpret_cast<void*>(address), size);
+		}
+
+
+		void AddressSpace::getLimits(AddressLimits* pLimits) {
+			getSystemLimits(pLimits);
+
+			return;
+		}
+
+	}
+
+
+	static void getSystemLimits(AddressLimits* pLimits) {
+		SYSTEM_INFO sysInfo{};
+		GetSystemInfo(&sysInfo);
+
+		pLimits->min = reinterpret_cast<uintptr_t>(sysInfo.lpMinimumApplicationAddress);
+		pLimits->max = reinterpret_cast<uintptr_t>(sysInfo.lpMaximumApplicationAddress);
+		pLimits->granularity = sysInfo.dwAllocationGranularity;
+		pLimits->pageSize = sysInfo.dwPageSize;
+
+		return;
+	}
+
+
+	static void getRegion(const MEMORY_BASIC_INFORMATION* pMbi, AddressRegion* pRegion) {
+		const uintptr_t end = reinterpret_cast<uintptr_t>(pMbi->BaseAddress) + pMbi->RegionSize;
+		pRegion->free = pMbi->State == MEM_FREE;
+
+		// the base address is only the page of the queried address, allocations report where they start
+		if (!pRegion->free && pMbi->AllocationBase) {
+			pRegion->base = reinterpret_cast<uintptr_t>(pMbi->AllocationBase);
+		}
+		else {
+			pRegion->base = reinterpret_cast<uintptr_t>(pMbi->BaseAddress);
+		}
+
+		pRegion->size = end - pRegion->base;
+
+		return;
+	}
+
+}
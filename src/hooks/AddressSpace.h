@@ -0,0 +1,52 @@
+#pragma once
+#include "IAddressSpace.h"
+
+namespace hax {
+
+	namespace ex {
+
+		// Address space of an external process.
+		class AddressSpace : public IAddressSpace {
+		private:
+			const HANDLE _hProc;
+
+		public:
+			// Initializes members.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the process.
+			// Needs at least PROCESS_QUERY_INFORMATION and PROCESS_VM_OPERATION access rights and PROCESS_VM_READ and PROCESS_VM_WRITE for reading and writing.
+			AddressSpace(HANDLE hProc);
+
+			virtual bool queryRegion(uintptr_t address, AddressRegion* pRegion) override;
+			virtual void* allocate(uintptr_t address, size_t size) override;
+			virtual bool release(void* address) override;
+			virtual bool protect(uintptr_t address, size_t size, DWORD protection, DWORD* pOldProtection) override;
+			virtual bool read(uintptr_t address, void* buffer, size_t size) override;
+			virtual bool write(uintptr_t address, const void* buffer, size_t size) override;
+			virtual bool flushInstructionCache(uintptr_t address, size_t size) override;
+			virtual void getLimits(AddressLimits* pLimits) override;
+		};
+
+	}
+
+	namespace in {
+
+		// Address space of the caller process.
+		class AddressSpace : public IAddressSpace {
+		public:
+			virtual bool queryRegion(uintptr_t address, AddressRegion* pRegion) override;
+			virtual void* allocate(uintptr_t address, size_t size) override;
+			virtual bool release(void* address) override;
+			virtual bool protect(uintptr_t address, size_t size, DWORD protection, DWORD* pOldProtection) override;
+			virtual bool read(uintptr_t address, void* buffer, size_t size) override;
+			virtual bool write(uintptr_t address, const void* buffer, size_t size) override;
+			virtual bool flushInstructionCache(uintptr_t address, size_t size) override;
+			virtual void getLimits(AddressLimits* pLimits) override;
+		};
+
+	}
+
+}
@@ -0,0 +1,302 @@
+#include "GatewayPool.h"
+#include <stdint.h>
+
+namespace hax {
+
+	// blocks are aligned like functions
+	static constexpr size_t BLOCK_ALIGNMENT = 0x10u;
+	// distance that is reachable by a relative jump with a margin for the lengths of the instructions in a block
+	static constexpr uintptr_t NEAR_RANGE = 0x7FFF0000u;
+
+	// checks if a range is reachable from an address by a relative jump
+	static bool isReachable(const void* origin, uintptr_t address, size_t size);
+	// walks the regions upwards from an address and gets the lowest aligned free address that fits the size
+	static uintptr_t findFreeAbove(IAddressSpace* pSpace, uintptr_t address, uintptr_t high, size_t size, size_t granularity);
+	// walks the regions downwards from an address and gets the highest aligned free address that fits the size
+	static uintptr_t findFreeBelow(IAddressSpace* pSpace, uintptr_t address, uintptr_t low, size_t size, size_t granularity);
+
+	GatewayPool::GatewayPool(IAddressSpace* pSpace, size_t arenaSize) : _pSpace(pSpace), _arenaSize(arenaSize), _granularity{}, _arenas{}, _freeBlocks{}, _usedBlocks{} {
+		AddressLimits limits{};
+		this->_pSpace->getLimits(&limits);
+		this->_granularity = limits.granularity ? limits.granularity : BLOCK_ALIGNMENT;
+
+		if (!this->_arenaSize) {
+			this->_arenaSize = this->_granularity;
+		}
+
+		return;
+	}
+
+
+	GatewayPool::~GatewayPool() {
+
+		for (size_t i = 0u; i < this->_arenas.size(); i++) {
+			this->_pSpace->release(reinterpret_cast<void*>(this->_arenas[i].base));
+		}
+
+	}
+
+
+	void* GatewayPool::allocate(const void* origin, size_t size) {
+
+		if (!size) return nullptr;
+
+		const size_t blockSize = (size + BLOCK_ALIGNMENT - 1u) & ~(BLOCK_ALIGNMENT - 1u);
+		uintptr_t address = 0u;
+
+		// first fit from the free list
+		for (size_t i = 0u; i < this->_freeBlocks.size(); i++) {
+			Block* const pBlock = this->_freeBlocks.addr(i);
+
+			if (pBlock->size < blockSize || !isReachable(origin, pBlock->address, blockSize)) continue;
+
+			address = pBlock->address;
+			pBlock->address += blockSize;
+			pBlock->size -= blockSize;
+
+			if (!pBlock->size) {
+				this->_freeBlocks[i] = this->_freeBlocks[this->_freeBlocks.size() - 1u];
+				this->_freeBlocks.resize(this->_freeBlocks.size() - 1u);
+			}
+
+			break;
+		}
+
+		// memory of an arena that has never been handed out
+		if (!address) {
+
+			for (size_t i = 0u; i < this->_arenas.size(); i++) {
+				Arena* const pArena = this->_arenas.addr(i);
+
+				if (pArena->size - pArena->used < blockSize || !isReachable(origin, pArena->base + pArena->used, blockSize)) continue;
+
+				address = pArena->base + pArena->used;
+				pArena->used += blockSize;
+
+				break;
+			}
+
+		}
+
+		// reserve a new arena
+		if (!address) {
+			const size_t minArenaSize = (blockSize + this->_granularity - 1u) / this->_granularity * this->_granularity;
+			const size_t arenaSize = this->_arenaSize > minArenaSize ? this->_arenaSize : minArenaSize;
+			void* const base = origin ? allocateNear(this->_pSpace, origin, arenaSize) : this->_pSpace->allocate(0u, arenaSize);
+
+			if (!base) return nullptr;
+
+			address = reinterpret_cast<uintptr_t>(base);
+			this->_arenas.append(Arena{ address, arenaSize, blockSize });
+		}
+
+		this->_usedBlocks.append(Block{ address, blockSize });
+
+		return reinterpret_cast<void*>(address);
+	}
+
+
+	bool GatewayPool::free(void* block) {
+		const uintptr_t address = reinterpret_cast<uintptr_t>(block);
+		size_t index = SIZE_MAX;
+
+		for (size_t i = 0u; i < this->_usedBlocks.size(); i++) {
+
+			if (this->_usedBlocks[i].address == address) {
+				index = i;
+
+				break;
+			}
+
+		}
+
+		const size_t arenaIndex = this->findArena(address);
+
+		if (index == SIZE_MAX || arenaIndex == SIZE_MAX) return false;
+
+		Block freed = this->_usedBlocks[index];
+		this->_usedBlocks[index] = this->_usedBlocks[this->_usedBlocks.size() - 1u];
+		this->_usedBlocks.resize(this->_usedBlocks.size() - 1u);
+
+		Arena* const pArena = this->_arenas.addr(arenaIndex);
+
+		// merge with adjacent free blocks of the same arena
+		for (size_t i = 0u; i < this->_freeBlocks.size();) {
+			const Block* const pBlock = this->_freeBlocks.addr(i);
+
+			if (pBlock->address < pArena->base || pBlock->address - pArena->base >= pArena->size) {
+				i++;
+
+				continue;
+			}
+
+			if (pBlock->address + pBlock->size == freed.address) {
+				freed.address = pBlock->address;
+				freed.size += pBlock->size;
+			}
+			else if (freed.address + freed.size == pBlock->address) {
+				freed.size += pBlock->size;
+			}
+			else {
+				i++;
+
+				continue;
+			}
+
+			this->_freeBlocks[i] = this->_freeBlocks[this->_freeBlocks.size() - 1u];
+			this->_freeBlocks.resize(this->_freeBlocks.size() - 1u);
+		}
+
+		// memory at the end of the used part of the arena is given back to the arena
+		if (freed.address + freed.size == pArena->base + pArena->used) {
+			pArena->used -= freed.size;
+		}
+		else {
+			this->_freeBlocks.append(freed);
+		}
+
+		return true;
+	}
+
+
+	size_t GatewayPool::arenaCount() const {
+
+		return this->_arenas.size();
+	}
+
+
+	void* GatewayPool::allocateNear(IAddressSpace* pSpace, const void* address, size_t size) {
+
+		if (!size) return nullptr;
+
+		AddressLimits limits{};
+		pSpace->getLimits(&limits);
+
+		const size_t granularity = limits.granularity ? limits.granularity : 1u;
+		const uintptr_t start = reinterpret_cast<uintptr_t>(address);
+		// checks int underflow
+		const uintptr_t minAddress = start > NEAR_RANGE ? start - NEAR_RANGE : 0u;
+		// checks int overflow
+		const uintptr_t maxAddress = UINTPTR_MAX - start > NEAR_RANGE ? start + NEAR_RANGE : UINTPTR_MAX;
+		uintptr_t low = minAddress > limits.min ? minAddress : limits.min;
+		const uintptr_t high = maxAddress < limits.max ? maxAddress : limits.max;
+
+		const uintptr_t above = findFreeAbove(pSpace, start, high, size, granularity);
+
+		// regions below that are farther away than the free region above do not have to be walked
+		if (above && low < start && start - low > above - start) {
+			low = start - (above - start);
+		}
+
+		const uintptr_t below = findFreeBelow(pSpace, start, low, size, granularity);
+
+		uintptr_t candidates[2]{ above, below };
+
+		// try the nearer free region first
+		if (below && (!above || start - below < above - start)) {
+			candidates[0] = below;
+			candidates[1] = above;
+		}
+
+		for (size_t i = 0u; i < _countof(candidates); i++) {
+
+			if (!candidates[i]) continue;
+
+			void* const base = pSpace->allocate(candidates[i], size);
+
+			if (base) return base;
+
+		}
+
+		return nullptr;
+	}
+
+
+	size_t GatewayPool::findArena(uintptr_t address) const {
+
+		for (size_t i = 0u; i < this->_arenas.size(); i++) {
+
+			if (address >= this->_arenas[i].base && address - this->_arenas[i].base < this->_arenas[i].size) return i;
+
+		}
+
+		return SIZE_MAX;
+	}
+
+
+	static bool isReachable(const void* origin, uintptr_t address, size_t size) {
+
+		if (!origin) return true;
+
+		const uintptr_t start = reinterpret_cast<uintptr_t>(origin);
+		const uintptr_t last = address + size - 1u;
+
+		if (address < start && start - address > NEAR_RANGE) return false;
+
+		if (last > start && last - start > NEAR_RANGE) return false;
+
+		return true;
+	}
+
+
+	static uintptr_t findFreeAbove(IAddressSpace* pSpace, uintptr_t address, uintptr_t high, size_t size, size_t granularity) {
+		AddressRegion region{};
+		uintptr_t current = address;
+
+		while (current < high && pSpace->queryRegion(current, &region)) {
+			const uintptr_t regionEnd = region.base + region.size;
+
+			if (region.free) {
+				const uintptr_t candidate = (region.base + granularity - 1u) / granularity * granularity;
+
+				if (candidate >= region.base && candidate < regionEnd && regionEnd - candidate >= size && candidate - 1u + size <= high) return candidate;
+
+			}
+
+			// the end of the address space or an invalid region
+			if (regionEnd <= current) break;
+
+			current = regionEnd;
+		}
+
+		return 0u;
+	}
+
+
+	static uintptr_t findFreeBelow(IAddressSpace* pSpace, uintptr_t address, uintptr_t low, size_t size, size_t granularity) {
+		AddressRegion region{};
+		uintptr_t current = address;
+
+		while (current >= low && pSpace->queryRegion(current, &region)) {
+
+			if (!region.free) {
+
+				// the beginning of the address space or an invalid region
+				if (!region.base || region.base > current) break;
+
+				// skips the whole allocation
+				current = region.base - 1u;
+
+				continue;
+			}
+
+			// only the end of a free region is known, so the highest aligned address the size fits below the end is queried next
+			const uintptr_t regionEnd = region.base + region.size;
+
+			if (regionEnd < size) break;
+
+			const uintptr_t candidate = (regionEnd - size) / granularity * granularity;
+
+			if (candidate < low) break;
+
+			// the region is known to be free from the queried page up to its end
+			if (candidate >= region.base) return candidate;
+
+			// free regions between the candidate and the end are smaller than the size, so they can be skipped
+			current = candidate;
+		}
+
+		return 0u;
+	}
+
+}
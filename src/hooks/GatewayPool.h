@@ -0,0 +1,115 @@
+#pragma once
+#include "IAddressSpace.h"
+#include "..\Vector.h"
+
+namespace hax {
+
+	// Class to allocate the gateways of trampoline hooks from shared executable memory.
+	// Without a pool every gateway takes a whole allocation of the allocation granularity (64 KB on Windows) for a few dozen bytes of code.
+	// The pool reserves arenas near the hooked code and hands out small blocks of them. An arena is reused for every hook within reach, so typically one arena per module is reserved.
+	// Freed blocks are kept in a free list and merged with adjacent free blocks. The arenas are released on destruction of the pool, so it has to outlive the hooks that use it.
+	// The address space is only accessed through the IAddressSpace interface, so the pool can be used for the caller process, external processes or a simulated address map.
+	// Example:
+	// hax::in::AddressSpace space;
+	// hax::GatewayPool pool(&space);
+	// hax::in::TrampHook hook(origin, detour, 0u, SIZE_MAX, &pool);
+	class GatewayPool {
+	private:
+		typedef struct Block {
+			uintptr_t address;
+			size_t size;
+		}Block;
+
+		typedef struct Arena {
+			uintptr_t base;
+			size_t size;
+			// offset of the memory that has never been handed out
+			size_t used;
+		}Arena;
+
+		IAddressSpace* const _pSpace;
+		size_t _arenaSize;
+		size_t _granularity;
+		Vector<Arena> _arenas;
+		Vector<Block> _freeBlocks;
+		Vector<Block> _usedBlocks;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] pSpace:
+		// The address space the arenas are allocated in. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] arenaSize:
+		// Size of the arenas in bytes. Zero for the allocation granularity of the address space.
+		GatewayPool(IAddressSpace* pSpace, size_t arenaSize = 0u);
+
+		GatewayPool(GatewayPool&&) = delete;
+
+		GatewayPool(const GatewayPool&) = delete;
+
+		GatewayPool& operator=(GatewayPool&&) = delete;
+
+		GatewayPool& operator=(const GatewayPool&) = delete;
+
+		// Releases all arenas.
+		~GatewayPool();
+
+		// Allocates a block of executable memory.
+		// 
+		// Parameters:
+		// 
+		// [in] origin:
+		// Address the whole block has to be reachable from by a relative jump (op code: E9), eg. the hooked function of an x64 process.
+		// Nullptr if the block can be anywhere, eg. for x86 processes.
+		// 
+		// [in] size:
+		// Size of the block in bytes. It is aligned to 16 bytes.
+		// 
+		// Return:
+		// The address of the block within the address space or nullptr on failure.
+		void* allocate(const void* origin, size_t size);
+
+		// Frees a block allocated by the pool. The memory of the block can be handed out again, the arena is kept.
+		// 
+		// Parameters:
+		// 
+		// [in] block:
+		// The address of the block.
+		// 
+		// Return:
+		// True on success, false if the block was not allocated by the pool.
+		bool free(void* block);
+
+		// Gets the amount of reserved arenas.
+		// 
+		// Return:
+		// The amount of arenas.
+		size_t arenaCount() const;
+
+		// Allocates executable memory that is reachable by a relative jump (op code: E9) from an address.
+		// The free regions around the address are walked once outwards in both directions and the allocation is placed in the nearest free region that fits.
+		// 
+		// Parameters:
+		// 
+		// [in] pSpace:
+		// The address space the memory is allocated in.
+		// 
+		// [in] address:
+		// Address the whole allocation has to be reachable from.
+		// 
+		// [in] size:
+		// Size of the allocation in bytes.
+		// 
+		// Return:
+		// The base address of the allocation or nullptr if no free region within reach fits the size.
+		static void* allocateNear(IAddressSpace* pSpace, const void* address, size_t size);
+
+	private:
+		// finds the arena that contains an address, SIZE_MAX if there is none
+		size_t findArena(uintptr_t address) const;
+	};
+
+}
@@ -0,0 +1,217 @@
+#include "HookTransaction.h"
+#include "AddressSpace.h"
+#include "PatchPlan.h"
+#include "..\proc.h"
+
+namespace hax {
+
+	namespace in {
+
+		// how often the threads are suspended until none of them executes within the patched bytes
+		static constexpr size_t MAX_SUSPEND_ATTEMPTS = 5u;
+		// room for threads that are started between getting the thread count and the thread entries
+		static constexpr size_t THREAD_ENTRY_MARGIN = 0x10u;
+
+		// writes the patches of a plan while all other threads of the process are suspended
+		static bool applySuspended(PatchPlan* pPlan);
+		// suspends all threads of the process except the calling one and opens handles to them
+		static bool suspendThreads(Vector<HANDLE>* pThreads);
+		// resumes the threads and closes the handles to them
+		static void resumeThreads(Vector<HANDLE>* pThreads);
+		// checks if a suspended thread executes within the patched bytes
+		static bool isExecutingPatch(HANDLE hThread, const PatchPlan* pPlan);
+
+		HookTransaction::HookTransaction() : _trampHooks{}, _iatHooks{} {}
+
+
+		HookTransaction::~HookTransaction() {}
+
+
+		void HookTransaction::add(TrampHook* pHook) {
+			this->_trampHooks.append(pHook);
+
+			return;
+		}
+
+
+		void HookTransaction::add(IatHook* pHook) {
+			this->_iatHooks.append(pHook);
+
+			return;
+		}
+
+
+		bool HookTransaction::commit() {
+			PatchPlan plan;
+			bool prepared = true;
+			size_t preparedTrampHooks = 0u;
+			size_t preparedIatHooks = 0u;
+
+			for (; preparedTrampHooks < this->_trampHooks.size(); preparedTrampHooks++) {
+
+				if (!this->_trampHooks[preparedTrampHooks]->prepareEnable(&plan)) {
+					prepared = false;
+
+					break;
+				}
+
+			}
+
+			for (; prepared && preparedIatHooks < this->_iatHooks.size(); preparedIatHooks++) {
+
+				if (!this->_iatHooks[preparedIatHooks]->prepareEnable(&plan)) {
+					prepared = false;
+
+					break;
+				}
+
+			}
+
+			const bool patched = prepared && applySuspended(&plan);
+
+			// on failure the hooks are rolled back in reverse order of their preparation
+			for (size_t i = preparedIatHooks; i > 0u; i--) {
+				this->_iatHooks[i - 1u]->completeEnable(patched);
+			}
+
+			for (size_t i = preparedTrampHooks; i > 0u; i--) {
+				this->_trampHooks[i - 1u]->completeEnable(patched);
+			}
+
+			if (patched) {
+				this->clear();
+			}
+
+			return patched;
+		}
+
+
+		void HookTransaction::clear() {
+			this->_trampHooks.resize(0u);
+			this->_iatHooks.resize(0u);
+
+			return;
+		}
+
+
+		static bool applySuspended(PatchPlan* pPlan) {
+			AddressSpace space;
+			AddressLimits limits{};
+			space.getLimits(&limits);
+
+			// grouping sorts the patches for isExecutingPatch and allocates the pages, so apply does not allocate while the threads are suspended
+			if (!pPlan->groupPages(limits.pageSize)) return false;
+
+			Vector<HANDLE> threads;
+
+			for (size_t i = 0u; i < MAX_SUSPEND_ATTEMPTS; i++) {
+
+				if (!suspendThreads(&threads)) return false;
+
+				bool executingPatch = false;
+
+				for (size_t j = 0u; j < threads.size(); j++) {
+
+					if (isExecutingPatch(threads[j], pPlan)) {
+						executingPatch = true;
+
+						break;
+					}
+
+				}
+
+				if (!executingPatch) {
+					const bool applied = pPlan->apply(&space);
+					resumeThreads(&threads);
+
+					return applied;
+				}
+
+				resumeThreads(&threads);
+				// give the thread time to leave the patched bytes
+				Sleep(1ul);
+			}
+
+			return false;
+		}
+
+
+		static bool suspendThreads(Vector<HANDLE>* pThreads) {
+			const DWORD processId = GetCurrentProcessId();
+			proc::ProcessEntry processEntry{};
+
+			if (!proc::getProcessEntry(processId, &processEntry)) return false;
+
+			const size_t size = processEntry.threadCount + THREAD_ENTRY_MARGIN;
+			proc::ThreadEntry* const pThreadEntries = new proc::ThreadEntry[size]{};
+
+			if (!proc::getProcessThreadEntries(processId, pThreadEntries, size)) {
+				delete[] pThreadEntries;
+
+				return false;
+			}
+
+			// no allocations once the first thread is suspended, it might hold the heap lock
+			pThreads->reserve(size);
+			const DWORD currentThreadId = GetCurrentThreadId();
+
+			for (size_t i = 0u; i < size; i++) {
+
+				// unused entries are zero
+				if (!pThreadEntries[i].threadId || pThreadEntries[i].threadId == currentThreadId) continue;
+
+				const HANDLE hThread = OpenThread(THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT, FALSE, pThreadEntries[i].threadId);
+
+				// the thread might have exited in the meantime
+				if (!hThread) continue;
+
+				if (SuspendThread(hThread) == 0xFFFFFFFF) {
+					CloseHandle(hThread);
+
+					continue;
+				}
+
+				pThreads->append(hThread);
+			}
+
+			delete[] pThreadEntries;
+
+			return true;
+		}
+
+
+		static void resumeThreads(Vector<HANDLE>* pThreads) {
+
+			for (size_t i = 0u; i < pThreads->size(); i++) {
+				ResumeThread((*pThreads)[i]);
+				CloseHandle((*pThreads)[i]);
+			}
+
+			pThreads->resize(0u);
+
+			return;
+		}
+
+
+		static bool isExecutingPatch(HANDLE hThread, const PatchPlan* pPlan) {
+			CONTEXT context{};
+			context.ContextFlags = CONTEXT_CONTROL;
+
+			// the position of the thread is unknown, so it is treated as unsafe
+			if (!GetThreadContext(hThread, &context)) return true;
+
+			#ifdef _WIN64
+
+			return pPlan->isInside(static_cast<uintptr_t>(context.Rip));
+
+			#else
+
+			return pPlan->isInside(static_cast<uintptr_t>(context.Eip));
+
+			#endif // _WIN64
+
+		}
+
+	}
+
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "TrampHook.h"
+#include "IatHook.h"
+#include "..\Vector.h"
+
+namespace hax {
+
+	namespace in {
+
+		// Class to install many hooks inside the caller process at once.
+		// Enabling the hooks one by one changes the protection of the patched code twice per hook while the other threads keep running through half installed hooks.
+		// The transaction prepares the gateways of all hooks first, then suspends all other threads of the process, writes all patches with one protection change per touched page,
+		// flushes the instruction cache once and resumes the threads.
+		// If a thread is suspended within the bytes that are overwritten, the threads are resumed and suspended again a few times until it left them.
+		// Either all hooks are enabled or none. If preparing or patching fails, the hooks that were prepared are rolled back in reverse order.
+		// Threads started while the patches are written are not suspended.
+		// Example:
+		// hax::in::TrampHook hook1(origin1, detour1);
+		// hax::in::TrampHook hook2(origin2, detour2);
+		// hax::in::HookTransaction transaction;
+		// transaction.add(&hook1);
+		// transaction.add(&hook2);
+		// transaction.commit();
+		class HookTransaction {
+		private:
+			Vector<TrampHook*> _trampHooks;
+			Vector<IatHook*> _iatHooks;
+
+		public:
+			HookTransaction();
+
+			HookTransaction(HookTransaction&&) = delete;
+
+			HookTransaction(const HookTransaction&) = delete;
+
+			HookTransaction& operator=(HookTransaction&&) = delete;
+
+			HookTransaction& operator=(const HookTransaction&) = delete;
+
+			~HookTransaction();
+
+			// Adds a trampoline hook to the transaction. The hook has to stay valid until the transaction is committed.
+			// 
+			// Parameters:
+			// 
+			// [in] pHook:
+			// The disabled hook.
+			void add(TrampHook* pHook);
+
+			// Adds an import address table hook to the transaction. The hook has to stay valid until the transaction is committed.
+			// 
+			// Parameters:
+			// 
+			// [in] pHook:
+			// The disabled hook.
+			void add(IatHook* pHook);
+
+			// Enables all added hooks. The hooks are removed from the transaction on success.
+			// 
+			// Return:
+			// True if all hooks were enabled, false if none was enabled. Fails if a hook is already enabled, two hooks overlap or a thread could not be suspended outside of the patched bytes.
+			bool commit();
+
+			// Removes all hooks from the transaction without enabling them.
+			void clear();
+		};
+
+	}
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include <Windows.h>
+
+// Interface for virtual address spaces that executable memory can be allocated in and code can be patched in.
+// Implementations exist for the caller process and external processes, so allocation code can also run on a simulated address map.
+
+namespace hax {
+
+	typedef struct AddressRegion {
+		// start of the allocation for reserved or commited memory
+		// for free memory the page of the queried address, because the system does not report where a free region starts
+		uintptr_t base;
+		// size from the base to the end of the region
+		size_t size;
+		// true if the region is neither reserved nor commited
+		bool free;
+	}AddressRegion;
+
+	typedef struct AddressLimits {
+		// lowest address that can be allocated
+		uintptr_t min;
+		// highest address that can be allocated
+		uintptr_t max;
+		// alignment of the base addresses of allocations
+		size_t granularity;
+		// size of the pages protections are changed for
+		size_t pageSize;
+	}AddressLimits;
+
+	class IAddressSpace {
+	public:
+		// Queries the region that contains an address. The end of the region is always exact, so the address space can be walked upwards by querying the end of a region.
+		// Reserved or commited regions start at their allocation base, so it can be walked downwards by querying the address below the base of an allocation.
+		// Free regions start at the page of the queried address, like MEMORY_BASIC_INFORMATION::BaseAddress of VirtualQuery.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address within the region.
+		// 
+		// [out] pRegion:
+		// Receives the base, size and state of the region.
+		// 
+		// Return:
+		// True on success, false if the address is outside of the address space.
+		virtual bool queryRegion(uintptr_t address, AddressRegion* pRegion) = 0;
+
+		// Reserves and commits readable, writable and executable memory.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Base address of the allocation aligned to the allocation granularity. Zero to let the system choose the address.
+		// 
+		// [in] size:
+		// Size of the allocation in bytes.
+		// 
+		// Return:
+		// The base address of the allocation or nullptr on failure.
+		virtual void* allocate(uintptr_t address, size_t size) = 0;
+
+		// Releases memory allocated by allocate.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// The base address of the allocation.
+		// 
+		// Return:
+		// True on success, false on failure.
+		virtual bool release(void* address) = 0;
+
+		// Changes the protection of the pages of a range.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Start of the range.
+		// 
+		// [in] size:
+		// Size of the range in bytes.
+		// 
+		// [in] protection:
+		// The new protection, eg. PAGE_EXECUTE_READWRITE.
+		// 
+		// [out] pOldProtection:
+		// Receives the protection of the first page before the change.
+		// 
+		// Return:
+		// True on success, false on failure.
+		virtual bool protect(uintptr_t address, size_t size, DWORD protection, DWORD* pOldProtection) = 0;
+
+		// Reads memory of an accessible range.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address to read from.
+		// 
+		// [out] buffer:
+		// Buffer that receives the memory.
+		// 
+		// [in] size:
+		// Amount of bytes to read.
+		// 
+		// Return:
+		// True if all bytes were read, false otherwise.
+		virtual bool read(uintptr_t address, void* buffer, size_t size) = 0;
+
+		// Writes memory of a writable range.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address to write to.
+		// 
+		// [in] buffer:
+		// Buffer that contains the bytes.
+		// 
+		// [in] size:
+		// Amount of bytes to write.
+		// 
+		// Return:
+		// True if all bytes were written, false otherwise.
+		virtual bool write(uintptr_t address, const void* buffer, size_t size) = 0;
+
+		// Flushes the instruction cache for a range of patched code.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Start of the range.
+		// 
+		// [in] size:
+		// Size of the range in bytes.
+		// 
+		// Return:
+		// True on success, false on failure.
+		virtual bool flushInstructionCache(uintptr_t address, size_t size) = 0;
+
+		// Gets the range of allocatable addresses, the allocation granularity and the page size.
+		// 
+		// Parameters:
+		// 
+		// [out] pLimits:
+		// Receives the limits.
+		virtual void getLimits(AddressLimits* pLimits) = 0;
+	};
+
+}
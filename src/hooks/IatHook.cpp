@@ -210,6 +210,21 @@ namespace hax {
 		}
 
 
+		bool IatHook::prepareEnable(PatchPlan* pPlan) {
+
+			if (this->_hooked || !this->_pIatEntry || !this->_detour) return false;
+
+			return pPlan->add(this->_pIatEntry, &this->_detour, sizeof(BYTE*));
+		}
+
+
+		void IatHook::completeEnable(bool patched) {
+			this->_hooked = patched;
+
+			return;
+		}
+
+
 		bool IatHook::isHooked() const {
 
 			return this->_hooked;
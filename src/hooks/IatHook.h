@@ -1,5 +1,6 @@
 #pragma once
 #include "IHook.h"
+#include "PatchPlan.h"
 
 namespace hax {
 
@@ -142,6 +143,26 @@ namespace hax {
 			// True on success, false on failure.
 			bool disable();
 
+			// Prepares enabling the hook without overwriting the IAT entry. The new IAT entry is added to a patch plan.
+			// Used by HookTransaction to install many hooks at once. On success completeEnable has to be called after the plan was applied.
+			// 
+			// Parameters:
+			// 
+			// [in] pPlan:
+			// The plan the IAT entry is added to.
+			// 
+			// Return:
+			// True on success, false on failure.
+			bool prepareEnable(PatchPlan* pPlan);
+
+			// Completes enabling the hook after prepareEnable succeeded.
+			// 
+			// Parameters:
+			// 
+			// [in] patched:
+			// True if the patches of the plan were written. Otherwise the hook stays disabled.
+			void completeEnable(bool patched);
+
 			// Checks if the hook is currently installed.
 			// 
 			// Return:
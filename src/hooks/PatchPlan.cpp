@@ -0,0 +1,217 @@
+#include "PatchPlan.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace hax {
+
+	// orders patches by address for qsort
+	static int comparePatches(const void* pPatch1, const void* pPatch2);
+
+	PatchPlan::PatchPlan() : _patches{}, _pages{}, _bytes{}, _originalBytes{}, _pageSize{}, _applied{} {}
+
+
+	PatchPlan::~PatchPlan() {}
+
+
+	bool PatchPlan::add(const void* address, const void* bytes, size_t size) {
+
+		if (!size) return false;
+
+		const size_t offset = this->_bytes.size();
+		this->_bytes.resize(offset + size);
+		// the buffer for the original bytes is allocated here, since apply may run while other threads are suspended
+		this->_originalBytes.resize(offset + size);
+
+		if (this->_bytes.size() != offset + size || this->_originalBytes.size() != offset + size) {
+			this->_bytes.resize(offset);
+			this->_originalBytes.resize(offset);
+
+			return false;
+		}
+
+		this->_applied = false;
+		memcpy(this->_bytes.data() + offset, bytes, size);
+		this->_patches.append(Patch{ reinterpret_cast<uintptr_t>(address), size, offset });
+
+		return true;
+	}
+
+
+	bool PatchPlan::groupPages(size_t pageSize) {
+
+		if (!pageSize) return false;
+
+		this->_pages.resize(0u);
+		this->_pageSize = pageSize;
+
+		qsort(this->_patches.data(), this->_patches.size(), sizeof(Patch), comparePatches);
+
+		for (size_t i = 0u; i < this->_patches.size(); i++) {
+			const Patch* const pPatch = this->_patches.addr(i);
+
+			if (i && this->_patches[i - 1u].address + this->_patches[i - 1u].size > pPatch->address) return false;
+
+			const uintptr_t firstPage = pPatch->address & ~(pageSize - 1u);
+			const uintptr_t lastPage = (pPatch->address + pPatch->size - 1u) & ~(pageSize - 1u);
+
+			for (uintptr_t page = firstPage; page <= lastPage; page += pageSize) {
+
+				// patches are sorted, so a page shared with the previous patch is always the last one collected
+				if (this->_pages.size() && this->_pages[this->_pages.size() - 1u].base >= page) continue;
+
+				this->_pages.append(Page{ page, 0u });
+			}
+
+		}
+
+		return true;
+	}
+
+
+	bool PatchPlan::apply(IAddressSpace* pSpace) {
+
+		if (!this->_patches.size()) return true;
+
+		AddressLimits limits{};
+		pSpace->getLimits(&limits);
+
+		if (!this->groupPages(limits.pageSize)) return false;
+
+		for (size_t i = 0u; i < this->_pages.size(); i++) {
+			Page* const pPage = this->_pages.addr(i);
+
+			if (!pSpace->protect(pPage->base, this->_pageSize, PAGE_EXECUTE_READWRITE, &pPage->oldProtection)) {
+				this->restoreProtection(pSpace, i);
+
+				return false;
+			}
+
+		}
+
+		for (size_t i = 0u; i < this->_patches.size(); i++) {
+			const Patch* const pPatch = this->_patches.addr(i);
+
+			if (!pSpace->read(pPatch->address, this->_originalBytes.data() + pPatch->offset, pPatch->size)) {
+				this->restoreProtection(pSpace, this->_pages.size());
+
+				return false;
+			}
+
+		}
+
+		for (size_t i = 0u; i < this->_patches.size(); i++) {
+			const Patch* const pPatch = this->_patches.addr(i);
+
+			if (!pSpace->write(pPatch->address, this->_bytes.data() + pPatch->offset, pPatch->size)) {
+				// the failed write might have changed some of the bytes
+				this->restoreBytes(pSpace, i + 1u);
+				this->restoreProtection(pSpace, this->_pages.size());
+
+				return false;
+			}
+
+		}
+
+		this->restoreProtection(pSpace, this->_pages.size());
+		this->_applied = true;
+
+		const Patch* const pFirst = this->_patches.addr(0u);
+		const Patch* const pLast = this->_patches.addr(this->_patches.size() - 1u);
+		pSpace->flushInstructionCache(pFirst->address, pLast->address + pLast->size - pFirst->address);
+
+		return true;
+	}
+
+
+	bool PatchPlan::isInside(uintptr_t address) const {
+		size_t low = 0u;
+		size_t high = this->_patches.size();
+
+		while (low < high) {
+			const size_t mid = low + (high - low) / 2u;
+			const Patch* const pPatch = &this->_patches[mid];
+
+			if (address <= pPatch->address) {
+				high = mid;
+			}
+			else if (address >= pPatch->address + pPatch->size) {
+				low = mid + 1u;
+			}
+			else {
+				return true;
+			}
+
+		}
+
+		return false;
+	}
+
+
+	const PatchPlan::Patch* PatchPlan::patches(size_t* pCount) const {
+		*pCount = this->_patches.size();
+
+		return this->_patches.data();
+	}
+
+
+	const PatchPlan::Page* PatchPlan::pages(size_t* pCount) const {
+		*pCount = this->_pages.size();
+
+		return this->_pages.data();
+	}
+
+
+	const BYTE* PatchPlan::originalBytes(const Patch* pPatch) const {
+
+		if (!this->_applied) return nullptr;
+
+		return this->_originalBytes.data() + pPatch->offset;
+	}
+
+
+	void PatchPlan::clear() {
+		this->_patches.resize(0u);
+		this->_pages.resize(0u);
+		this->_bytes.resize(0u);
+		this->_originalBytes.resize(0u);
+		this->_applied = false;
+
+		return;
+	}
+
+
+	void PatchPlan::restoreBytes(IAddressSpace* pSpace, size_t count) {
+
+		for (size_t i = count; i > 0u; i--) {
+			const Patch* const pPatch = this->_patches.addr(i - 1u);
+			pSpace->write(pPatch->address, this->_originalBytes.data() + pPatch->offset, pPatch->size);
+		}
+
+		return;
+	}
+
+
+	void PatchPlan::restoreProtection(IAddressSpace* pSpace, size_t count) {
+
+		for (size_t i = count; i > 0u; i--) {
+			const Page* const pPage = this->_pages.addr(i - 1u);
+			DWORD protection = 0u;
+			pSpace->protect(pPage->base, this->_pageSize, pPage->oldProtection, &protection);
+		}
+
+		return;
+	}
+
+
+	static int comparePatches(const void* pPatch1, const void* pPatch2) {
+		const uintptr_t address1 = static_cast<const PatchPlan::Patch*>(pPatch1)->address;
+		const uintptr_t address2 = static_cast<const PatchPlan::Patch*>(pPatch2)->address;
+
+		if (address1 < address2) return -1;
+
+		if (address1 > address2) return 1;
+
+		return 0;
+	}
+
+}
@@ -0,0 +1,149 @@
+#pragma once
+#include "IAddressSpace.h"
+#include "..\Vector.h"
+
+namespace hax {
+
+	// Class to write many code patches with one protection change per touched page.
+	// The patches are sorted by address and the pages they touch are collected once, so patches sharing a page share the protection change.
+	// Either all patches are written or none. If a protection change or a write fails, the bytes written so far are restored in reverse order, followed by the protections of the pages.
+	// The instruction cache is flushed once for the whole patched range.
+	// The address space is only accessed through the IAddressSpace interface, so the plan can be run on a simulated address space.
+	// Example:
+	// hax::PatchPlan plan;
+	// plan.add(pFirst, firstBytes, sizeof(firstBytes));
+	// plan.add(pSecond, secondBytes, sizeof(secondBytes));
+	// hax::in::AddressSpace space;
+	// plan.apply(&space);
+	class PatchPlan {
+	public:
+		typedef struct Patch {
+			uintptr_t address;
+			size_t size;
+			// offset of the patch bytes within the new and the original bytes of the plan
+			size_t offset;
+		}Patch;
+
+		typedef struct Page {
+			uintptr_t base;
+			// protection of the page before it was made writable
+			DWORD oldProtection;
+		}Page;
+
+	private:
+		Vector<Patch> _patches;
+		Vector<Page> _pages;
+		Vector<BYTE> _bytes;
+		Vector<BYTE> _originalBytes;
+		size_t _pageSize;
+		bool _applied;
+
+	public:
+		PatchPlan();
+
+		PatchPlan(PatchPlan&&) = delete;
+
+		PatchPlan(const PatchPlan&) = delete;
+
+		PatchPlan& operator=(PatchPlan&&) = delete;
+
+		PatchPlan& operator=(const PatchPlan&) = delete;
+
+		~PatchPlan();
+
+		// Adds a patch to the plan. The bytes are copied.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address the bytes are written to within the address space the plan is applied to.
+		// 
+		// [in] bytes:
+		// The bytes that are written.
+		// 
+		// [in] size:
+		// Amount of bytes.
+		// 
+		// Return:
+		// True on success, false if the size is zero or the allocation failed.
+		bool add(const void* address, const void* bytes, size_t size);
+
+		// Sorts the patches by address and collects the pages they touch. Called by apply.
+		// 
+		// Parameters:
+		// 
+		// [in] pageSize:
+		// Size of the pages of the address space.
+		// 
+		// Return:
+		// True on success, false if two patches overlap or the page size is zero.
+		bool groupPages(size_t pageSize);
+
+		// Writes all patches. The original bytes are saved before and can be read by originalBytes afterwards.
+		// No memory is allocated if the pages were grouped before, so it can be called while the other threads of the process are suspended.
+		// 
+		// Parameters:
+		// 
+		// [in] pSpace:
+		// The address space the patches are written to.
+		// 
+		// Return:
+		// True if all patches were written, false if nothing was changed.
+		bool apply(IAddressSpace* pSpace);
+
+		// Checks if an address lies within a patch behind its first byte.
+		// A thread that executes there when the patches are written would continue in the middle of a patched instruction.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// The address, eg. the instruction pointer of a suspended thread.
+		// 
+		// Return:
+		// True if the address is within a patch but not at its start, false otherwise.
+		bool isInside(uintptr_t address) const;
+
+		// Gets the patches of the plan. Sorted by address after the pages were grouped.
+		// 
+		// Parameters:
+		// 
+		// [out] pCount:
+		// Receives the amount of patches.
+		// 
+		// Return:
+		// The patches.
+		const Patch* patches(size_t* pCount) const;
+
+		// Gets the pages touched by the patches sorted by address.
+		// 
+		// Parameters:
+		// 
+		// [out] pCount:
+		// Receives the amount of pages.
+		// 
+		// Return:
+		// The pages.
+		const Page* pages(size_t* pCount) const;
+
+		// Gets the original bytes of a patch saved by apply.
+		// 
+		// Parameters:
+		// 
+		// [in] pPatch:
+		// A patch of the plan.
+		// 
+		// Return:
+		// The original bytes or nullptr if the plan was not applied.
+		const BYTE* originalBytes(const Patch* pPatch) const;
+
+		// Removes all patches.
+		void clear();
+
+	private:
+		// writes the original bytes of a range of patches back in reverse order
+		void restoreBytes(IAddressSpace* pSpace, size_t count);
+		// restores the protection of a range of pages in reverse order
+		void restoreProtection(IAddressSpace* pSpace, size_t count);
+	};
+
+}
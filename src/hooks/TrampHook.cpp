@@ -6,16 +6,9 @@ namespace hax {
 
 	namespace ex {
 
-		TrampHook::TrampHook(HANDLE hProc, BYTE* origin, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size, size_t relativeAddressOffset) :
-			_hProc(hProc), _origin(origin), _size(size), _detour{}, _detourOriginCall{}, _gateway{}, _relativeAddressOffset(relativeAddressOffset), _relativeAddress{}, _hooked{}
+		TrampHook::TrampHook(HANDLE hProc, BYTE* origin, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size, size_t relativeAddressOffset, GatewayPool* pPool) :
+			_hProc(hProc), _origin(origin), _size(size), _detour{}, _detourOriginCall{}, _gateway{}, _relativeAddressOffset(relativeAddressOffset), _stolen{}, _pPool(pPool), _hooked{}
 		{
-			// save the original relative address to patch it back later
-			if (this->_relativeAddressOffset != SIZE_MAX) {
-
-				if (!ReadProcessMemory(hProc, reinterpret_cast<BYTE*>(this->_origin) + this->_relativeAddressOffset, &this->_relativeAddress, sizeof(this->_relativeAddress), nullptr)) return;
-
-			}
-			
 			this->_detour = static_cast<BYTE*>(VirtualAllocEx(hProc, nullptr, sizeof(shell), MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
 
 			if (!this->_detour || !shell) return;
@@ -30,18 +23,9 @@ namespace hax {
 
 
 		TrampHook::TrampHook(
-			HANDLE hProc, const char* modName, const char* funcName, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size, size_t relativeAddressOffset
-		) : _hProc(hProc), _size(size), _origin{}, _detour{}, _detourOriginCall{}, _gateway{}, _relativeAddressOffset(relativeAddressOffset), _relativeAddress{}, _hooked{}
+			HANDLE hProc, const char* modName, const char* funcName, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size, size_t relativeAddressOffset, GatewayPool* pPool
+		) : _hProc(hProc), _size(size), _origin{}, _detour{}, _detourOriginCall{}, _gateway{}, _relativeAddressOffset(relativeAddressOffset), _stolen{}, _pPool(pPool), _hooked{}
 		{
-			const BYTE* const pRelativeAddress = reinterpret_cast<BYTE*>(this->_origin) + this->_relativeAddressOffset;
-
-			// save the original relative address to patch it back later
-			if (this->_relativeAddressOffset != SIZE_MAX && pRelativeAddress) {
-
-				if (!ReadProcessMemory(hProc, pRelativeAddress, &this->_relativeAddress, sizeof(this->_relativeAddress), nullptr)) return;
-
-			}
-			
 			const HMODULE hMod = proc::ex::getModuleHandle(hProc, modName);
 
 			if (!hMod) return;
@@ -67,7 +51,11 @@ namespace hax {
 			if (this->_detour) {
 				VirtualFreeEx(this->_hProc, this->_detour, 0, MEM_RELEASE);
 			}
-			
+
+			if (this->_stolen) {
+				delete[] this->_stolen;
+			}
+
 		}
 
 
@@ -76,9 +64,23 @@ namespace hax {
 			if (this->_hooked || !this->_origin || !this->_detour || !this->_detourOriginCall) return false;
 
 			const size_t originCallOffset = reinterpret_cast<BYTE*>(this->_detourOriginCall) - reinterpret_cast<BYTE*>(this->_detour);
+
+			if (!this->_size) {
+				this->_size = mem::ex::getStolenSize(this->_hProc, this->_origin);
+
+				if (!this->_size) return false;
+
+			}
+
+			// save the stolen bytes to patch them back later, since the gateway contains the relocated instructions
+			if (!this->_stolen) {
+				this->_stolen = new BYTE[this->_size]{};
+			}
+
+			if (!ReadProcessMemory(this->_hProc, this->_origin, this->_stolen, this->_size, nullptr)) return false;
 			
 			// install the trampoline hook
-			this->_gateway = mem::ex::trampHook(this->_hProc, this->_origin, this->_detour, originCallOffset, this->_size, this->_relativeAddressOffset);
+			this->_gateway = mem::ex::trampHook(this->_hProc, this->_origin, this->_detour, originCallOffset, this->_size, this->_relativeAddressOffset, this->_pPool);
 
 			if (!this->_gateway) return false;
 
@@ -91,31 +93,13 @@ namespace hax {
 		bool TrampHook::disable() {
 			if (!this->_hooked || !this->_origin || !this->_gateway) return false;
 
-			// overwritten/stolen bytes
-			BYTE* const stolen = new BYTE[this->_size]{};
-
-			// read the stolen bytes from the gateway
-			if (!ReadProcessMemory(this->_hProc, this->_gateway, stolen, this->_size, nullptr)) {
-				delete[] stolen;
-
-				return false;
-			}
-
-			// patch the saved relative address back
-			if (this->_relativeAddress) {
-				*reinterpret_cast<uint32_t*>(stolen + this->_relativeAddressOffset) = this->_relativeAddress;
-			}
-
 			// patch the stolen bytes back
-			if (!mem::ex::patch(this->_hProc, this->_origin, stolen, this->_size)) {
-				delete[] stolen;
-
-				return false;
-			}
+			if (!mem::ex::patch(this->_hProc, this->_origin, this->_stolen, this->_size)) return false;
 
-			delete[] stolen;
 			this->_hooked = false;
 
+			if (this->_pPool) return this->_pPool->free(this->_gateway);
+
 			return VirtualFreeEx(this->_hProc, this->_gateway, 0, MEM_RELEASE);
 		}
 
@@ -148,26 +132,13 @@ namespace hax {
 
 	namespace in {
 
-		TrampHook::TrampHook(BYTE* origin, const BYTE* detour, size_t size, size_t relativeAddressOffset) :
-			_origin(origin), _detour(detour), _size(size), _gateway{}, _hooked{}, _relativeAddressOffset(relativeAddressOffset), _relativeAddress{} {
-			const int32_t* const pRelativeAddress = reinterpret_cast<int32_t*>(reinterpret_cast<uintptr_t>(this->_origin) + this->_relativeAddressOffset);
+		TrampHook::TrampHook(BYTE* origin, const BYTE* detour, size_t size, size_t relativeAddressOffset, GatewayPool* pPool) :
+			_origin(origin), _detour(detour), _size(size), _gateway{}, _hooked{}, _relativeAddressOffset(relativeAddressOffset), _stolen{}, _pPool(pPool) {}
 
-			if (this->_relativeAddressOffset != SIZE_MAX && pRelativeAddress) {
-				this->_relativeAddress = *pRelativeAddress;
-			}
-		
-		}
 
-
-		TrampHook::TrampHook(const char* modName, const char* funcName, const BYTE* detour, size_t size, size_t relativeAddressOffset) :
-			_origin{}, _detour(detour), _size(size), _gateway{}, _hooked{}, _relativeAddressOffset(relativeAddressOffset), _relativeAddress{}
+		TrampHook::TrampHook(const char* modName, const char* funcName, const BYTE* detour, size_t size, size_t relativeAddressOffset, GatewayPool* pPool) :
+			_origin{}, _detour(detour), _size(size), _gateway{}, _hooked{}, _relativeAddressOffset(relativeAddressOffset), _stolen{}, _pPool(pPool)
 		{
-			const int32_t* const pRelativeAddress = reinterpret_cast<int32_t*>(reinterpret_cast<uintptr_t>(this->_origin) + this->_relativeAddressOffset);
-			
-			if (this->_relativeAddressOffset != SIZE_MAX && pRelativeAddress) {
-				this->_relativeAddress = *pRelativeAddress;
-			}
-			
 			const HMODULE hMod = proc::in::getModuleHandle(modName);
 
 			if (!hMod) return;
@@ -180,6 +151,11 @@ namespace hax {
 
 		TrampHook::~TrampHook() {
 			this->disable();
+
+			if (this->_stolen) {
+				delete[] this->_stolen;
+			}
+
 		}
 
 
@@ -187,7 +163,9 @@ namespace hax {
 
 			if (this->_hooked || !this->_origin || !this->_detour) return false;
 
-			this->_gateway = mem::in::trampHook(this->_origin, this->_detour, this->_size, this->_relativeAddressOffset);
+			if (!this->saveStolen()) return false;
+
+			this->_gateway = mem::in::trampHook(this->_origin, this->_detour, this->_size, this->_relativeAddressOffset, this->_pPool);
 
 			if (!this->_gateway) return false;
 
@@ -201,32 +179,46 @@ namespace hax {
 
 			if (!this->_hooked || !this->_origin || !this->_gateway) return false;
 
-			// overwritten/stolen bytes
-			BYTE* const stolen = new BYTE[this->_size]{};
+			// patch the stolen bytes back
+			if (!mem::in::patch(this->_origin, this->_stolen, this->_size)) return false;
 
-			// read the stolen bytes from the gateway
-			if (memcpy_s(stolen, this->_size, this->_gateway, this->_size)) {
-				delete[] stolen;
+			this->_hooked = false;
 
-				return false;
-			}
+			return this->freeGateway();
+		}
 
-			// patch the saved relative address back
-			if (this->_relativeAddress) {
-				*reinterpret_cast<uint32_t*>(stolen + this->_relativeAddressOffset) = this->_relativeAddress;
-			}
 
-			// patch the stolen bytes back
-			if (!mem::in::patch(this->_origin, stolen, this->_size)) {
-				delete[] stolen;
+		bool TrampHook::prepareEnable(PatchPlan* pPlan) {
+
+			if (this->_hooked || !this->_origin || !this->_detour) return false;
 
-				return false;
+			if (!this->saveStolen()) return false;
+
+			BYTE* const jump = new BYTE[this->_size]{};
+			this->_gateway = mem::in::prepareTrampHook(this->_origin, this->_detour, this->_size, this->_relativeAddressOffset, this->_pPool, jump);
+			const bool added = this->_gateway && pPlan->add(this->_origin, jump, this->_size);
+			delete[] jump;
+
+			if (this->_gateway && !added) {
+				this->freeGateway();
+				this->_gateway = nullptr;
 			}
 
-			delete[] stolen;
-			this->_hooked = false;
+			return added;
+		}
 
-			return VirtualFree(this->_gateway, 0, MEM_RELEASE);
+
+		void TrampHook::completeEnable(bool patched) {
+
+			if (patched) {
+				this->_hooked = true;
+			}
+			else {
+				this->freeGateway();
+				this->_gateway = nullptr;
+			}
+
+			return;
 		}
 
 
@@ -254,6 +246,32 @@ namespace hax {
 			return this->_gateway;
 		}
 
+
+		bool TrampHook::saveStolen() {
+
+			if (!this->_size) {
+				this->_size = mem::in::getStolenSize(this->_origin);
+
+				if (!this->_size) return false;
+
+			}
+
+			// save the stolen bytes to patch them back later, since the gateway contains the relocated instructions
+			if (!this->_stolen) {
+				this->_stolen = new BYTE[this->_size]{};
+			}
+
+			return !memcpy_s(this->_stolen, this->_size, this->_origin, this->_size);
+		}
+
+
+		bool TrampHook::freeGateway() {
+
+			if (this->_pPool) return this->_pPool->free(this->_gateway);
+
+			return VirtualFree(this->_gateway, 0, MEM_RELEASE);
+		}
+
 	}
 	
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include "IHook.h"
+#include "GatewayPool.h"
+#include "PatchPlan.h"
 #include <stdint.h>
 
 namespace hax {
@@ -14,7 +16,8 @@ namespace hax {
 		// This pattern has to be passed as an argument on object construction.
 		// When the origin function gets called by the target process (after enabling the hook) execution first jumps to the injected shell code.
 		// At the call of the placeholder execution jumps to the gateway containing the overwritten bytes of the origin function and then jumps back to the origin function.
-		// The stolen bytes overwritten by the jump from the origin function may not contain any references to data or code with static addresses.
+		// The number of stolen bytes overwritten by the jump from the origin function is determined by disassembling the origin function and relative branches and RIP-relative operands within them are relocated to the gateway.
+		// The stolen bytes may not contain any references to data or code with static addresses.
 		// Compiled to x64 the hook works both on x86 and x64 targets. Compiled to x86 it only works on x86 targets.
 		// The shell code always has to be compiled for the same architecture as the target process.
 		// The hook automatically uninstalls on desctuction of the installing object.
@@ -25,16 +28,18 @@ namespace hax {
 			void* _detour;
 			void* _detourOriginCall;
 			void* _gateway;
-			const size_t _size;
+			size_t _size;
 			const size_t _relativeAddressOffset;
-			uint32_t _relativeAddress;
+			// original bytes of the origin function that are patched back on disable
+			BYTE* _stolen;
+			GatewayPool* const _pPool;
 			bool _hooked;
 
 		public:
 			// Injects shell code into the target process and initializes members.
-			//
+			// 
 			// Parameters:
-			//
+			// 
 			// [in] hProc:
 			// Handle to the process that contains the origin function to be hooked.
 			// Needs at least PROCESS_QUERY_LIMITED_INFORMATION, PROCESS_VM_OPERATION, PROCESS_VM_READ and PROCESS_VM_WRITE access rights.
@@ -55,18 +60,20 @@ namespace hax {
 			// [in] size:
 			// Number of bytes that get overwritten by the jump at the beginning of the origin function.
 			// The overwritten instructions get executed by the gateway right before executing the origin function.
-			// Has to be at least five! Only complete instructions should be overwritten!
-			// It is necessary to look at the disassembly of the origin function to determine when the first complete instruction finishes after the first five bytes.
-			//			
+			// Zero to determine the size of the whole instructions covering the first five bytes by disassembling the origin function when the hook is enabled.
+			// Otherwise it has to be at least five and only complete instructions should be overwritten.
+			// 
 			// [in] relativeAddressOffset:
-			// The offset of a relative Address if there is one in the first <size> bytes of the origin function.
-			// It is necessary to look at the disassembly of the origin function to determine if there is a relative address in the first <size> bytes.
-			// If there is no relative address in the first <size> bytes of the origin function the default value of SIZE_MAX should be passed. This value will then be ignored.
-			TrampHook(HANDLE hProc, BYTE* origin, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size, size_t relatvieAddressOffset = SIZE_MAX);
+			// The offset of a relative address if there is one in the first <size> bytes of the origin function. Only this address is corrected and the bytes are copied as they are.
+			// If the default value of SIZE_MAX is passed all relative operands within the stolen bytes are relocated by disassembling them.
+			// 
+			// [in] pPool:
+			// Pool the gateway is allocated from. It has to allocate in the address space of the target process and outlive the object. Nullptr to allocate a separate memory region for the gateway.
+			TrampHook(HANDLE hProc, BYTE* origin, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size = 0u, size_t relativeAddressOffset = SIZE_MAX, GatewayPool* pPool = nullptr);
 
 			// Injects shell code into the target process and initializes members. Used to hook a exported function of a module of the target process by module name and export name.
 			// Hooks the beginning of the function, not the import address table, import directory or export directory!
-			//
+			// 
 			// Parameters:
 			// 
 			// [in] hProc:
@@ -91,15 +98,18 @@ namespace hax {
 			// [in] size:
 			// Number of bytes that get overwritten by the jump at the beginning of the origin function.
 			// The overwritten instructions get executed by the gateway right before executing the origin function.
-			// Has to be at least five! Only complete instructions should be overwritten!
-			// It is necessary to look at the disassembly of the origin function to determine when the first complete instruction finishes after the first five bytes.
-			//			
+			// Zero to determine the size of the whole instructions covering the first five bytes by disassembling the origin function when the hook is enabled.
+			// Otherwise it has to be at least five and only complete instructions should be overwritten.
+			// 
 			// [in] relativeAddressOffset:
-			// The offset of a relative Address if there is one in the first <size> bytes of the origin function.
-			// It is necessary to look at the disassembly of the origin function to determine if there is a relative address in the first <size> bytes.
-			// If there is no relative address in the first <size> bytes of the origin function the default value of SIZE_MAX should be passed. This value will then be ignored.
+			// The offset of a relative address if there is one in the first <size> bytes of the origin function. Only this address is corrected and the bytes are copied as they are.
+			// If the default value of SIZE_MAX is passed all relative operands within the stolen bytes are relocated by disassembling them.
+			// 
+			// [in] pPool:
+			// Pool the gateway is allocated from. It has to allocate in the address space of the target process and outlive the object. Nullptr to allocate a separate memory region for the gateway.
 			TrampHook(
-				HANDLE hProc, const char* modName, const char* funcName, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size, size_t relativeAddressOffset = SIZE_MAX
+				HANDLE hProc, const char* modName, const char* funcName, const BYTE* shell, size_t shellSize, const char* originCallPattern, size_t size = 0u, size_t relativeAddressOffset = SIZE_MAX,
+				GatewayPool* pPool = nullptr
 			);
 
 			TrampHook(TrampHook&&) = delete;
@@ -146,7 +156,8 @@ namespace hax {
 		// as the hooked function for uninterrupted process execution.
 		// When the origin function gets called by the process (after enabling the hook) execution first jumps to the detour function.
 		// When the gateway gets called execution jumps to the gateway containing the overwritten bytes of the origin function and then jumps back to the origin function.
-		// The stolen bytes overwritten by the jump from the origin function may not contain any references to data or code with static addresses.
+		// The number of stolen bytes overwritten by the jump from the origin function is determined by disassembling the origin function and relative branches and RIP-relative operands within them are relocated to the gateway.
+		// The stolen bytes may not contain any references to data or code with static addresses.
 		// The injected dll has to be compiled to the same architecture (x86 or x64) as the target process.
 		// The hook automatically uninstalls on desctuction of the installing object.
 		class TrampHook : public IHook {
@@ -154,9 +165,11 @@ namespace hax {
 			void* _origin;
 			const void* const _detour;
 			void* _gateway;
-			const size_t _size;
+			size_t _size;
 			const size_t _relativeAddressOffset;
-			uint32_t _relativeAddress;
+			// original bytes of the origin function that are patched back on disable
+			BYTE* _stolen;
+			GatewayPool* const _pPool;
 			bool _hooked;
 
 		public:
@@ -173,14 +186,16 @@ namespace hax {
 			// [in] size:
 			// Number of bytes that get overwritten by the jump at the beginning of the origin function.
 			// The overwritten instructions get executed by the gateway right before executing the origin function.
-			// Has to be at least five! Only complete instructions should be overwritten!
-			// It is necessary to look at the disassembly of the origin function to determine when the first complete instruction finishes after the first five bytes.
-			//
+			// Zero to determine the size of the whole instructions covering the first five bytes by disassembling the origin function when the hook is enabled.
+			// Otherwise it has to be at least five and only complete instructions should be overwritten.
+			// 
 			// [in] relativeAddressOffset:
-			// The offset of a relative Address if there is one in the first <size> bytes of the origin function.
-			// It is necessary to look at the disassembly of the origin function to determine if there is a relative address in the first <size> bytes.
-			// If there is no relative address in the first <size> bytes of the origin function the default value of SIZE_MAX should be passed. This value will then be ignored.
-			TrampHook(BYTE* origin, const BYTE* detour, size_t size, size_t relativeAddressOffset = SIZE_MAX);
+			// The offset of a relative address if there is one in the first <size> bytes of the origin function. Only this address is corrected and the bytes are copied as they are.
+			// If the default value of SIZE_MAX is passed all relative operands within the stolen bytes are relocated by disassembling them.
+			// 
+			// [in] pPool:
+			// Pool the gateway is allocated from. It has to allocate in the address space of the caller process and outlive the object. Nullptr to allocate a separate memory region for the gateway.
+			TrampHook(BYTE* origin, const BYTE* detour, size_t size = 0u, size_t relativeAddressOffset = SIZE_MAX, GatewayPool* pPool = nullptr);
 
 			// Initializes members. Used to hook a exported function of a module of the target process by module name and export name.
 			// Hooks the beginning of the function, not the import address table, import directory or export directory!
@@ -199,14 +214,16 @@ namespace hax {
 			// [in] size:
 			// Number of bytes that get overwritten by the jump at the beginning of the origin function.
 			// The overwritten instructions get executed by the gateway right before executing the origin function.
-			// Has to be at least five! Only complete instructions should be overwritten!
-			// It is necessary to look at the disassembly of the origin function to determine when the first complete instruction finishes after the first five bytes.
-			//
+			// Zero to determine the size of the whole instructions covering the first five bytes by disassembling the origin function when the hook is enabled.
+			// Otherwise it has to be at least five and only complete instructions should be overwritten.
+			// 
 			// [in] relativeAddressOffset:
-			// The offset of a relative Address if there is one in the first <size> bytes of the origin function.
-			// It is necessary to look at the disassembly of the origin function to determine if there is a relative address in the first <size> bytes.
-			// If there is no relative address in the first <size> bytes of the origin function the default value of SIZE_MAX should be passed. This value will then be ignored.
-			TrampHook(const char* modName, const char* funcName, const BYTE* detour, size_t size, size_t relativeAddressOffset = SIZE_MAX);
+			// The offset of a relative address if there is one in the first <size> bytes of the origin function. Only this address is corrected and the bytes are copied as they are.
+			// If the default value of SIZE_MAX is passed all relative operands within the stolen bytes are relocated by disassembling them.
+			// 
+			// [in] pPool:
+			// Pool the gateway is allocated from. It has to allocate in the address space of the caller process and outlive the object. Nullptr to allocate a separate memory region for the gateway.
+			TrampHook(const char* modName, const char* funcName, const BYTE* detour, size_t size = 0u, size_t relativeAddressOffset = SIZE_MAX, GatewayPool* pPool = nullptr);
 
 			TrampHook(TrampHook&&) = delete;
 
@@ -230,6 +247,26 @@ namespace hax {
 			// In this case the function will also return false as well as a call to isHooked.
 			bool disable();
 
+			// Prepares enabling the hook without patching the origin function. The gateway is set up and the jump to the detour is added to a patch plan.
+			// Used by HookTransaction to install many hooks at once. On success completeEnable has to be called after the plan was applied.
+			// 
+			// Parameters:
+			// 
+			// [in] pPlan:
+			// The plan the jump is added to.
+			// 
+			// Return:
+			// True on success, false on failure.
+			bool prepareEnable(PatchPlan* pPlan);
+
+			// Completes enabling the hook after prepareEnable succeeded.
+			// 
+			// Parameters:
+			// 
+			// [in] patched:
+			// True if the patches of the plan were written. Otherwise the gateway is freed and the hook stays disabled.
+			void completeEnable(bool patched);
+
 			// Checks if the hook is currently installed.
 			// 
 			// Return:
@@ -239,6 +276,12 @@ namespace hax {
 			void* getOrigin() const;
 			void* getDetour() const;
 			void* getGateway() const;
+
+		private:
+			// determines the size if necessary and saves the stolen bytes
+			bool saveStolen();
+			// frees the gateway from the pool or its memory region
+			bool freeGateway();
 		};
 
 	}
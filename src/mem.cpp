@@ -1,6 +1,12 @@
 #pragma once
 #include "mem.h"
+#include "disasm.h"
+#include "hooks\AddressSpace.h"
+#include "scan\MemorySource.h"
+#include "scan\ModuleScanner.h"
+#include "scan\SigScanner.h"
 #include <stdint.h>
+#include <intrin.h>
 
 namespace hax {
 
@@ -8,16 +14,6 @@ namespace hax {
 
 		#ifdef _WIN64
 
-		typedef struct AddressRange {
-			uintptr_t start;
-			uintptr_t min;
-			uintptr_t max;
-			uintptr_t pageSize;
-		}AddressRange;
-
-		// gets the range of address that is reachable by a relative jump
-		static void getNearAddressRange(const void* pBase, AddressRange* pAddrRange);
-
 		// ASM:
 		// jmp QWORD PTR[rip + 0x0000000000000000]
 		constexpr BYTE X64_JUMP[]{ 0xFF, 0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
@@ -32,25 +28,138 @@ namespace hax {
 		// jmp 0x00000000
 		constexpr BYTE X86_JUMP[]{ 0xE9, 0x00, 0x00, 0x00, 0x00 };
 
+		// the overwritten instructions end at most one instruction behind the first byte after the relative jump
+		constexpr size_t MAX_STOLEN_SIZE = sizeof(X86_JUMP) - 1u + disasm::MAX_INSTRUCTION_SIZE;
+
+		// smallest page size, reads that fail are retried up to the end of the page
+		constexpr uintptr_t MIN_PAGE_SIZE = 0x1000u;
+
+		// instruction set extensions used for signature scanning
+		typedef enum SimdLevel {
+			SIMD_NONE, SIMD_SSE2, SIMD_AVX2
+		}SimdLevel;
+
+		// signature in packed byte and mask form with the offsets of the bytes the memory is searched for before comparing the whole signature
+		typedef struct ScanPlan {
+			const BYTE* bytes;
+			const BYTE* mask;
+			size_t size;
+			// offset of the rarest non-wildcard byte, SIZE_MAX if the signature only consists of wildcards
+			size_t anchor;
+			// offset of the second rarest non-wildcard byte, same as anchor if there is only one non-wildcard byte
+			size_t secondAnchor;
+		}ScanPlan;
+
+		// picks the anchor bytes of a signature
+		static void planScan(const BYTE* bytes, const BYTE* mask, size_t size, ScanPlan* pPlan);
+		// finds the first position in a buffer that matches the planned signature
+		static const BYTE* scanBuffer(const BYTE* base, size_t size, const ScanPlan* pPlan);
+		static const BYTE* scanScalar(const BYTE* base, size_t begin, size_t end, const ScanPlan* pPlan);
+		static const BYTE* scanSse2(const BYTE* base, size_t positions, const ScanPlan* pPlan);
+		static const BYTE* scanAvx2(const BYTE* base, size_t positions, const ScanPlan* pPlan);
+		static SimdLevel getSimdLevel();
+
+		// signatures parsed from strings into packed byte and mask form
+		typedef struct PackedSignatures {
+			// bytes followed by the masks of all signatures
+			BYTE* buffer;
+			const BYTE** bytes;
+			const BYTE** masks;
+			size_t* sizes;
+		}PackedSignatures;
+
+		static bool packSignatures(const char* const signatures[], size_t count, PackedSignatures* pPacked);
+		static void freePackedSignatures(PackedSignatures* pPacked);
+
+		// finds all positions in a buffer that match the planned signature
+		static size_t scanBufferAll(const BYTE* base, size_t size, const ScanPlan* pPlan, tMatchCallback callback, void* pArg);
+
+		// buffer that receives the addresses of a find-all scan
+		typedef struct AddressSink {
+			void** addresses;
+			size_t limit;
+			size_t count;
+		}AddressSink;
+
+		static bool storeAddress(void* address, void* pArg);
+
+		// size of the chunk buffer for scans of the caller process, memory is scanned in place and the buffer only holds bytes across region boundaries or of protected regions
+		static constexpr size_t IN_CHUNK_SIZE = 0x1000u;
+
+		// strings are read in chunks that do not cross this boundary, so a read never fails because of an inaccessible page after the string
+		static constexpr size_t STRING_PAGE_SIZE = 0x1000u;
+
+		template <typename C>
+		static bool copyStringChunked(IMemorySource* pSource, C* dst, const void* src, size_t size);
+		// gets the length of a string that is not necessarily null terminated
+		template <typename C>
+		static size_t getStringLength(const C* str, size_t maxLength);
+		// writes a relative jump that is executed at an address padded with nops to a buffer
+		static bool assembleRelJump(BYTE* buffer, size_t size, const void* address, const void* target);
+		// frees a gateway of a trampoline hook in an external process either to the pool or to the system
+		static void freeGateway(HANDLE hProc, void* gateway, GatewayPool* pPool);
+		// frees a gateway of a trampoline hook in the caller process either to the pool or to the system
+		static void freeGateway(void* gateway, GatewayPool* pPool);
+
 		namespace ex {
 
-			void* trampHook(HANDLE hProc, void* origin, void* detour, size_t originCallOffset, size_t size, size_t relativeAddressOffset) {
+			void* trampHook(HANDLE hProc, void* origin, void* detour, size_t originCallOffset, size_t size, size_t relativeAddressOffset, GatewayPool* pPool) {
+				BOOL isWow64 = false;
+				IsWow64Process(hProc, &isWow64);
+
+				#ifdef _WIN64
+
+				const bool x64 = !isWow64;
+
+				#else
+
+				const bool x64 = false;
+
+				#endif // _WIN64
+
+				if (!size) {
+					size = getStolenSize(hProc, origin);
+				}
+
+				if (size < sizeof(X86_JUMP)) return nullptr;
 
 				if (relativeAddressOffset != SIZE_MAX && relativeAddressOffset + sizeof(uint32_t) > size)
 				{
 					return nullptr;
 				}
 
+				// read the overwritten bytes of the origin
+				BYTE* const stolen = new BYTE[size]{};
+
+				if (!ReadProcessMemory(hProc, origin, stolen, size, nullptr)) {
+					delete[] stolen;
+
+					return nullptr;
+				}
+
+				// without a relative address offset the overwritten instructions are decoded and their relative operands are relocated, which can widen short branches
+				const bool relocateStolen = relativeAddressOffset == SIZE_MAX;
+				const size_t gatewayCodeSize = relocateStolen ? disasm::relocate(stolen, size, origin, x64, nullptr, 0u, nullptr) : size;
+
+				if (!gatewayCodeSize) {
+					delete[] stolen;
+
+					return nullptr;
+				}
+
 				void* gateway = nullptr;
 				size_t targetPtrSize = 0u;
 
-				BOOL isWow64 = false;
-				IsWow64Process(hProc, &isWow64);
-
 				if (isWow64) {
 					// allocate enough memory for the relative jump (gateway to origin)
 					// VirtualAllocEx can be used for x86 targets since in x86 every address is reachable by a relative jump and the relay is not neccessary
-					gateway = VirtualAllocEx(hProc, nullptr, size + sizeof(X86_JUMP), MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+					if (pPool) {
+						gateway = pPool->allocate(nullptr, gatewayCodeSize + sizeof(X86_JUMP));
+					}
+					else {
+						gateway = VirtualAllocEx(hProc, nullptr, gatewayCodeSize + sizeof(X86_JUMP), MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+					}
+
 					targetPtrSize = sizeof(uint32_t);
 				}
 				else {
@@ -59,78 +168,69 @@ namespace hax {
 					#ifdef _WIN64
 
 					// allocate enough memory for the relative jump (gateway to origin) and the absolute relay jump (relay to detour) near the origin (reachable by relative jump)
-					gateway = virtualAllocNear(hProc, origin, size + sizeof(X86_JUMP) + sizeof(X64_JUMP));
+					if (pPool) {
+						gateway = pPool->allocate(origin, gatewayCodeSize + sizeof(X86_JUMP) + sizeof(X64_JUMP));
+					}
+					else {
+						gateway = virtualAllocNear(hProc, origin, gatewayCodeSize + sizeof(X86_JUMP) + sizeof(X64_JUMP));
+					}
+
 					targetPtrSize = sizeof(uint64_t);
 
 					#endif // _WIN64
 
 				}
 
-				if (!gateway) return nullptr;
+				if (!gateway) {
+					delete[] stolen;
+
+					return nullptr;
+				}
 
 				void* const pDetourOriginCall = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(detour) + originCallOffset);
 				
 				// overwrite the origin call placeholder
 				if (!WriteProcessMemory(hProc, pDetourOriginCall, &gateway, targetPtrSize, nullptr)) {
-					VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
-
-					return nullptr;
-				}
-
-				// write the overwritten bytes of the origin to the gateway
-				BYTE* stolen = new BYTE[size]{};
-
-				if (!ReadProcessMemory(hProc, origin, stolen, size, nullptr)) {
-					VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
+					freeGateway(hProc, gateway, pPool);
 					delete[] stolen;
 
 					return nullptr;
 				}
 
-				if (!WriteProcessMemory(hProc, gateway, stolen, size, nullptr)) {
-					VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
-					delete[] stolen;
+				BYTE* const gatewayCode = new BYTE[gatewayCodeSize]{};
+				bool copied = false;
 
-					return nullptr;
+				if (relocateStolen) {
+					copied = disasm::relocate(stolen, size, origin, x64, gatewayCode, gatewayCodeSize, gateway) == gatewayCodeSize;
 				}
-
-				delete[] stolen;
-
-				// correct the relative address
-				if (relativeAddressOffset != SIZE_MAX) {
-
-					const void* const pOriginRelativeAddress = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(origin) + relativeAddressOffset);
-					int32_t oldRelativeAddress = 0;
-
-					if (!ReadProcessMemory(hProc, pOriginRelativeAddress, &oldRelativeAddress, sizeof(oldRelativeAddress), nullptr)) {
-						VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
-
-						return nullptr;
-					}
-
+				else {
+					// correct the relative address
+					const int32_t oldRelativeAddress = *reinterpret_cast<int32_t*>(stolen + relativeAddressOffset);
 					const ptrdiff_t correctedRelativeAddress = oldRelativeAddress + reinterpret_cast<uintptr_t>(origin) - reinterpret_cast<uintptr_t>(gateway);
 
-					if (correctedRelativeAddress < INT32_MIN || correctedRelativeAddress > INT32_MAX) {
-
-						return nullptr;
-					}
+					memcpy(gatewayCode, stolen, size);
+					*reinterpret_cast<int32_t*>(gatewayCode + relativeAddressOffset) = static_cast<int32_t>(correctedRelativeAddress);
+					copied = correctedRelativeAddress >= INT32_MIN && correctedRelativeAddress <= INT32_MAX;
+				}
 
-					void* const pGatewayRelativeAddress = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + relativeAddressOffset);
-					
-					if (!WriteProcessMemory(hProc, pGatewayRelativeAddress, &correctedRelativeAddress, sizeof(uint32_t), nullptr)) {
-						VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
+				delete[] stolen;
 
-						return nullptr;
-					}
+				// write the overwritten bytes of the origin to the gateway
+				if (!copied || !WriteProcessMemory(hProc, gateway, gatewayCode, gatewayCodeSize, nullptr)) {
+					freeGateway(hProc, gateway, pPool);
+					delete[] gatewayCode;
 
+					return nullptr;
 				}
 
-				void* const pGatewayJump = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + size);
-				const void* const pOriginJumpDst = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(origin) + sizeof(X86_JUMP));
+				delete[] gatewayCode;
+
+				void* const pGatewayJump = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + gatewayCodeSize);
+				const void* const pOriginJumpDst = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(origin) + size);
 
 				// relative jump from the gateway to the origin
 				if (!relJmp(hProc, pGatewayJump, pOriginJumpDst, sizeof(X86_JUMP))) {
-					VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
+					freeGateway(hProc, gateway, pPool);
 
 					return nullptr;
 				}
@@ -139,7 +239,7 @@ namespace hax {
 
 					// relative jump directly from origin to detour (will always be reachable in x86 targets)
 					if (!relJmp(hProc, origin, detour, size)) {
-						VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
+						freeGateway(hProc, gateway, pPool);
 
 						return nullptr;
 					}
@@ -152,18 +252,18 @@ namespace hax {
 
 					// in x64 targets an absolute jump is needed to reliably jump from the origin to the detour
 					// instead of patching the origin with a longer absolute jump, a relay is used that can be reached by a relative jump
-					void* const relay = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + size + sizeof(X86_JUMP));
+					void* const relay = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + gatewayCodeSize + sizeof(X86_JUMP));
 
 					// absolute jump from the relay to the detour function
 					if (!absJumpX64(hProc, relay, detour, sizeof(X64_JUMP))) {
-						VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
+						freeGateway(hProc, gateway, pPool);
 
 						return nullptr;
 					}
 
 					// relative jump from the origin to the relay
 					if (!relJmp(hProc, origin, relay, size)) {
-						VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
+						freeGateway(hProc, gateway, pPool);
 
 						return nullptr;
 					}
@@ -176,40 +276,41 @@ namespace hax {
 			}
 
 
-			#ifdef _WIN64
-
-			void* virtualAllocNear(HANDLE hProc, const void* address, size_t size) {
-				AddressRange range{};
-				getNearAddressRange(address, &range);
+			size_t getStolenSize(HANDLE hProc, const void* origin) {
+				BOOL isWow64 = false;
+				IsWow64Process(hProc, &isWow64);
 
-				uintptr_t offset = range.pageSize;
-				bool exhausted = false;
-				BYTE* retAddress = nullptr;
+				#ifdef _WIN64
 
-				// try to allocte the memory at the beginning of every memory page in range until successful
-				while (!exhausted) {
-					const uintptr_t high = range.start + offset;
-					const uintptr_t low = (range.start > offset) ? range.start - offset : 0u;
+				const bool x64 = !isWow64;
 
-					if (high < range.max) {
-						retAddress = static_cast<BYTE*>(VirtualAllocEx(hProc, reinterpret_cast<void*>(high), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+				#else
 
-						if (retAddress) return retAddress;
+				const bool x64 = false;
 
-					}
+				#endif // _WIN64
 
-					if (low > range.min) {
-						retAddress = static_cast<BYTE*>(VirtualAllocEx(hProc, reinterpret_cast<void*>(low), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+				BYTE code[MAX_STOLEN_SIZE]{};
+				size_t readSize = sizeof(code);
 
-						if (retAddress) return retAddress;
+				// the function can end right before an unreadable page
+				if (!ReadProcessMemory(hProc, origin, code, readSize, nullptr)) {
+					readSize = static_cast<size_t>(MIN_PAGE_SIZE - reinterpret_cast<uintptr_t>(origin) % MIN_PAGE_SIZE);
 
-					}
+					if (readSize >= sizeof(code) || !ReadProcessMemory(hProc, origin, code, readSize, nullptr)) return 0u;
 
-					offset += range.pageSize;
-					exhausted = high > range.max && low < range.min;
 				}
 
-				return nullptr;
+				return disasm::getCopySize(code, readSize, x64, sizeof(X86_JUMP));
+			}
+
+
+			#ifdef _WIN64
+
+			void* virtualAllocNear(HANDLE hProc, const void* address, size_t size) {
+				hax::ex::AddressSpace space(hProc);
+
+				return GatewayPool::allocateNear(&space, address, size);
 			}
 
 			#endif // _WIN64
@@ -320,6 +421,21 @@ namespace hax {
 			}
 
 
+			void* resolveRelative(HANDLE hProc, const void* address, const RelativeOperand* operands, size_t count) {
+				BYTE* target = const_cast<BYTE*>(reinterpret_cast<const BYTE*>(address));
+
+				for (size_t i = 0u; i < count; i++) {
+					int32_t displacement = 0;
+
+					if (!ReadProcessMemory(hProc, target + operands[i].displacementOffset, &displacement, sizeof(displacement), nullptr)) return nullptr;
+
+					target += operands[i].instructionEnd + displacement;
+				}
+
+				return target;
+			}
+
+
 			void* findSigAddress(HANDLE hProc, const void* base, size_t size, const char* signature) {
 				// size of byte string signature of format "DE AD"
 				const size_t sigSize = (strlen(signature) + 1u) / 3u;
@@ -331,63 +447,95 @@ namespace hax {
 					return nullptr;
 				}
 
-				BYTE* address = nullptr;
-				MEMORY_BASIC_INFORMATION mbi{};
+				// bytes followed by the mask
+				BYTE* const pattern = new BYTE[2u * sigSize]{};
 
-				// scan each memory region at a time
-				for (size_t i = 0u; i < size; i += mbi.RegionSize) {
+				for (size_t i = 0u; i < sigSize; i++) {
+					// -1 acts as wildcard
+					pattern[i] = sig[i] == -1 ? 0x00 : static_cast<BYTE>(sig[i]);
+					pattern[sigSize + i] = sig[i] == -1 ? 0x00 : 0xFF;
+				}
 
-					// scan only if commited and accessable
-					if (!VirtualQueryEx(hProc, reinterpret_cast<const BYTE*>(base) + i, &mbi, sizeof(mbi)) || mbi.State != MEM_COMMIT || mbi.Protect == PAGE_NOACCESS) continue;
+				delete[] sig;
 
-					DWORD oldProtect = 0ul;
+				hax::ex::MemorySource source(hProc);
+				SigScanner scanner(&source);
+				const BYTE* const address = scanner.find(base, size, pattern, pattern + sigSize, sigSize);
 
-					if (!VirtualProtectEx(hProc, mbi.BaseAddress, mbi.RegionSize, PAGE_EXECUTE_READWRITE, &oldProtect)) continue;
+				delete[] pattern;
 
-					// heap buffer to scan
-					BYTE* const buffer = new BYTE[mbi.RegionSize];
+				return const_cast<BYTE*>(address);
+			}
 
-					if (!ReadProcessMemory(hProc, mbi.BaseAddress, buffer, mbi.RegionSize, nullptr)) {
-						delete[] buffer;
 
-						continue;
-					}
+			void* findSigAddress(HANDLE hProc, const void* base, size_t size, const Signature& signature) {
+				hax::ex::MemorySource source(hProc);
+				SigScanner scanner(&source);
 
-					if (!VirtualProtectEx(hProc, mbi.BaseAddress, mbi.RegionSize, oldProtect, &oldProtect)) {
-						delete[] buffer;
+				return const_cast<BYTE*>(scanner.find(base, size, signature));
+			}
 
-						continue;
-					}
 
-					// address of found signature within heap buffer
-					const void* const inBufferAddress = helper::findSignature(buffer, mbi.RegionSize, sig, sigSize);
+			size_t findAllSigAddresses(HANDLE hProc, const void* base, size_t size, const Signature& signature, tMatchCallback callback, void* pArg) {
+				hax::ex::MemorySource source(hProc);
+				SigScanner scanner(&source);
 
-					if (inBufferAddress) {
-						address = const_cast<BYTE*>(reinterpret_cast<const BYTE*>(base) + i) + (reinterpret_cast<const BYTE*>(inBufferAddress) - buffer);
-					}
+				return scanner.findAll(base, size, signature, callback, pArg);
+			}
 
-					delete[] buffer;
-				}
 
-				delete[] sig;
+			size_t findAllSigAddresses(HANDLE hProc, const void* base, size_t size, const Signature& signature, void* addresses[], size_t limit) {
 
-				return address;
+				if (!addresses || !limit) return 0u;
+
+				AddressSink sink{ addresses, limit, 0u };
+				findAllSigAddresses(hProc, base, size, signature, storeAddress, &sink);
+
+				return sink.count;
 			}
 
 
-			bool copyRemoteString(HANDLE hProc, char* dst, const void* src, size_t size) {
+			DWORD findSigRva(HANDLE hProc, HMODULE hMod, const Signature& signature, DWORD sectionTypes) {
+				hax::ex::MemorySource source(hProc);
+				ModuleScanner scanner(&source);
 
-				for (size_t i = 0u; i < size; i++) {
+				if (!scanner.setModule(hMod)) return 0ul;
+
+				return scanner.findSigRva(signature, sectionTypes);
+			}
 
-					if (!ReadProcessMemory(hProc, reinterpret_cast<const BYTE*>(src) + i, &dst[i], sizeof(char), nullptr)) return false;
 
-					// end of string
-					if (dst[i] == '\0') return true;
+			bool findSigAddresses(HANDLE hProc, const void* base, size_t size, const char* const signatures[], void* addresses[], size_t count) {
 
+				for (size_t i = 0u; i < count; i++) {
+					addresses[i] = nullptr;
 				}
 
-				// did not contain a null charater so something went wrong
-				return false;
+				PackedSignatures packed{};
+
+				if (!packSignatures(signatures, count, &packed)) return false;
+
+				hax::ex::MemorySource source(hProc);
+				SigScanner scanner(&source);
+				const size_t found = scanner.findEach(base, size, packed.bytes, packed.masks, packed.sizes, addresses, count);
+
+				freePackedSignatures(&packed);
+
+				return found == count;
+			}
+
+
+			bool copyRemoteString(HANDLE hProc, char* dst, const void* src, size_t size) {
+				hax::ex::MemorySource source(hProc);
+
+				return helper::copyString(&source, dst, src, size);
+			}
+
+
+			bool copyRemoteString(HANDLE hProc, wchar_t* dst, const void* src, size_t size) {
+				hax::ex::MemorySource source(hProc);
+
+				return helper::copyString(&source, dst, src, size);
 			}
 
 
@@ -415,57 +563,120 @@ namespace hax {
 
 		namespace in {
 
-			void* trampHook(void* origin, const void* detour, size_t size, size_t relativeAddressOffset) {
+			void* trampHook(void* origin, const void* detour, size_t size, size_t relativeAddressOffset, GatewayPool* pPool) {
+
+				if (!size) {
+					size = getStolenSize(origin);
+				}
+
+				if (size < sizeof(X86_JUMP)) return nullptr;
+
+				BYTE* const jump = new BYTE[size]{};
+				void* gateway = prepareTrampHook(origin, detour, size, relativeAddressOffset, pPool, jump);
+
+				// the jump and the padding nops are written with a single protection change
+				if (gateway && !patch(origin, jump, size)) {
+					freeGateway(gateway, pPool);
+					gateway = nullptr;
+				}
+
+				delete[] jump;
+
+				return gateway;
+			}
+
+
+			void* prepareTrampHook(void* origin, const void* detour, size_t size, size_t relativeAddressOffset, GatewayPool* pPool, BYTE* jump) {
+				#ifdef _WIN64
+
+				constexpr bool x64 = true;
+
+				#else
+
+				constexpr bool x64 = false;
+
+				#endif // _WIN64
+
+				if (size < sizeof(X86_JUMP)) return nullptr;
 
 				if (relativeAddressOffset != SIZE_MAX && relativeAddressOffset + sizeof(uint32_t) > size)
 				{
 					return nullptr;
 				}
 
+				const BYTE* const stolen = static_cast<const BYTE*>(origin);
+
+				// without a relative address offset the overwritten instructions are decoded and their relative operands are relocated, which can widen short branches
+				const bool relocateStolen = relativeAddressOffset == SIZE_MAX;
+				const size_t gatewayCodeSize = relocateStolen ? disasm::relocate(stolen, size, origin, x64, nullptr, 0u, nullptr) : size;
+
+				if (!gatewayCodeSize) return nullptr;
+
 				// allocate memory for the gateway
+				void* gateway = nullptr;
+
 				#ifdef _WIN64
 
 				// allocate enough memory for the relative jump (gateway to origin) and the absolute relay jump (relay to detour) near the origin (reachable by relative jump)
-				void* const gateway = virtualAllocNear(origin, size + sizeof(X86_JUMP) + sizeof(X64_JUMP));
+				if (pPool) {
+					gateway = pPool->allocate(origin, gatewayCodeSize + sizeof(X86_JUMP) + sizeof(X64_JUMP));
+				}
+				else {
+					gateway = virtualAllocNear(origin, gatewayCodeSize + sizeof(X86_JUMP) + sizeof(X64_JUMP));
+				}
 
 				#else
 
 				// allocate enough memory for the relative jump (gateway to origin)
 				// VirtualAllocEx can be used for x86 targets since in x86 every address is reachable by a relative jump and the relay is not neccessary
-				void* const gateway = VirtualAlloc(nullptr, size + sizeof(X86_JUMP), MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+				if (pPool) {
+					gateway = pPool->allocate(nullptr, gatewayCodeSize + sizeof(X86_JUMP));
+				}
+				else {
+					gateway = VirtualAlloc(nullptr, gatewayCodeSize + sizeof(X86_JUMP), MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
+				}
 
 				#endif
 
 				if (!gateway) return nullptr;
 
 				// write the overwritten bytes of the origin to the gateway
-				if (memcpy_s(gateway, size, origin, size)) {
-					VirtualFree(gateway, 0, MEM_RELEASE);
+				if (relocateStolen) {
+
+					if (disasm::relocate(stolen, size, origin, x64, static_cast<BYTE*>(gateway), gatewayCodeSize, gateway) != gatewayCodeSize) {
+						freeGateway(gateway, pPool);
+
+						return nullptr;
+					}
 
-					return nullptr;
 				}
+				else {
 
-				// correct the relative address
-				if (relativeAddressOffset != SIZE_MAX) {
+					if (memcpy_s(gateway, size, origin, size)) {
+						freeGateway(gateway, pPool);
+
+						return nullptr;
+					}
 
-					const int32_t oldRelativeAddress = *reinterpret_cast<int32_t*>(reinterpret_cast<uintptr_t>(origin) + relativeAddressOffset);
-					const int32_t correctedRelativeAddress = static_cast<int32_t>(oldRelativeAddress + reinterpret_cast<uintptr_t>(origin) - reinterpret_cast<uintptr_t>(gateway));
+					// correct the relative address
+					const int32_t oldRelativeAddress = *reinterpret_cast<const int32_t*>(stolen + relativeAddressOffset);
+					const ptrdiff_t correctedRelativeAddress = oldRelativeAddress + reinterpret_cast<uintptr_t>(origin) - reinterpret_cast<uintptr_t>(gateway);
 
 					if (correctedRelativeAddress < INT32_MIN || correctedRelativeAddress > INT32_MAX) {
+						freeGateway(gateway, pPool);
 
 						return nullptr;
 					}
 
-					*reinterpret_cast<uint32_t*>(reinterpret_cast<uintptr_t>(gateway) + relativeAddressOffset) = correctedRelativeAddress;
-
+					*reinterpret_cast<int32_t*>(reinterpret_cast<uintptr_t>(gateway) + relativeAddressOffset) = static_cast<int32_t>(correctedRelativeAddress);
 				}
 
-				void* const pGatewayJump = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + size);
-				const void* const pOriginJumpDst = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(origin) + sizeof(X86_JUMP));
+				void* const pGatewayJump = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + gatewayCodeSize);
+				const void* const pOriginJumpDst = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(origin) + size);
 
 				// relative jump from the gateway to the origin
 				if (!relJmp(pGatewayJump, pOriginJumpDst, sizeof(X86_JUMP))) {
-					VirtualFree(gateway, 0, MEM_RELEASE);
+					freeGateway(gateway, pPool);
 
 					return nullptr;
 				}
@@ -474,18 +685,18 @@ namespace hax {
 
 				// in x64 targets an absolute jump is needed to reliably jump from the origin to the detour
 				// instead of patching the origin with a longer absolute jump, a relay is used that can be reached by a relative jump
-				void* const relay = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + size + sizeof(X86_JUMP));
+				void* const relay = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(gateway) + gatewayCodeSize + sizeof(X86_JUMP));
 
 				// absolute jump from the relay to the detour function
 				if (!absJumpX64(relay, detour, sizeof(X64_JUMP))) {
-					VirtualFree(gateway, 0, MEM_RELEASE);
+					freeGateway(gateway, pPool);
 
 					return nullptr;
 				}
 
 				// relative jump from the origin to the relay
-				if (!relJmp(origin, relay, size)) {
-					VirtualFree(gateway, 0, MEM_RELEASE);
+				if (!assembleRelJump(jump, size, origin, relay)) {
+					freeGateway(gateway, pPool);
 
 					return nullptr;
 				}
@@ -493,8 +704,8 @@ namespace hax {
 				#else
 
 				// relative jump directly from origin to detour (will always be reachable in x86 targets)
-				if (!relJmp(origin, detour, size)) {
-					VirtualFree(gateway, 0, MEM_RELEASE);
+				if (!assembleRelJump(jump, size, origin, detour)) {
+					freeGateway(gateway, pPool);
 
 					return nullptr;
 				}
@@ -505,40 +716,28 @@ namespace hax {
 			}
 
 
-			#ifdef _WIN64
-
-			void* virtualAllocNear(const void* address, size_t size) {
-				AddressRange range{};
-				getNearAddressRange(address, &range);
-
-				uintptr_t offset = range.pageSize;
-				bool exhausted = false;
-				BYTE* retAddress = nullptr;
+			size_t getStolenSize(const void* origin) {
+				#ifdef _WIN64
 
-				// try to allocte the memory at the beginning of every memory page in range until successful
-				while (!exhausted) {
-					const uintptr_t high = range.start + offset;
-					const uintptr_t low = (range.start > offset) ? range.start - offset : 0u;
+				constexpr bool x64 = true;
 
-					if (high < range.max) {
-						retAddress = static_cast<BYTE*>(VirtualAlloc(reinterpret_cast<void*>(high), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+				#else
 
-						if (retAddress) return retAddress;
+				constexpr bool x64 = false;
 
-					}
+				#endif // _WIN64
 
-					if (low > range.min) {
-						retAddress = static_cast<BYTE*>(VirtualAlloc(reinterpret_cast<void*>(low), size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE));
+				// the decoder only accesses the bytes of the decoded instructions, so no bytes behind the end of the function are read
+				return disasm::getCopySize(static_cast<const BYTE*>(origin), MAX_STOLEN_SIZE, x64, sizeof(X86_JUMP));
+			}
 
-						if (retAddress) return retAddress;
 
-					}
+			#ifdef _WIN64
 
-					offset += range.pageSize;
-					exhausted = high > range.max && low < range.min;
-				}
+			void* virtualAllocNear(const void* address, size_t size) {
+				hax::in::AddressSpace space;
 
-				return nullptr;
+				return GatewayPool::allocateNear(&space, address, size);
 			}
 
 			#endif // _WIN64
@@ -641,6 +840,17 @@ namespace hax {
 			}
 
 
+			void* resolveRelative(const void* address, const RelativeOperand* operands, size_t count) {
+				BYTE* target = const_cast<BYTE*>(reinterpret_cast<const BYTE*>(address));
+
+				for (size_t i = 0u; i < count; i++) {
+					target += operands[i].instructionEnd + *reinterpret_cast<const int32_t*>(target + operands[i].displacementOffset);
+				}
+
+				return target;
+			}
+
+
 			void* findSigAddress(const void* base, size_t size, const char* signature) {
 				// size of byte string signature of format "DE AD"
 				const size_t sigSize = (strlen(signature) + 1) / 3;
@@ -673,6 +883,63 @@ namespace hax {
 			}
 
 
+			void* findSigAddress(const void* base, size_t size, const Signature& signature) {
+				hax::in::MemorySource source;
+				SigScanner scanner(&source, IN_CHUNK_SIZE);
+
+				return const_cast<BYTE*>(scanner.find(base, size, signature));
+			}
+
+
+			size_t findAllSigAddresses(const void* base, size_t size, const Signature& signature, tMatchCallback callback, void* pArg) {
+				hax::in::MemorySource source;
+				SigScanner scanner(&source, IN_CHUNK_SIZE);
+
+				return scanner.findAll(base, size, signature, callback, pArg);
+			}
+
+
+			size_t findAllSigAddresses(const void* base, size_t size, const Signature& signature, void* addresses[], size_t limit) {
+
+				if (!addresses || !limit) return 0u;
+
+				AddressSink sink{ addresses, limit, 0u };
+				findAllSigAddresses(base, size, signature, storeAddress, &sink);
+
+				return sink.count;
+			}
+
+
+			DWORD findSigRva(HMODULE hMod, const Signature& signature, DWORD sectionTypes) {
+				hax::in::MemorySource source;
+				ModuleScanner scanner(&source);
+
+				if (!scanner.setModule(hMod)) return 0ul;
+
+				return scanner.findSigRva(signature, sectionTypes);
+			}
+
+
+			bool findSigAddresses(const void* base, size_t size, const char* const signatures[], void* addresses[], size_t count) {
+
+				for (size_t i = 0u; i < count; i++) {
+					addresses[i] = nullptr;
+				}
+
+				PackedSignatures packed{};
+
+				if (!packSignatures(signatures, count, &packed)) return false;
+
+				hax::in::MemorySource source;
+				SigScanner scanner(&source, IN_CHUNK_SIZE);
+				const size_t found = scanner.findEach(base, size, packed.bytes, packed.masks, packed.sizes, addresses, count);
+
+				freePackedSignatures(&packed);
+
+				return found == count;
+			}
+
+
 			template <typename LE>
 			bool unlinkListEntry(LE listEntry) {
 
@@ -693,83 +960,759 @@ namespace hax {
 		}
 
 
-		#ifdef _WIN64
-
-		static void getNearAddressRange(const void* pBase, AddressRange* pAddrRange) {
-			SYSTEM_INFO sysInfo{};
-			GetSystemInfo(&sysInfo);
-
-			pAddrRange->pageSize = sysInfo.dwPageSize;
-			// start at the beginning of the page where pBase is located
-			pAddrRange->start = reinterpret_cast<uintptr_t>(pBase) - (reinterpret_cast<uintptr_t>(pBase) % pAddrRange->pageSize);
-
-			const uintptr_t range = INT32_MAX;
-			// checks int underflow
-			const uintptr_t minAddress = (pAddrRange->start > range) ? pAddrRange->start - range : 0u;
-			// checks int overflow
-			const uintptr_t maxAddress = (UINTPTR_MAX - pAddrRange->start > range) ? pAddrRange->start + range : UINTPTR_MAX;
+		// rough estimate of how common a byte is in x86/x64 code and data, higher values are more common
+		static int getByteCommonness(BYTE b) {
+
+			switch (b) {
+			case 0x00:
+
+				return 8;
+			case 0xFF:
+			case 0xCC:
+
+				return 6;
+			case 0x48:
+			case 0x89:
+			case 0x8B:
+			case 0x90:
+
+				return 5;
+			case 0x01:
+			case 0x0F:
+			case 0x24:
+			case 0x44:
+			case 0x4C:
+			case 0x83:
+			case 0x8D:
+			case 0xC3:
+			case 0xE8:
+
+				return 4;
+			case 0x04:
+			case 0x08:
+			case 0x10:
+			case 0x20:
+			case 0x40:
+			case 0x45:
+			case 0x49:
+			case 0x74:
+			case 0x75:
+			case 0x80:
+			case 0x85:
+			case 0xC0:
+			case 0xC7:
+			case 0xE9:
+
+				return 3;
+			default:
+
+				return b < 0x20 ? 2 : 1;
+			}
 
-			pAddrRange->min = max(minAddress, reinterpret_cast<uintptr_t>(sysInfo.lpMinimumApplicationAddress));
-			pAddrRange->max = min(maxAddress, reinterpret_cast<uintptr_t>(sysInfo.lpMaximumApplicationAddress));
 		}
 
-		#endif // _WIN64		
 
+		static void planScan(const BYTE* bytes, const BYTE* mask, size_t size, ScanPlan* pPlan) {
+			pPlan->bytes = bytes;
+			pPlan->mask = mask;
+			pPlan->size = size;
+			pPlan->anchor = SIZE_MAX;
+			pPlan->secondAnchor = SIZE_MAX;
 
-		namespace helper {
-
-			bool bytestringToInt(const char* charSig, int* intSig, size_t sigSize) {
-
-				// checks for format "DE AD" by character count and asserts the correct size
-				if (!((strlen(charSig) + 1) % 3 == 0) || ((strlen(charSig) + 1) / 3 != sigSize)) return false;
+			int anchorCommonness = INT32_MAX;
+			int secondAnchorCommonness = INT32_MAX;
 
-				const char* cur = charSig;
+			for (size_t i = 0u; i < size; i++) {
 
-				for (size_t i = 0u; i < sigSize; i++) {
+				// only fully masked bytes can be searched for directly
+				if (mask[i] != 0xFF) continue;
 
-					if (*cur == '?') {
-						// wildcard gets converted to -1
-						intSig[i] = -1;
-						cur += 3;
-					}
-					else {
-						const int BASE = 0x10;
-						intSig[i] = strtoul(cur, const_cast<char**>(&cur), BASE);
-						cur++;
-					}
+				const int commonness = getByteCommonness(bytes[i]);
 
+				if (commonness < anchorCommonness) {
+					pPlan->secondAnchor = pPlan->anchor;
+					secondAnchorCommonness = anchorCommonness;
+					pPlan->anchor = i;
+					anchorCommonness = commonness;
+				}
+				else if (commonness < secondAnchorCommonness) {
+					pPlan->secondAnchor = i;
+					secondAnchorCommonness = commonness;
 				}
 
-				return true;
+			}
+
+			if (pPlan->secondAnchor == SIZE_MAX) {
+				pPlan->secondAnchor = pPlan->anchor;
+			}
+
+			return;
+		}
+
+
+		static bool matchesAt(const BYTE* address, const ScanPlan* pPlan) {
+
+			for (size_t i = 0u; i < pPlan->size; i++) {
+
+				if ((address[i] ^ pPlan->bytes[i]) & pPlan->mask[i]) return false;
+
+			}
+
+			return true;
+		}
+
+
+		static const BYTE* scanBuffer(const BYTE* base, size_t size, const ScanPlan* pPlan) {
+
+			if (pPlan->size > size) return nullptr;
+
+			// amount of positions the signature can start at
+			const size_t positions = size - pPlan->size + 1u;
+
+			// a signature of only wildcards matches anywhere
+			if (pPlan->anchor == SIZE_MAX) return base;
+
+			switch (getSimdLevel()) {
+			case SIMD_AVX2:
+
+				return scanAvx2(base, positions, pPlan);
+			case SIMD_SSE2:
+
+				return scanSse2(base, positions, pPlan);
+			default:
+
+				return scanScalar(base, 0u, positions, pPlan);
+			}
+
+		}
+
+
+		static size_t scanBufferAll(const BYTE* base, size_t size, const ScanPlan* pPlan, tMatchCallback callback, void* pArg) {
+			size_t count = 0u;
+			size_t offset = 0u;
+
+			// the vectorized search restarts right behind every match
+			while (offset < size) {
+				const BYTE* const match = scanBuffer(base + offset, size - offset, pPlan);
+
+				if (!match) break;
+
+				count++;
+
+				if (!callback(const_cast<BYTE*>(match), pArg)) break;
+
+				offset = match - base + 1u;
+			}
+
+			return count;
+		}
+
+
+		static bool storeAddress(void* address, void* pArg) {
+			AddressSink* const pSink = reinterpret_cast<AddressSink*>(pArg);
+			pSink->addresses[pSink->count] = address;
+			pSink->count++;
+
+			return pSink->count < pSink->limit;
+		}
+
+
+		static const BYTE* scanScalar(const BYTE* base, size_t begin, size_t end, const ScanPlan* pPlan) {
+
+			const BYTE first = pPlan->bytes[pPlan->anchor];
+			const BYTE second = pPlan->bytes[pPlan->secondAnchor];
+
+			for (size_t i = begin; i < end; i++) {
+
+				if (base[i + pPlan->anchor] != first || base[i + pPlan->secondAnchor] != second) continue;
+
+				if (matchesAt(base + i, pPlan)) return base + i;
+
+			}
+
+			return nullptr;
+		}
+
+
+		static const BYTE* scanSse2(const BYTE* base, size_t positions, const ScanPlan* pPlan) {
+			const __m128i first = _mm_set1_epi8(static_cast<char>(pPlan->bytes[pPlan->anchor]));
+			const __m128i second = _mm_set1_epi8(static_cast<char>(pPlan->bytes[pPlan->secondAnchor]));
+
+			size_t i = 0u;
+
+			// compares the anchor bytes of 16 positions at once and only verifies the positions where both anchors match
+			for (; i + sizeof(__m128i) <= positions; i += sizeof(__m128i)) {
+				const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i + pPlan->anchor));
+				const __m128i blockSecond = _mm_loadu_si128(reinterpret_cast<const __m128i*>(base + i + pPlan->secondAnchor));
+				const __m128i hits = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockSecond, second));
+				uint32_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+
+				while (candidates) {
+					unsigned long bit = 0ul;
+					_BitScanForward(&bit, candidates);
+
+					if (matchesAt(base + i + bit, pPlan)) return base + i + bit;
+
+					candidates &= candidates - 1u;
+				}
+
+			}
+
+			return scanScalar(base, i, positions, pPlan);
+		}
+
+
+		static const BYTE* scanAvx2(const BYTE* base, size_t positions, const ScanPlan* pPlan) {
+			const __m256i first = _mm256_set1_epi8(static_cast<char>(pPlan->bytes[pPlan->anchor]));
+			const __m256i second = _mm256_set1_epi8(static_cast<char>(pPlan->bytes[pPlan->secondAnchor]));
+
+			size_t i = 0u;
+
+			// compares the anchor bytes of 32 positions at once and only verifies the positions where both anchors match
+			for (; i + sizeof(__m256i) <= positions; i += sizeof(__m256i)) {
+				const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i + pPlan->anchor));
+				const __m256i blockSecond = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i + pPlan->secondAnchor));
+				const __m256i hits = _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockSecond, second));
+				uint32_t candidates = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+
+				while (candidates) {
+					unsigned long bit = 0ul;
+					_BitScanForward(&bit, candidates);
+
+					if (matchesAt(base + i + bit, pPlan)) return base + i + bit;
+
+					candidates &= candidates - 1u;
+				}
+
+			}
+
+			// the remaining positions are handled by the narrower implementation
+			const BYTE* const address = scanSse2(base + i, positions - i, pPlan);
+
+			return address;
+		}
+
+
+		// state of a scan for multiple signatures within one buffer
+		typedef struct MultiScan {
+			const BYTE* base;
+			size_t size;
+			const ScanPlan* plans;
+			// indices of the pending signatures sorted by their anchor byte
+			const size_t* order;
+			// range of the order array for every anchor byte
+			size_t bucketBegin[0x101];
+			void** addresses;
+			size_t pending;
+		}MultiScan;
+
+
+		// verifies all signatures with the anchor byte at a position of the buffer
+		static void checkAnchorPosition(MultiScan* pScan, size_t position) {
+			const BYTE value = pScan->base[position];
+
+			for (size_t i = pScan->bucketBegin[value]; i < pScan->bucketBegin[value + 1u]; i++) {
+				const size_t index = pScan->order[i];
+				const ScanPlan* const pPlan = &pScan->plans[index];
+
+				// already found at a lower address
+				if (pScan->addresses[index]) continue;
+
+				if (position < pPlan->anchor) continue;
+
+				const size_t start = position - pPlan->anchor;
+
+				if (start + pPlan->size > pScan->size) continue;
+
+				if (!matchesAt(pScan->base + start, pPlan)) continue;
+
+				pScan->addresses[index] = const_cast<BYTE*>(pScan->base + start);
+				pScan->pending--;
+			}
+
+			return;
+		}
+
+
+		static void scanAnchorsScalar(MultiScan* pScan, size_t begin) {
+
+			for (size_t i = begin; i < pScan->size && pScan->pending; i++) {
+				const BYTE value = pScan->base[i];
+
+				if (pScan->bucketBegin[value] == pScan->bucketBegin[value + 1u]) continue;
+
+				checkAnchorPosition(pScan, i);
+			}
+
+			return;
+		}
+
+
+		static void scanAnchorsSse2(MultiScan* pScan, const BYTE anchors[], size_t anchorCount) {
+			__m128i needles[8]{};
+
+			for (size_t i = 0u; i < anchorCount; i++) {
+				needles[i] = _mm_set1_epi8(static_cast<char>(anchors[i]));
+			}
+
+			size_t i = 0u;
+
+			// compares 16 bytes at once against all distinct anchor bytes
+			for (; i + sizeof(__m128i) <= pScan->size && pScan->pending; i += sizeof(__m128i)) {
+				const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pScan->base + i));
+				__m128i hits = _mm_setzero_si128();
+
+				for (size_t j = 0u; j < anchorCount; j++) {
+					hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, needles[j]));
+				}
+
+				uint32_t candidates = static_cast<uint32_t>(_mm_movemask_epi8(hits));
+
+				while (candidates && pScan->pending) {
+					unsigned long bit = 0ul;
+					_BitScanForward(&bit, candidates);
+					checkAnchorPosition(pScan, i + bit);
+					candidates &= candidates - 1u;
+				}
+
+			}
+
+			scanAnchorsScalar(pScan, i);
+
+			return;
+		}
+
+
+		static bool packSignatures(const char* const signatures[], size_t count, PackedSignatures* pPacked) {
+
+			if (!signatures || !count) return false;
+
+			size_t totalSize = 0u;
+			size_t maxSize = 0u;
+
+			for (size_t i = 0u; i < count; i++) {
+
+				if (!signatures[i]) return false;
+
+				// size of byte string signature of format "DE AD"
+				const size_t sigSize = (strlen(signatures[i]) + 1u) / 3u;
+				totalSize += sigSize;
+
+				if (sigSize > maxSize) {
+					maxSize = sigSize;
+				}
+
+			}
+
+			pPacked->buffer = new BYTE[2u * totalSize]{};
+			pPacked->bytes = new const BYTE*[count]{};
+			pPacked->masks = new const BYTE*[count]{};
+			pPacked->sizes = new size_t[count]{};
+
+			int* const sig = new int[maxSize]{};
+			BYTE* pCurBytes = pPacked->buffer;
+			BYTE* pCurMask = pPacked->buffer + totalSize;
+
+			for (size_t i = 0u; i < count; i++) {
+				const size_t sigSize = (strlen(signatures[i]) + 1u) / 3u;
+
+				if (!sigSize || !helper::bytestringToInt(signatures[i], sig, sigSize)) {
+					delete[] sig;
+					freePackedSignatures(pPacked);
+
+					return false;
+				}
+
+				for (size_t j = 0u; j < sigSize; j++) {
+					// -1 acts as wildcard
+					pCurBytes[j] = sig[j] == -1 ? 0x00 : static_cast<BYTE>(sig[j]);
+					pCurMask[j] = sig[j] == -1 ? 0x00 : 0xFF;
+				}
+
+				pPacked->bytes[i] = pCurBytes;
+				pPacked->masks[i] = pCurMask;
+				pPacked->sizes[i] = sigSize;
+				pCurBytes += sigSize;
+				pCurMask += sigSize;
+			}
+
+			delete[] sig;
+
+			return true;
+		}
+
+
+		static void freePackedSignatures(PackedSignatures* pPacked) {
+			delete[] pPacked->buffer;
+			delete[] pPacked->bytes;
+			delete[] pPacked->masks;
+			delete[] pPacked->sizes;
+
+			pPacked->buffer = nullptr;
+			pPacked->bytes = nullptr;
+			pPacked->masks = nullptr;
+			pPacked->sizes = nullptr;
+
+			return;
+		}
+
+
+		static SimdLevel detectSimdLevel() {
+			int cpuInfo[4]{};
+			__cpuid(cpuInfo, 0);
+			const int maxLeaf = cpuInfo[0];
+
+			__cpuid(cpuInfo, 1);
+
+			constexpr int SSE2_BIT = 1 << 26;
+			constexpr int OSXSAVE_BIT = 1 << 27;
+			constexpr int AVX_BIT = 1 << 28;
+
+			if (!(cpuInfo[3] & SSE2_BIT)) return SIMD_NONE;
+
+			if (maxLeaf < 7 || !(cpuInfo[2] & OSXSAVE_BIT) || !(cpuInfo[2] & AVX_BIT)) return SIMD_SSE2;
+
+			// the os has to save the ymm registers on context switches
+			constexpr unsigned long long XMM_YMM_STATE = 0x6ull;
+
+			if ((_xgetbv(0) & XMM_YMM_STATE) != XMM_YMM_STATE) return SIMD_SSE2;
+
+			__cpuidex(cpuInfo, 7, 0);
+
+			constexpr int AVX2_BIT = 1 << 5;
+
+			return (cpuInfo[1] & AVX2_BIT) ? SIMD_AVX2 : SIMD_SSE2;
+		}
+
+
+		static SimdLevel getSimdLevel() {
+			// cpu features do not change at runtime so they are only queried once
+			static const SimdLevel simdLevel = detectSimdLevel();
+
+			return simdLevel;
+		}
+
+
+		template <typename C>
+		static bool copyStringChunked(IMemorySource* pSource, C* dst, const void* src, size_t size) {
+
+			if (!pSource || !dst) return false;
+
+			const BYTE* cur = reinterpret_cast<const BYTE*>(src);
+			size_t copied = 0u;
+
+			while (copied < size) {
+				const size_t pageLeft = STRING_PAGE_SIZE - (reinterpret_cast<uintptr_t>(cur) & (STRING_PAGE_SIZE - 1u));
+				// a character that crosses the page boundary is read on its own
+				size_t count = pageLeft >= sizeof(C) ? pageLeft / sizeof(C) : 1u;
+
+				if (count > size - copied) {
+					count = size - copied;
+				}
+
+				if (!pSource->read(cur, dst + copied, count * sizeof(C))) return false;
+
+				// end of string
+				if (getStringLength(dst + copied, count) < count) return true;
+
+				copied += count;
+				cur += count * sizeof(C);
+			}
+
+			// did not contain a null charater so something went wrong
+			return false;
+		}
+
+
+		template <typename C>
+		static size_t getStringLength(const C* str, size_t maxLength) {
+			size_t length = 0u;
+
+			if (sizeof(C) <= sizeof(uint16_t)) {
+				constexpr size_t CHARS_PER_VECTOR = sizeof(__m128i) / sizeof(C);
+				const __m128i zero = _mm_setzero_si128();
+
+				for (; length + CHARS_PER_VECTOR <= maxLength; length += CHARS_PER_VECTOR) {
+					const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + length));
+					const __m128i nulls = sizeof(C) == sizeof(char) ? _mm_cmpeq_epi8(chars, zero) : _mm_cmpeq_epi16(chars, zero);
+					const uint32_t nullMask = static_cast<uint32_t>(_mm_movemask_epi8(nulls));
+
+					if (nullMask) {
+						unsigned long bit = 0ul;
+						_BitScanForward(&bit, nullMask);
+
+						return length + bit / sizeof(C);
+					}
+
+				}
+
+			}
+
+			while (length < maxLength && str[length]) {
+				length++;
+			}
+
+			return length;
+		}
+
+
+		static bool assembleRelJump(BYTE* buffer, size_t size, const void* address, const void* target) {
+
+			if (size < sizeof(X86_JUMP)) return false;
+
+			const intptr_t offset = reinterpret_cast<intptr_t>(target) - reinterpret_cast<intptr_t>(address) - static_cast<intptr_t>(sizeof(X86_JUMP));
+
+			#ifdef _WIN64
+
+			// checks if the target is reachable by a relative jump
+			if (offset < INT32_MIN || offset > INT32_MAX) return false;
+
+			#endif // _WIN64
+
+			const int32_t jumpOffset = static_cast<int32_t>(offset);
+
+			memset(buffer, NOP, size);
+			memcpy(buffer, X86_JUMP, sizeof(X86_JUMP));
+			memcpy(buffer + 1u, &jumpOffset, sizeof(jumpOffset));
+
+			return true;
+		}
+
+
+		static void freeGateway(HANDLE hProc, void* gateway, GatewayPool* pPool) {
+
+			if (pPool) {
+				pPool->free(gateway);
+			}
+			else {
+				VirtualFreeEx(hProc, gateway, 0, MEM_RELEASE);
+			}
+
+			return;
+		}
+
+
+		static void freeGateway(void* gateway, GatewayPool* pPool) {
+
+			if (pPool) {
+				pPool->free(gateway);
+			}
+			else {
+				VirtualFree(gateway, 0, MEM_RELEASE);
+			}
+
+			return;
+		}
+
+
+		namespace helper {
+
+			bool bytestringToInt(const char* charSig, int* intSig, size_t sigSize) {
+
+				// checks for format "DE AD" by character count and asserts the correct size
+				if (!((strlen(charSig) + 1) % 3 == 0) || ((strlen(charSig) + 1) / 3 != sigSize)) return false;
+
+				const char* cur = charSig;
+
+				for (size_t i = 0u; i < sigSize; i++) {
+
+					if (*cur == '?') {
+						// wildcard gets converted to -1
+						intSig[i] = -1;
+						cur += 3;
+					}
+					else {
+						const int BASE = 0x10;
+						intSig[i] = strtoul(cur, const_cast<char**>(&cur), BASE);
+						cur++;
+					}
+
+				}
+
+				return true;
 			}
 
 
 			void* findSignature(const void* base, size_t size, const int* signature, size_t sigSize) {
-				BYTE* address = nullptr;
+				// signatures are usually short enough to be packed on the stack
+				constexpr size_t STACK_SIG_SIZE = 0x100u;
+				BYTE stackBytes[STACK_SIG_SIZE]{};
+				BYTE stackMask[STACK_SIG_SIZE]{};
+				BYTE* bytes = stackBytes;
+				BYTE* mask = stackMask;
+
+				if (sigSize > STACK_SIG_SIZE) {
+					bytes = new BYTE[sigSize]{};
+					mask = new BYTE[sigSize]{};
+				}
+
+				for (size_t i = 0u; i < sigSize; i++) {
+
+					// -1 acts as wildcard
+					if (signature[i] == -1) {
+						bytes[i] = 0x00;
+						mask[i] = 0x00;
+					}
+					else {
+						bytes[i] = static_cast<BYTE>(signature[i]);
+						mask[i] = 0xFF;
+					}
+
+				}
+
+				void* const address = findSignature(base, size, bytes, mask, sigSize);
+
+				if (bytes != stackBytes) {
+					delete[] bytes;
+					delete[] mask;
+				}
+
+				return address;
+			}
+
+
+			void* findSignature(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize) {
+
+				if (!base || !bytes || !mask || !sigSize) return nullptr;
 
-				// loop over the memory to be searched
-				for (size_t i = 0u; i < size - sigSize; i++) {
-					bool found = true;
+				ScanPlan plan{};
+				planScan(bytes, mask, sigSize, &plan);
+
+				return const_cast<BYTE*>(scanBuffer(reinterpret_cast<const BYTE*>(base), size, &plan));
+			}
+
+
+			void* findSignature(const void* base, size_t size, const Signature& signature) {
+
+				if (!base || !signature.valid()) return nullptr;
+
+				ScanPlan plan{};
+				planScan(signature.bytes(), signature.mask(), signature.size(), &plan);
+
+				return const_cast<BYTE*>(scanBuffer(reinterpret_cast<const BYTE*>(base), size, &plan));
+			}
+
+
+			size_t findAllSignatures(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize, tMatchCallback callback, void* pArg) {
+
+				if (!base || !bytes || !mask || !sigSize || !callback) return 0u;
+
+				ScanPlan plan{};
+				planScan(bytes, mask, sigSize, &plan);
+
+				return scanBufferAll(reinterpret_cast<const BYTE*>(base), size, &plan, callback, pArg);
+			}
+
+
+			size_t findAllSignatures(const void* base, size_t size, const Signature& signature, tMatchCallback callback, void* pArg) {
+
+				if (!base || !signature.valid() || !callback) return 0u;
+
+				ScanPlan plan{};
+				planScan(signature.bytes(), signature.mask(), signature.size(), &plan);
+
+				return scanBufferAll(reinterpret_cast<const BYTE*>(base), size, &plan, callback, pArg);
+			}
 
-					// loop over signature at every position in memory to be searched
-					for (size_t j = 0u; j < sigSize; j++) {
 
-						// -1 acts as wildcard
-						if (reinterpret_cast<const BYTE*>(base)[i + j] != signature[j] && signature[j] != -1) {
-							found = false;
-							break;
+			size_t findSignatures(const void* base, size_t size, const BYTE* const bytes[], const BYTE* const masks[], const size_t sigSizes[], void* addresses[], size_t count) {
+
+				if (!base || !bytes || !masks || !sigSizes || !addresses || !count) return 0u;
+
+				ScanPlan* const plans = new ScanPlan[count]{};
+				size_t* const order = new size_t[count]{};
+
+				MultiScan scan{};
+				scan.base = reinterpret_cast<const BYTE*>(base);
+				scan.size = size;
+				scan.plans = plans;
+				scan.order = order;
+				scan.addresses = addresses;
+
+				size_t found = 0u;
+				// amount of pending signatures per anchor byte
+				size_t bucketSizes[0x100]{};
+
+				for (size_t i = 0u; i < count; i++) {
+
+					if (addresses[i] || !sigSizes[i] || sigSizes[i] > size) continue;
+
+					planScan(bytes[i], masks[i], sigSizes[i], &plans[i]);
+
+					// a signature of only wildcards matches anywhere
+					if (plans[i].anchor == SIZE_MAX) {
+						addresses[i] = const_cast<BYTE*>(scan.base);
+						found++;
+
+						continue;
+					}
+
+					bucketSizes[plans[i].bytes[plans[i].anchor]]++;
+					scan.pending++;
+				}
+
+				// distinct anchor bytes for the vectorized search
+				BYTE anchors[8]{};
+				size_t anchorCount = 0u;
+
+				for (size_t i = 0u; i < 0x100u; i++) {
+					scan.bucketBegin[i + 1u] = scan.bucketBegin[i] + bucketSizes[i];
+
+					if (bucketSizes[i]) {
+
+						if (anchorCount < _countof(anchors)) {
+							anchors[anchorCount] = static_cast<BYTE>(i);
 						}
 
+						anchorCount++;
 					}
 
-					if (found) {
-						address = const_cast<BYTE*>(reinterpret_cast<const BYTE*>(base) + i);
-						break;
+				}
+
+				// sort the pending signatures into the buckets of their anchor bytes
+				size_t bucketFill[0x100]{};
+
+				for (size_t i = 0u; i < count; i++) {
+
+					if (addresses[i] || !sigSizes[i] || sigSizes[i] > size) continue;
+
+					const BYTE anchor = plans[i].bytes[plans[i].anchor];
+					order[scan.bucketBegin[anchor] + bucketFill[anchor]] = i;
+					bucketFill[anchor]++;
+				}
+
+				const size_t pending = scan.pending;
+
+				if (pending) {
+
+					// comparing against many different anchor bytes is slower than a table lookup per byte
+					if (anchorCount <= _countof(anchors) && getSimdLevel() != SIMD_NONE) {
+						scanAnchorsSse2(&scan, anchors, anchorCount);
+					}
+					else {
+						scanAnchorsScalar(&scan, 0u);
 					}
 
 				}
 
-				return address;
+				found += pending - scan.pending;
+
+				delete[] plans;
+				delete[] order;
+
+				return found;
+			}
+
+
+			bool copyString(IMemorySource* pSource, char* dst, const void* src, size_t size) {
+
+				return copyStringChunked(pSource, dst, src, size);
+			}
+
+
+			bool copyString(IMemorySource* pSource, wchar_t* dst, const void* src, size_t size) {
+
+				return copyStringChunked(pSource, dst, src, size);
 			}
 
 		}
@@ -1,4 +1,7 @@
 #pragma once
+#include "Signature.h"
+#include "hooks\GatewayPool.h"
+#include "scan\IMemorySource.h"
 #include <Windows.h>
 
 // Functions to interact with the virtual memory of a windows process.
@@ -25,6 +28,43 @@ namespace hax {
 
 	namespace mem {
 
+		// Called for every match of a find-all signature scan in ascending order of the addresses.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address of the match. For scans of external processes within the virtual address space of the target process.
+		// 
+		// [in] pArg:
+		// The argument passed to the scan.
+		// 
+		// Return:
+		// True to continue the scan, false to stop it.
+		typedef bool (*tMatchCallback)(void* address, void* pArg);
+
+		// Types of module sections that are scanned by module scoped scans. Can be combined.
+		// Discardable sections like .reloc and the section of the resource directory are never scanned.
+		typedef enum SectionType {
+			// executable sections like .text
+			SECTION_CODE = 0x1,
+			// readable data sections that are neither writable nor executable like .rdata, eg. for strings and vtables
+			SECTION_READONLY_DATA = 0x2,
+			// writable data sections that are not executable like .data
+			SECTION_WRITABLE_DATA = 0x4,
+			SECTION_DATA = SECTION_READONLY_DATA | SECTION_WRITABLE_DATA
+		}SectionType;
+
+		// Describes a 32 bit relative operand of an instruction, eg. the displacement of a call or of a RIP-relative memory operand.
+		// The target of the operand is the end of the instruction plus the signed displacement.
+		// Example for a match of the signature "48 8B 05 ? ? ? ? 48 85 C0" (mov rax, QWORD PTR[rip + disp32]):
+		// const hax::mem::RelativeOperand operand{ 3u, 7u };
+		typedef struct RelativeOperand {
+			// offset of the displacement from the address the operand is resolved at
+			size_t displacementOffset;
+			// offset of the end of the instruction from the address the operand is resolved at
+			size_t instructionEnd;
+		}RelativeOperand;
+
 		// Functions to interact with the virtual memory of an external process.
 		// Compiled to x64 the external functions are designed to work both on x64 targets as well as x86 targets.
 		// Compiled to x86 interacting with x64 processes is neihter supported nor feasable.
@@ -54,25 +94,43 @@ namespace hax {
 			// [in] size:
 			// Number of bytes that get overwritten by the jump at the beginning of the origin function.
 			// The overwritten instructions get executed by the gateway right before executing the origin function.
-			// Has to be at least five! Only complete instructions should be overwritten!
-			// It is necessary to look at the disassembly of the origin function to determine when the first complete instruction finishes after the first five bytes.
+			// Zero to determine the size of the whole instructions covering the first five bytes by disassembling the origin function. Otherwise it has to be at least five and only complete instructions should be overwritten.
 			// 
 			// [in] relativeAddressOffset:
-			// The offset of a relative Address if there is one in the first <size> bytes of the origin function.
-			// It is necessary to look at the disassembly of the origin function to determine if there is a relative address in the first <size> bytes.
-			// If there is no relative address in the first <size> bytes of the origin function the default value of SIZE_MAX should be passed. This value will then be ignored.
+			// The offset of a relative address if there is one in the first <size> bytes of the origin function. Only this address is corrected and the bytes are copied as they are.
+			// If the default value of SIZE_MAX is passed the overwritten instructions are disassembled and all relative branches and RIP-relative operands are relocated to the gateway.
+			// Short branches are widened to 32 bit offsets then. Fails if an instruction can not be decoded, is a loop or jcxz or branches back into the overwritten bytes.
 			//
+			// [in] pPool:
+			// Pool the gateway is allocated from. It has to allocate in the address space of the target process. Nullptr to allocate a separate memory region for the gateway.
+			// 
 			// Return:
 			// Pointer to the gateway within the virtual address space of the target process or nullptr on failure (eg because of architecture incompatibility)
 			// This address is called by the detour function at the address given by originCall.
 			// The stolen bytes of the orgin function are located here.
-			// Call VirtualFreeEx on the return value to free the memory in the target process.
-			void* trampHook(HANDLE hProc, void* origin, void* detour, size_t originCallOffset, size_t size, size_t relativeAddressOffset = SIZE_MAX);
+			// Call VirtualFreeEx on the return value to free the memory in the target process or GatewayPool::free if it was allocated from a pool.
+			void* trampHook(HANDLE hProc, void* origin, void* detour, size_t originCallOffset, size_t size, size_t relativeAddressOffset = SIZE_MAX, GatewayPool* pPool = nullptr);
+
+			// Gets the number of bytes of the whole instructions at the beginning of a function within the virtual address space of an external process that are overwritten by a trampoline hook.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_QUERY_LIMITED_INFORMATION and PROCESS_VM_READ access rights.
+			// 
+			// [in] origin:
+			// Address of the function within the virtual address space of the target process.
+			// 
+			// Return:
+			// The number of bytes or zero if the instructions could not be read or decoded.
+			size_t getStolenSize(HANDLE hProc, const void* origin);
 
 			#ifdef _WIN64
 
 			// Allocates memory in the virtual address space of an external process that is reachable by a relative jump (op code: E9) from a given address.
 			// Reserves and commits the memory pages with PAGE_EXECUTE_READWRITE protection.
+			// The free regions around the address are walked once and the memory is placed in the nearest one that fits, see GatewayPool::allocateNear.
 			// Only neccessary for x64 target processes because the whole x86 address space can be reached by a relative jump.
 			// The Win32 APIs VirtualAllocEx can be used as an alternative for x86.
 			// 
@@ -80,7 +138,7 @@ namespace hax {
 			// 
 			// [in] hProc:
 			// Handle to the target process.
-			// Needs at least PROCESS_VM_OPERATION access rights.
+			// Needs at least PROCESS_QUERY_INFORMATION and PROCESS_VM_OPERATION access rights.
 			// 
 			// [in] address:
 			// The address within the virtual address space of the target process from which the allocated memory should be reachable by a relative jump (op code: E9).
@@ -204,6 +262,7 @@ namespace hax {
 			void* getVirtualFunction(HANDLE hProc, const void* pInterface, size_t index);
 
 			// Gets the address pointed to by a multi level pointer within the virtual address space of an external process.
+			// Every level is a separate read. To resolve many chains at once the PointerResolver class of "scan\PointerResolver.h" can be used instead.
 			// 
 			// Parameters:
 			// 
@@ -225,6 +284,29 @@ namespace hax {
 			// Example: *(*(*(base + offset[0]) + offset[1]) + offset[2])
 			void* getMultiLevelPointer(HANDLE hProc, const void* base, const size_t* offsets, size_t size);
 
+			// Resolves a chain of relative operands within the virtual address space of an external process.
+			// Every operand is resolved at the target of the previous one, eg. a call to a thunk that jumps to the actual function.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_VM_READ access rights.
+			// 
+			// [in] address:
+			// The address the first operand is resolved at, typically the address of a signature match.
+			// 
+			// [in] operands:
+			// Buffer for the operands.
+			// 
+			// [in] count:
+			// Amount of operands in the buffer.
+			// 
+			// Return:
+			// The target of the last operand or nullpointer on failure.
+			// Example: target = address + operands[0].instructionEnd + *(int32_t*)(address + operands[0].displacementOffset)
+			void* resolveRelative(HANDLE hProc, const void* address, const RelativeOperand* operands, size_t count);
+
 			// Finds the address of a byte signature within the virtual address space of an external process.
 			// 
 			// Parameters:
@@ -249,8 +331,137 @@ namespace hax {
 			// Nullpointer if the signature was not found or the function failed.
 			void* findSigAddress(HANDLE hProc, const void* base, size_t size, const char* signature);
 
+			// Finds the address of a parsed byte signature within the virtual address space of an external process.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_QUERY_INFORMATION, PROCESS_VM_OPERATION and PROCESS_VM_READ access rights.
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// Return:
+			// The address where the byte signature was found within the virtual address space of the target process.
+			// Nullpointer if the signature was not found, the signature is invalid or the function failed.
+			void* findSigAddress(HANDLE hProc, const void* base, size_t size, const Signature& signature);
+
+			// Finds all addresses of a byte signature within the virtual address space of an external process.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_QUERY_INFORMATION, PROCESS_VM_OPERATION and PROCESS_VM_READ access rights.
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// [in] callback:
+			// Called for every match in ascending order of the addresses until it returns false.
+			// 
+			// [in] pArg:
+			// Argument passed to the callback.
+			// 
+			// Return:
+			// The number of matches passed to the callback.
+			size_t findAllSigAddresses(HANDLE hProc, const void* base, size_t size, const Signature& signature, tMatchCallback callback, void* pArg);
+
+			// Finds all addresses of a byte signature within the virtual address space of an external process.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_QUERY_INFORMATION, PROCESS_VM_OPERATION and PROCESS_VM_READ access rights.
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// [out] addresses:
+			// Buffer that receives the addresses of the matches within the virtual address space of the target process in ascending order.
+			// 
+			// [in] limit:
+			// Capacity of the addresses buffer. The scan stops when the buffer is full.
+			// 
+			// Return:
+			// The number of addresses written to the buffer.
+			size_t findAllSigAddresses(HANDLE hProc, const void* base, size_t size, const Signature& signature, void* addresses[], size_t limit);
+
+			// Finds a byte signature within the sections of a module of an external process. Only sections of the requested types are scanned.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_QUERY_INFORMATION, PROCESS_VM_OPERATION and PROCESS_VM_READ access rights.
+			// 
+			// [in] hMod:
+			// Handle to the module within the virtual address space of the target process.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// [in] sectionTypes:
+			// Combination of SectionType values of the sections that are scanned.
+			// 
+			// Return:
+			// The relative virtual address of the match within the module. Zero if the signature was not found or the function failed.
+			DWORD findSigRva(HANDLE hProc, HMODULE hMod, const Signature& signature, DWORD sectionTypes = SECTION_CODE);
+
+			// Finds the addresses of multiple byte signatures within the virtual address space of an external process.
+			// The memory is read in chunks through a SigScanner and every chunk is only scanned once for all signatures. Signatures that cross region boundaries are found as well.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_QUERY_INFORMATION, PROCESS_VM_OPERATION and PROCESS_VM_READ access rights.
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signatures:
+			// Array of byte signatures base hex that should be looked for as null terminated strings.
+			// Bytes have to be two characters and separeted by spaces. "??" can be used as wildcards.
+			// Example: "DE AD ?? EF"
+			// 
+			// [out] addresses:
+			// Array that receives the addresses where the byte signatures were found within the virtual address space of the target process.
+			// Entries of signatures that were not found are set to nullptr.
+			// 
+			// [in] count:
+			// Number of entries of the signatures and the addresses array.
+			// 
+			// Return:
+			// True if all signatures were found, false if at least one signature was not found or the function failed.
+			bool findSigAddresses(HANDLE hProc, const void* base, size_t size, const char* const signatures[], void* addresses[], size_t count);
+
 			// Copies a nullterminated string from an external process to a buffer allocated in the virtual memory of the caller process.
 			// Copies characters until a null character is copied or the target buffer is full.
+			// The string is read in chunks that end at page boundaries, so characters after the null character may be copied to the buffer as well.
 			// 
 			// Parameters:
 			// 
@@ -271,6 +482,29 @@ namespace hax {
 			// True on success, false on failure or if no null char was copied.
 			bool copyRemoteString(HANDLE hProc, char* dst, const void* src, size_t size);
 
+			// Copies a nullterminated wide string from an external process to a buffer allocated in the virtual memory of the caller process.
+			// Copies characters until a null character is copied or the target buffer is full.
+			// The string is read in chunks that end at page boundaries, so characters after the null character may be copied to the buffer as well.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the target process.
+			// Needs at least PROCESS_VM_READ access rights.
+			// 
+			// [out] dst:
+			// Target buffer for the string.
+			// 
+			// [in] src:
+			// Address of the string within the virtual address space of the target buffer.
+			// 
+			// [in] size:
+			// Size of the target buffer in characters. Beware of buffer overflows.
+			// 
+			// Return:
+			// True on success, false on failure or if no null char was copied.
+			bool copyRemoteString(HANDLE hProc, wchar_t* dst, const void* src, size_t size);
+
 			// Unlinks an entry of a Win32 API doubly linked list in an external process.
 			// Found for example in the loader data of the process environment block of a process (see undocWinTypes.h).
 			// 
@@ -320,24 +554,65 @@ namespace hax {
 			// [in] size:
 			// Number of bytes that get overwritten by the jump at the beginning of the origin function.
 			// The overwritten instructions get executed by the gateway right before executing the origin function.
-			// Has to be at least five! Only complete instructions should be overwritten!
-			// It is necessary to look at the disassembly of the origin function to determine when the first complete instruction finishes after the first five bytes.
+			// Zero to determine the size of the whole instructions covering the first five bytes by disassembling the origin function. Otherwise it has to be at least five and only complete instructions should be overwritten.
 			// 
 			// [in] relativeAddressOffset:
-			// The offset of a relative Address if there is one in the first <size> bytes of the origin function.
-			// It is necessary to look at the disassembly of the origin function to determine if there is a relative address in the first <size> bytes.
-			// If there is no relative address in the first <size> bytes of the origin function the default value of SIZE_MAX should be passed. This value will then be ignored.
+			// The offset of a relative address if there is one in the first <size> bytes of the origin function. Only this address is corrected and the bytes are copied as they are.
+			// If the default value of SIZE_MAX is passed the overwritten instructions are disassembled and all relative branches and RIP-relative operands are relocated to the gateway.
+			// Short branches are widened to 32 bit offsets then. Fails if an instruction can not be decoded, is a loop or jcxz or branches back into the overwritten bytes.
+			// 
+			// [in] pPool:
+			// Pool the gateway is allocated from. It has to allocate in the address space of the caller process. Nullptr to allocate a separate memory region for the gateway.
 			// 
 			// Return:
 			// Pointer to the gateway. This address should be called by the detour function with the same calling convention as the origin function.
 			// The stolen bytes of the orgin function are located here.
-			// Call VirtualFree on the return value to free the memory in the process.
-			void* trampHook(void* origin, const void* detour, size_t size, size_t relativeAddressOffset = SIZE_MAX);
+			// Call VirtualFree on the return value to free the memory in the process or GatewayPool::free if it was allocated from a pool.
+			void* trampHook(void* origin, const void* detour, size_t size, size_t relativeAddressOffset = SIZE_MAX, GatewayPool* pPool = nullptr);
+
+			// Prepares a trampoline hook in the caller process without patching the origin function, eg. to patch many hooks at once (see HookTransaction).
+			// The gateway is set up like by trampHook and the jump that has to be written to the origin function is assembled into a buffer.
+			// 
+			// Parameters:
+			// 
+			// [in] origin:
+			// Address of the origin function to be hooked within the virtual address space of the caller process.
+			// 
+			// [in] detour:
+			// Address of the function that should be executed on a call of the origin function within the virtual address space of the caller process.
+			// 
+			// [in] size:
+			// Number of bytes that get overwritten by the jump at the beginning of the origin function. Has to be at least five, see getStolenSize.
+			// 
+			// [in] relativeAddressOffset:
+			// The offset of a relative address if there is one in the first <size> bytes of the origin function or SIZE_MAX to relocate all relative operands, see trampHook.
+			// 
+			// [in] pPool:
+			// Pool the gateway is allocated from or nullptr to allocate a separate memory region for the gateway.
+			// 
+			// [out] jump:
+			// Buffer of <size> bytes that receives the jump padded with nops, which has to be written to the origin function to install the hook.
+			// 
+			// Return:
+			// Pointer to the gateway or nullptr on failure. It is freed like the gateway returned by trampHook.
+			void* prepareTrampHook(void* origin, const void* detour, size_t size, size_t relativeAddressOffset, GatewayPool* pPool, BYTE* jump);
+
+			// Gets the number of bytes of the whole instructions at the beginning of a function within the virtual address space of the caller process that are overwritten by a trampoline hook.
+			// 
+			// Parameters:
+			// 
+			// [in] origin:
+			// Address of the function within the virtual address space of the caller process.
+			// 
+			// Return:
+			// The number of bytes or zero if the instructions could not be decoded.
+			size_t getStolenSize(const void* origin);
 
 			#ifdef _WIN64
 
 			// Allocates memory in the virtual address space of the caller process that is reachable by a relative jump (op code: E9) from a given address.
 			// Reserves and commits the memory pages with PAGE_EXECUTE_READWRITE protection.
+			// The free regions around the address are walked once and the memory is placed in the nearest one that fits, see GatewayPool::allocateNear.
 			// Only neccessary for x64 target processes because the whole x86 address space can be reached by a relative jump.
 			// The Win32 APIs VirtualAllocEx can be used as an alternative for x86.
 			// 
@@ -462,6 +737,25 @@ namespace hax {
 			// Example: *(*(*(base + offset[0]) + offset[1]) + offset[2])
 			void* getMultiLevelPointer(const void* base, const size_t* offsets, size_t size);
 
+			// Resolves a chain of relative operands within the virtual address space of the caller process.
+			// Every operand is resolved at the target of the previous one, eg. a call to a thunk that jumps to the actual function.
+			// 
+			// Parameters:
+			// 
+			// [in] address:
+			// The address the first operand is resolved at, typically the address of a signature match.
+			// 
+			// [in] operands:
+			// Buffer for the operands.
+			// 
+			// [in] count:
+			// Amount of operands in the buffer.
+			// 
+			// Return:
+			// The target of the last operand.
+			// Example: target = address + operands[0].instructionEnd + *(int32_t*)(address + operands[0].displacementOffset)
+			void* resolveRelative(const void* address, const RelativeOperand* operands, size_t count);
+
 			// Finds the address of a byte signature within the virtual address space of the caller process.
 			// 
 			// Parameters:
@@ -482,6 +776,115 @@ namespace hax {
 			// Nullpointer if the signature was not found or the function failed.
 			void* findSigAddress(const void* base, size_t size, const char* signature);
 
+			// Finds the address of a parsed byte signature within the virtual address space of the caller process.
+			// Inaccessible and guarded regions are skipped, matches spanning adjacent readable regions are found.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// Return:
+			// The address where the byte signature was found within the virtual address space of the caller process.
+			// Nullpointer if the signature was not found, the signature is invalid or the function failed.
+			void* findSigAddress(const void* base, size_t size, const Signature& signature);
+
+			// Finds all addresses of a byte signature within the virtual address space of the caller process.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// [in] callback:
+			// Called for every match in ascending order of the addresses until it returns false.
+			// 
+			// [in] pArg:
+			// Argument passed to the callback.
+			// 
+			// Return:
+			// The number of matches passed to the callback.
+			size_t findAllSigAddresses(const void* base, size_t size, const Signature& signature, tMatchCallback callback, void* pArg);
+
+			// Finds all addresses of a byte signature within the virtual address space of the caller process.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// [out] addresses:
+			// Buffer that receives the addresses of the matches in ascending order.
+			// 
+			// [in] limit:
+			// Capacity of the addresses buffer. The scan stops when the buffer is full.
+			// 
+			// Return:
+			// The number of addresses written to the buffer.
+			size_t findAllSigAddresses(const void* base, size_t size, const Signature& signature, void* addresses[], size_t limit);
+
+			// Finds a byte signature within the sections of a module of the caller process. Only sections of the requested types are scanned.
+			// 
+			// Parameters:
+			// 
+			// [in] hMod:
+			// Handle to the module.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// [in] sectionTypes:
+			// Combination of SectionType values of the sections that are scanned.
+			// 
+			// Return:
+			// The relative virtual address of the match within the module. Zero if the signature was not found or the function failed.
+			DWORD findSigRva(HMODULE hMod, const Signature& signature, DWORD sectionTypes = SECTION_CODE);
+
+			// Finds the addresses of multiple byte signatures within the virtual address space of the caller process.
+			// The memory is scanned in place through a SigScanner and only once for all signatures. Signatures that cross region boundaries are found as well.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signatures:
+			// Array of byte signatures base hex that should be looked for as null terminated strings.
+			// Bytes have to be two characters and separeted by spaces. "??" can be used as wildcards.
+			// Example: "DE AD ?? EF"
+			// 
+			// [out] addresses:
+			// Array that receives the addresses where the byte signatures were found within the virtual address space of the caller process.
+			// Entries of signatures that were not found are set to nullptr.
+			// 
+			// [in] count:
+			// Number of entries of the signatures and the addresses array.
+			// 
+			// Return:
+			// True if all signatures were found, false if at least one signature was not found or the function failed.
+			bool findSigAddresses(const void* base, size_t size, const char* const signatures[], void* addresses[], size_t count);
+
 			// Unlinks an entry of a Win32 API doubly linked list in the target process.
 			// Found for example in the loader data of the process environment block of a process (see undocWinDefs.h).
 			// 
@@ -552,6 +955,184 @@ namespace hax {
 			// Nullpointer if the signature was not found.
 			void* findSignature(const void* base, size_t size, const int* signature, size_t sigSize);
 
+			// Finds the address of a byte signature in packed byte and mask form within a single memory region of the caller process.
+			// The memory is first searched for the two rarest non-wildcard bytes of the signature with SSE2 or AVX2 (depending on the capabilities of the CPU).
+			// The whole signature is only compared at positions where both of these bytes match.
+			// Do not use across multiple memory regions. Use findSignatureAddress instead.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched. Should not cross memory region boundries.
+			// 
+			// [in] bytes:
+			// The bytes of the signature. The values at wildcard positions are ignored.
+			// 
+			// [in] mask:
+			// The mask of the signature. 0xFF for bytes that have to match, 0x00 for wildcards.
+			// 
+			// [in] sigSize:
+			// Size of the bytes and the mask buffer.
+			// 
+			// Return:
+			// The address where the byte signature was found within the memory region of the caller process.
+			// Nullpointer if the signature was not found.
+			void* findSignature(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize);
+
+			// Finds a parsed byte signature within a memory range.
+			// Does not allocate any memory.
+			// Do not use across multiple memory regions. Use findSignatureAddress instead.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// Return:
+			// The address where the byte signature was found within the memory range.
+			// Nullpointer if the signature was not found or the signature is invalid.
+			void* findSignature(const void* base, size_t size, const Signature& signature);
+
+			// Finds all occurrences of a byte signature within a memory range.
+			// Do not use across multiple memory regions. Use findAllSigAddresses instead.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] bytes:
+			// Bytes of the signature. Bytes at wildcard positions are ignored.
+			// 
+			// [in] mask:
+			// Mask of the signature. 0xFF if the byte at the position has to match, 0x00 for wildcards.
+			// 
+			// [in] sigSize:
+			// Size of the signature in bytes.
+			// 
+			// [in] callback:
+			// Called for every match in ascending order of the addresses until it returns false.
+			// 
+			// [in] pArg:
+			// Argument passed to the callback.
+			// 
+			// Return:
+			// The number of matches passed to the callback.
+			size_t findAllSignatures(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize, tMatchCallback callback, void* pArg);
+
+			// Finds all occurrences of a parsed byte signature within a memory range.
+			// Do not use across multiple memory regions. Use findAllSigAddresses instead.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched.
+			// 
+			// [in] signature:
+			// The byte signature that should be looked for.
+			// 
+			// [in] callback:
+			// Called for every match in ascending order of the addresses until it returns false.
+			// 
+			// [in] pArg:
+			// Argument passed to the callback.
+			// 
+			// Return:
+			// The number of matches passed to the callback.
+			size_t findAllSignatures(const void* base, size_t size, const Signature& signature, tMatchCallback callback, void* pArg);
+
+			// Finds the addresses of multiple byte signatures in packed byte and mask form within a single memory region of the caller process in one pass.
+			// The signatures are grouped by their rarest non-wildcard byte and the memory is only searched once for all of these bytes.
+			// Can be called for consecutive memory regions with the same addresses array. Signatures that were already found are skipped.
+			// 
+			// Parameters:
+			// 
+			// [in] base:
+			// Address where the search should start.
+			// 
+			// [in] size:
+			// Amount of bytes that should be searched. Should not cross memory region boundries.
+			// 
+			// [in] bytes:
+			// Array of the bytes of the signatures. The values at wildcard positions are ignored.
+			// 
+			// [in] masks:
+			// Array of the masks of the signatures. 0xFF for bytes that have to match, 0x00 for wildcards.
+			// 
+			// [in] sigSizes:
+			// Array of the sizes of the signatures.
+			// 
+			// [in/out] addresses:
+			// Array that receives the addresses where the signatures were found within the memory region of the caller process.
+			// Entries that are not nullptr on input are treated as already found and are not searched for.
+			// Entries of signatures that were not found are left untouched.
+			// 
+			// [in] count:
+			// Number of signatures. All arrays need to have this many entries.
+			// 
+			// Return:
+			// Number of signatures found in the memory region.
+			size_t findSignatures(const void* base, size_t size, const BYTE* const bytes[], const BYTE* const masks[], const size_t sigSizes[], void* addresses[], size_t count);
+
+			// Copies a nullterminated string from a memory source to a buffer.
+			// The string is read in chunks that end at page boundaries and the null character is searched with SSE2, so a string costs one read per page it spans.
+			// Characters after the null character up to the end of a chunk may be copied to the buffer as well.
+			// 
+			// Parameters:
+			// 
+			// [in] pSource:
+			// The memory source the string is read from.
+			// 
+			// [out] dst:
+			// Target buffer for the string.
+			// 
+			// [in] src:
+			// Address of the string within the memory source.
+			// 
+			// [in] size:
+			// Size of the target buffer in characters. Beware of buffer overflows.
+			// 
+			// Return:
+			// True on success, false on failure or if no null char was copied.
+			bool copyString(IMemorySource* pSource, char* dst, const void* src, size_t size);
+
+			// Copies a nullterminated wide string from a memory source to a buffer.
+			// The string is read in chunks that end at page boundaries and the null character is searched with SSE2, so a string costs one read per page it spans.
+			// Characters after the null character up to the end of a chunk may be copied to the buffer as well.
+			// 
+			// Parameters:
+			// 
+			// [in] pSource:
+			// The memory source the string is read from.
+			// 
+			// [out] dst:
+			// Target buffer for the string.
+			// 
+			// [in] src:
+			// Address of the string within the memory source.
+			// 
+			// [in] size:
+			// Size of the target buffer in characters. Beware of buffer overflows.
+			// 
+			// Return:
+			// True on success, false on failure or if no null char was copied.
+			bool copyString(IMemorySource* pSource, wchar_t* dst, const void* src, size_t size);
+
 		}
 
 	}
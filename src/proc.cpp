@@ -1,6 +1,8 @@
 #pragma once
 #include "proc.h"
 #include "mem.h"
+#include "ExportIndex.h"
+#include "scan\MemorySource.h"
 
 namespace hax {
 
@@ -237,139 +239,54 @@ namespace hax {
 			static bool getDataDirFromPeHeaders(HANDLE hProc, const PeHeaders* pPeHeaders, IMAGE_DATA_DIRECTORY* pDataDir, char index);
 
 			FARPROC getProcAddress(HANDLE hProc, HMODULE hMod, const char* funcName) {
-				const BYTE* const pBase = reinterpret_cast<BYTE*>(hMod);
-				PeHeaders peHeaders{};
-
-				if (!getPeHeaders(hProc, hMod, &peHeaders)) return nullptr;
-
-				IMAGE_DATA_DIRECTORY dirEntryExport{};
-
-				if (!getDataDirFromPeHeaders(hProc, &peHeaders, &dirEntryExport, IMAGE_DIRECTORY_ENTRY_EXPORT)) return nullptr;
-
-				IMAGE_EXPORT_DIRECTORY exportDir{};
+				hax::ex::MemorySource source(hProc);
+				ExportIndex exportIndex;
 
-				if (!ReadProcessMemory(hProc, pBase + dirEntryExport.VirtualAddress, &exportDir, sizeof(IMAGE_EXPORT_DIRECTORY), nullptr)) return nullptr;
+				if (!exportIndex.build(&source, hMod)) return nullptr;
 
-				const DWORD numberOfFuncs = exportDir.NumberOfFunctions;
-				DWORD* const pExportFunctionTable = new DWORD[numberOfFuncs];
-				const BYTE* const addressOfFunctions = pBase + exportDir.AddressOfFunctions;
+				const DWORD funcRva = exportIndex.getFunctionRva(funcName);
 
-				if (!ReadProcessMemory(hProc, addressOfFunctions, pExportFunctionTable, numberOfFuncs * sizeof(DWORD), nullptr)) {
-					delete[] pExportFunctionTable;
-
-					return nullptr;
-				}
-
-				const DWORD numberOfNames = exportDir.NumberOfNames;
-				DWORD* const pExportNameTable = new DWORD[numberOfNames];
-				const BYTE* const addressOfNames = pBase + exportDir.AddressOfNames;
-
-				if (!ReadProcessMemory(hProc, addressOfNames, pExportNameTable, numberOfNames * sizeof(DWORD), nullptr)) {
-					delete[] pExportFunctionTable;
-					delete[] pExportNameTable;
+				if (!funcRva) return nullptr;
 
-					return nullptr;
-				}
+				const char* const forward = exportIndex.getForward(funcRva);
 
-				WORD* const pExportOrdinalTable = new WORD[numberOfNames];
-				const BYTE* const addressOfNameOrdinals = pBase + exportDir.AddressOfNameOrdinals;
+				if (!forward) return reinterpret_cast<FARPROC>(exportIndex.base() + funcRva);
 
-				if (!ReadProcessMemory(hProc, addressOfNameOrdinals, pExportOrdinalTable, numberOfNames * sizeof(WORD), nullptr)) {
-					delete[] pExportFunctionTable;
-					delete[] pExportNameTable;
-					delete[] pExportOrdinalTable;
+				// forward has the format "module.function"
+				// it is split a the dot and the ".dll" extension is appended to the module name
+				// a malformed export table of the module must not raise the invalid parameter handler of the string functions
+				if (strnlen(forward, MAX_PATH) == MAX_PATH) return nullptr;
 
-					return nullptr;
-				}
+				char curForward[MAX_PATH]{};
+				strcpy_s(curForward, forward);
 
-				DWORD funcRva = 0ul;
-				// export by ordinal if everything but the lowest word of name param is zero
-				const bool byOrdinal = (reinterpret_cast<uintptr_t>(funcName) >> sizeof(WORD) * 0x8) == 0u;
+				char* forwardModName = nullptr;
+				char* forwardFuncName = nullptr;
 
-				if (byOrdinal) {
-					const WORD index = static_cast<WORD>((reinterpret_cast<uintptr_t>(funcName) & MAXWORD) - exportDir.Base);
-					funcRva = pExportFunctionTable[index];
-				}
-				else {
+				forwardModName = strtok_s(curForward, ".", &forwardFuncName);
 
-					for (DWORD i = 0ul; i < exportDir.NumberOfNames; i++) {
-						char curFuncName[MAX_PATH]{};
+				if (!forwardModName || strlen(forwardModName) + sizeof(".dll") > MAX_PATH) return nullptr;
 
-						if (!mem::ex::copyRemoteString(hProc, curFuncName, pBase + pExportNameTable[i], MAX_PATH)) continue;
+				char forwardModFileName[MAX_PATH]{};
 
-						if (!_stricmp(funcName, curFuncName)) {
-							// the function rva is in the export table indexed by the ordinal in the ordinal table at the same index as the name in the name table
-							funcRva = pExportFunctionTable[pExportOrdinalTable[i]];
+				strcpy_s(forwardModFileName, forwardModName);
+				strcat_s(forwardModFileName, ".dll");
 
-							break;
-						}
+				HMODULE hForwardMod = getModuleHandle(hProc, forwardModFileName);
 
-					}
-
-				}
-
-				if (!funcRva) {
-					delete[] pExportFunctionTable;
-					delete[] pExportNameTable;
-					delete[] pExportOrdinalTable;
-
-					return nullptr;
-				}
+				if (!hForwardMod) return nullptr;
 
 				FARPROC procAddress = nullptr;
-				const bool forwarded = funcRva >= dirEntryExport.VirtualAddress && funcRva <= dirEntryExport.VirtualAddress + dirEntryExport.Size;
-
-				if (forwarded) {
-					// forward has the format "module.function"
-					// it is split a the dot and the ".dll" extension is appended to the module name
-					char curForward[MAX_PATH]{};
-
-					if (!mem::ex::copyRemoteString(hProc, curForward, pBase + funcRva, MAX_PATH)) {
-						delete[] pExportFunctionTable;
-						delete[] pExportNameTable;
-						delete[] pExportOrdinalTable;
-
-						return nullptr;
-					}
-
-					char* forwardModName = nullptr;
-					char* forwardFuncName = nullptr;
-
-					forwardModName = strtok_s(curForward, ".", &forwardFuncName);
-
-					char forwardModFileName[MAX_PATH]{};
-
-					strcpy_s(forwardModFileName, forwardModName);
-					strcat_s(forwardModFileName, ".dll");
-
-					HMODULE hForwardMod = getModuleHandle(hProc, forwardModFileName);
-
-					if (!hForwardMod) {
-						delete[] pExportFunctionTable;
-						delete[] pExportNameTable;
-						delete[] pExportOrdinalTable;
-
-						return nullptr;
-					}
-
-					// check if exported by ordinal and looking for the forwarded funcion in the module it was forwarded to
-					if (forwardFuncName[0] == '#') {
-						char* forwardFuncOrdinal = reinterpret_cast<char*>(static_cast<uintptr_t>(atoi(forwardFuncName++)));
-						procAddress = getProcAddress(hProc, hForwardMod, forwardFuncOrdinal);
-					}
-					else {
-						procAddress = getProcAddress(hProc, hForwardMod, forwardFuncName);
-					}
 
+				// check if exported by ordinal and looking for the forwarded funcion in the module it was forwarded to
+				if (forwardFuncName[0] == '#') {
+					char* forwardFuncOrdinal = reinterpret_cast<char*>(static_cast<uintptr_t>(atoi(forwardFuncName + 1)));
+					procAddress = getProcAddress(hProc, hForwardMod, forwardFuncOrdinal);
 				}
 				else {
-					procAddress = reinterpret_cast<FARPROC>(pBase + funcRva);
+					procAddress = getProcAddress(hProc, hForwardMod, forwardFuncName);
 				}
 
-				delete[] pExportFunctionTable;
-				delete[] pExportNameTable;
-				delete[] pExportOrdinalTable;
-
 				return procAddress;
 			}
 
@@ -750,69 +667,35 @@ namespace hax {
 		namespace in {
 
 			FARPROC getProcAddress(HMODULE hMod, const char* funcName) {
-				const BYTE* const pBase = reinterpret_cast<BYTE*>(hMod);
-				PeHeaders peHeaders{};
-
-				if (!getPeHeaders(hMod, &peHeaders) || !peHeaders.pOptHeader) return nullptr;
-
-				const IMAGE_DATA_DIRECTORY dirEntryExport = peHeaders.pOptHeader->DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
-
-				const IMAGE_EXPORT_DIRECTORY* const pExportDir = reinterpret_cast<const IMAGE_EXPORT_DIRECTORY*>(pBase + dirEntryExport.VirtualAddress);
-
-				if (!pExportDir) return nullptr;
-
-				const DWORD* const pExportFunctionTable = reinterpret_cast<const DWORD*>(pBase + pExportDir->AddressOfFunctions);
+				hax::in::MemorySource source;
+				ExportIndex exportIndex;
 
-				if (!pExportFunctionTable) return nullptr;
+				// the module is accessed in place, so building the index only sets up pointers to its tables
+				if (!exportIndex.build(&source, hMod)) return nullptr;
 
-				const DWORD* const pExportNameTable = reinterpret_cast<const DWORD*>(pBase + pExportDir->AddressOfNames);
-
-				if (!pExportNameTable) return nullptr;
-
-				const WORD* const pExportOrdinalTable = reinterpret_cast<const WORD*>(pBase + pExportDir->AddressOfNameOrdinals);
-
-				if (!pExportOrdinalTable) return nullptr;
-
-				DWORD funcRva = 0ul;
-				// export by ordinal if everything but the lowest word of name param is zero
-				const bool byOrdinal = (reinterpret_cast<uintptr_t>(funcName) >> sizeof(WORD) * 0x8) == 0u;
-
-				if (byOrdinal) {
-					const WORD index = static_cast<WORD>((reinterpret_cast<uintptr_t>(funcName) & MAXWORD) - pExportDir->Base);
-					funcRva = pExportFunctionTable[index];
-				}
-				else {
-
-					for (DWORD i = 0ul; i < pExportDir->NumberOfNames; i++) {
-						const char* const curFuncName = reinterpret_cast<const char*>(pBase + pExportNameTable[i]);
-
-						if (!_stricmp(funcName, curFuncName)) {
-							// the function rva is in the export table indexed by the ordinal in the ordinal table at the same index as the name in the name table
-							funcRva = pExportFunctionTable[pExportOrdinalTable[i]];
-
-							break;
-						}
-
-					}
-
-				}
+				const DWORD funcRva = exportIndex.getFunctionRva(funcName);
 
 				if (!funcRva) return nullptr;
 
 				FARPROC procAddress = nullptr;
-				const bool forwarded = funcRva >= dirEntryExport.VirtualAddress && funcRva <= dirEntryExport.VirtualAddress + dirEntryExport.Size;
+				const char* const forward = exportIndex.getForward(funcRva);
 
-				if (forwarded) {
+				if (forward) {
 					// forward has the format "module.function"
 					// it is split a the dot and the ".dll" extension is appended to the module name
+					// a malformed export table of the module must not raise the invalid parameter handler of the string functions
+					if (strnlen(forward, MAX_PATH) == MAX_PATH) return nullptr;
+
 					char curForward[MAX_PATH]{};
-					strcpy_s(curForward, reinterpret_cast<const char*>(pBase + funcRva));
+					strcpy_s(curForward, forward);
 
 					char* forwardModName = nullptr;
 					char* forwardFuncName = nullptr;
 
 					forwardModName = strtok_s(curForward, ".", &forwardFuncName);
 
+					if (!forwardModName || strlen(forwardModName) + sizeof(".dll") > MAX_PATH) return nullptr;
+
 					char forwardModFileName[MAX_PATH]{};
 
 					strcpy_s(forwardModFileName, forwardModName);
@@ -824,7 +707,7 @@ namespace hax {
 
 					// check if exported by ordinal and looking for the forwarded funcion in the module it was forwarded to
 					if (forwardFuncName[0] == '#') {
-						char* forwardFuncOrdinal = reinterpret_cast<char*>(static_cast<uintptr_t>(atoi(forwardFuncName++)));
+						char* forwardFuncOrdinal = reinterpret_cast<char*>(static_cast<uintptr_t>(atoi(forwardFuncName + 1)));
 						procAddress = getProcAddress(hForwardMod, forwardFuncOrdinal);
 					}
 					else {
@@ -833,7 +716,7 @@ namespace hax {
 
 				}
 				else {
-					procAddress = reinterpret_cast<FARPROC>(pBase + funcRva);
+					procAddress = reinterpret_cast<FARPROC>(exportIndex.base() + funcRva);
 				}
 
 				return procAddress;
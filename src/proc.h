@@ -119,6 +119,7 @@ namespace hax {
 			// Gets the address of a function/procedure exported by a module of an external target process within the virtual address space this process.
 			// Works like an external version of GetProcAddress of the Win32 API.
 			// Uses only calls to ReadProcessMemory and NtQueryInformationProcess (for forwared functions) of the Win32 API.
+			// Builds an ExportIndex of the module for every call. To look up many functions of the same module build an ExportIndex once instead.
 			// Supports function forwarding but NOT FOR VIRTUAL DLLS (e.g. api-ms-win-...dll) using the ApiSetSchema.
 			// 
 			// Parameters:
@@ -202,6 +203,7 @@ namespace hax {
 			// The value of the handle is equivalent to the base address of the module within the virtual address space of the target process.
 			// Works like an external version of GetModuleHandle of the Win32 API.
 			// Uses only calls to ReadProcessMemory and NtQueryInformationProcess of the Win32 API.
+			// Walks the loader list for every call. Use a hax::proc::ModuleCache for repeated lookups.
 			// 
 			// Parameters:
 			// 
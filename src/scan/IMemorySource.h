@@ -0,0 +1,89 @@
+#pragma once
+#include <Windows.h>
+
+// Interface for sources of virtual memory that can be scanned.
+// Implementations exist for the caller process, external processes and plain buffers, so scanning code can also run on a fake process.
+
+namespace hax {
+
+	typedef enum RegionAccess {
+		// not commited, not accessable or guarded
+		REGION_NO_ACCESS,
+		// readable without changing the protection
+		REGION_READABLE,
+		// commited but the protection has to be changed temporarily to read it, eg. execute-only memory
+		REGION_PROTECTED
+	}RegionAccess;
+
+	typedef struct MemoryRegion {
+		const BYTE* base;
+		size_t size;
+		RegionAccess access;
+	}MemoryRegion;
+
+	class IMemorySource {
+	public:
+		// Queries the memory region that contains an address.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address within the region.
+		// 
+		// [out] pRegion:
+		// Receives the base, size and access of the region.
+		// 
+		// Return:
+		// True on success, false if the address is outside of the address space of the source.
+		virtual bool queryRegion(const void* address, MemoryRegion* pRegion) = 0;
+
+		// Reads memory of a readable region.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address to read from.
+		// 
+		// [out] buffer:
+		// Buffer that receives the memory.
+		// 
+		// [in] size:
+		// Amount of bytes to read.
+		// 
+		// Return:
+		// True if all bytes were read, false otherwise.
+		virtual bool read(const void* address, void* buffer, size_t size) = 0;
+
+		// Reads memory of a protected region. The protection is changed for the read and restored afterwards.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address to read from.
+		// 
+		// [out] buffer:
+		// Buffer that receives the memory.
+		// 
+		// [in] size:
+		// Amount of bytes to read.
+		// 
+		// Return:
+		// True if all bytes were read and the protection was restored, false otherwise.
+		virtual bool readProtected(const void* address, void* buffer, size_t size) = 0;
+
+		// Gets a pointer to readable memory that can be accessed in place by the caller without copying it.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address of the memory.
+		// 
+		// [in] size:
+		// Amount of bytes that should be accessable.
+		// 
+		// Return:
+		// Pointer to the memory in the address space of the caller or nullptr if the memory has to be read.
+		virtual const BYTE* view(const void* address, size_t size) = 0;
+	};
+
+}
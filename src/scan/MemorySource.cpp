@@ -0,0 +1,188 @@
+#include "MemorySource.h"
+
+namespace hax {
+
+	static RegionAccess getRegionAccess(const MEMORY_BASIC_INFORMATION* pMbi);
+	static bool isReadable(const void* address, size_t size);
+
+	namespace ex {
+
+		MemorySource::MemorySource(HANDLE hProc) : _hProc{ hProc } {}
+
+
+		bool MemorySource::queryRegion(const void* address, MemoryRegion* pRegion) {
+			MEMORY_BASIC_INFORMATION mbi{};
+
+			if (!VirtualQueryEx(this->_hProc, address, &mbi, sizeof(mbi))) return false;
+
+			pRegion->base = reinterpret_cast<const BYTE*>(mbi.BaseAddress);
+			pRegion->size = mbi.RegionSize;
+			pRegion->access = getRegionAccess(&mbi);
+
+			return true;
+		}
+
+
+		bool MemorySource::read(const void* address, void* buffer, size_t size) {
+			SIZE_T bytesRead = 0u;
+
+			if (!ReadProcessMemory(this->_hProc, address, buffer, size, &bytesRead)) return false;
+
+			return bytesRead == size;
+		}
+
+
+		bool MemorySource::readProtected(const void* address, void* buffer, size_t size) {
+			DWORD oldProtect = 0ul;
+
+			if (!VirtualProtectEx(this->_hProc, const_cast<void*>(address), size, PAGE_EXECUTE_READ, &oldProtect)) return false;
+
+			const bool read = this->read(address, buffer, size);
+
+			if (!VirtualProtectEx(this->_hProc, const_cast<void*>(address), size, oldProtect, &oldProtect)) return false;
+
+			return read;
+		}
+
+
+		const BYTE* MemorySource::view(const void*, size_t) {
+
+			return nullptr;
+		}
+
+	}
+
+
+	namespace in {
+
+		bool MemorySource::queryRegion(const void* address, MemoryRegion* pRegion) {
+			MEMORY_BASIC_INFORMATION mbi{};
+
+			if (!VirtualQuery(address, &mbi, sizeof(mbi))) return false;
+
+			pRegion->base = reinterpret_cast<const BYTE*>(mbi.BaseAddress);
+			pRegion->size = mbi.RegionSize;
+			pRegion->access = getRegionAccess(&mbi);
+
+			return true;
+		}
+
+
+		bool MemorySource::read(const void* address, void* buffer, size_t size) {
+
+			if (!isReadable(address, size)) return false;
+
+			memcpy(buffer, address, size);
+
+			return true;
+		}
+
+
+		bool MemorySource::readProtected(const void* address, void* buffer, size_t size) {
+			DWORD oldProtect = 0ul;
+
+			if (!VirtualProtect(const_cast<void*>(address), size, PAGE_EXECUTE_READ, &oldProtect)) return false;
+
+			memcpy(buffer, address, size);
+
+			return VirtualProtect(const_cast<void*>(address), size, oldProtect, &oldProtect);
+		}
+
+
+		const BYTE* MemorySource::view(const void* address, size_t size) {
+
+			if (!isReadable(address, size)) return nullptr;
+
+			return reinterpret_cast<const BYTE*>(address);
+		}
+
+	}
+
+
+	BufferMemorySource::BufferMemorySource(const void* data, size_t size, const void* base, size_t regionSize) :
+		_data{ reinterpret_cast<const BYTE*>(data) }, _size{ size }, _base{ reinterpret_cast<const BYTE*>(base) }, _regionSize{ regionSize ? regionSize : size } {}
+
+
+	bool BufferMemorySource::queryRegion(const void* address, MemoryRegion* pRegion) {
+		const BYTE* const cur = reinterpret_cast<const BYTE*>(address);
+
+		if (cur < this->_base || cur >= this->_base + this->_size) return false;
+
+		const size_t offset = cur - this->_base;
+		const size_t regionOffset = offset - offset % this->_regionSize;
+
+		pRegion->base = this->_base + regionOffset;
+		pRegion->size = this->_size - regionOffset < this->_regionSize ? this->_size - regionOffset : this->_regionSize;
+		pRegion->access = REGION_READABLE;
+
+		return true;
+	}
+
+
+	bool BufferMemorySource::read(const void* address, void* buffer, size_t size) {
+		const BYTE* const src = this->translate(address, size);
+
+		if (!src) return false;
+
+		memcpy(buffer, src, size);
+
+		return true;
+	}
+
+
+	bool BufferMemorySource::readProtected(const void* address, void* buffer, size_t size) {
+
+		return this->read(address, buffer, size);
+	}
+
+
+	const BYTE* BufferMemorySource::view(const void* address, size_t size) {
+
+		return this->translate(address, size);
+	}
+
+
+	const BYTE* BufferMemorySource::translate(const void* address, size_t size) const {
+		const BYTE* const cur = reinterpret_cast<const BYTE*>(address);
+
+		if (cur < this->_base || cur > this->_base + this->_size || size > static_cast<size_t>(this->_base + this->_size - cur)) return nullptr;
+
+		return this->_data + (cur - this->_base);
+	}
+
+
+	static RegionAccess getRegionAccess(const MEMORY_BASIC_INFORMATION* pMbi) {
+
+		if (pMbi->State != MEM_COMMIT || pMbi->Protect & PAGE_NOACCESS) return REGION_NO_ACCESS;
+
+		// lifting the guard for a read would turn guard pages like the ones of thread stacks into read-only pages that raise access violations instead of growing the stack
+		if (pMbi->Protect & PAGE_GUARD) return REGION_NO_ACCESS;
+
+		constexpr DWORD READABLE = PAGE_READONLY | PAGE_READWRITE | PAGE_WRITECOPY | PAGE_EXECUTE_READ | PAGE_EXECUTE_READWRITE | PAGE_EXECUTE_WRITECOPY;
+
+		return pMbi->Protect & READABLE ? REGION_READABLE : REGION_PROTECTED;
+	}
+
+
+
+	static bool isReadable(const void* address, size_t size) {
+
+		// the range wraps around the end of the address space
+		if (size > SIZE_MAX - reinterpret_cast<uintptr_t>(address)) return false;
+
+		const BYTE* cur = reinterpret_cast<const BYTE*>(address);
+		const BYTE* const end = cur + size;
+
+		// the range can span multiple regions with different protections
+		while (cur < end) {
+			MEMORY_BASIC_INFORMATION mbi{};
+
+			if (!VirtualQuery(cur, &mbi, sizeof(mbi)) || getRegionAccess(&mbi) != REGION_READABLE) return false;
+
+			cur = reinterpret_cast<const BYTE*>(mbi.BaseAddress) + mbi.RegionSize;
+		}
+
+		return true;
+	}
+
+}
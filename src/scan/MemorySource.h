@@ -0,0 +1,85 @@
+#pragma once
+#include "IMemorySource.h"
+
+namespace hax {
+
+	namespace ex {
+
+		// Memory source of the virtual address space of an external process.
+		class MemorySource : public IMemorySource {
+		private:
+			const HANDLE _hProc;
+
+		public:
+			// Initializes members.
+			// 
+			// Parameters:
+			// 
+			// [in] hProc:
+			// Handle to the process.
+			// Needs at least PROCESS_QUERY_INFORMATION and PROCESS_VM_READ access rights and PROCESS_VM_OPERATION for reading protected regions.
+			MemorySource(HANDLE hProc);
+
+			virtual bool queryRegion(const void* address, MemoryRegion* pRegion) override;
+			virtual bool read(const void* address, void* buffer, size_t size) override;
+			virtual bool readProtected(const void* address, void* buffer, size_t size) override;
+			virtual const BYTE* view(const void* address, size_t size) override;
+		};
+
+	}
+
+	namespace in {
+
+		// Memory source of the virtual address space of the caller process. Readable memory is accessed in place.
+		// read and view check that the whole range is commited, readable and not guarded before touching it,
+		// so arbitrary addresses like pointer values read from the process fail instead of raising an access violation.
+		// The check costs a VirtualQuery per region the range touches.
+		class MemorySource : public IMemorySource {
+		public:
+			virtual bool queryRegion(const void* address, MemoryRegion* pRegion) override;
+			virtual bool read(const void* address, void* buffer, size_t size) override;
+			virtual bool readProtected(const void* address, void* buffer, size_t size) override;
+			virtual const BYTE* view(const void* address, size_t size) override;
+		};
+
+	}
+
+	// Memory source of a buffer that poses as the virtual address space of a process.
+	// The buffer is split into readable regions of equal size starting at an arbitrary base address.
+	// Useful to scan files mapped by a FileMapper or to run scanning code without a target process.
+	class BufferMemorySource : public IMemorySource {
+	private:
+		const BYTE* _data;
+		size_t _size;
+		const BYTE* _base;
+		size_t _regionSize;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] data:
+		// Buffer that contains the memory. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] size:
+		// Size of the buffer in bytes.
+		// 
+		// [in] base:
+		// Address the buffer poses at. Addresses passed to the methods are translated from this base into the buffer.
+		// 
+		// [in] regionSize:
+		// Size of the regions the buffer is split into. Zero for one region spanning the whole buffer.
+		BufferMemorySource(const void* data, size_t size, const void* base, size_t regionSize = 0u);
+
+		virtual bool queryRegion(const void* address, MemoryRegion* pRegion) override;
+		virtual bool read(const void* address, void* buffer, size_t size) override;
+		virtual bool readProtected(const void* address, void* buffer, size_t size) override;
+		virtual const BYTE* view(const void* address, size_t size) override;
+
+	private:
+		// translates an address of the posed address space to the buffer, nullptr if the range is not within the buffer
+		const BYTE* translate(const void* address, size_t size) const;
+	};
+
+}
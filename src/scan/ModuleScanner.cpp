@@ -0,0 +1,174 @@
+#include "ModuleScanner.h"
+#include "..\proc.h"
+
+namespace hax {
+
+	// the pe headers of a module lie within its first page
+	static constexpr size_t HEADERS_SIZE = 0x1000u;
+
+	typedef struct RvaCollection {
+		const BYTE* base;
+		DWORD* rvas;
+		size_t limit;
+		size_t count;
+	}RvaCollection;
+
+	static bool collectRva(void* address, void* pArg);
+
+	ModuleScanner::ModuleScanner(IMemorySource* pSource) :
+		_pSource{ pSource }, _scanner(pSource), _base{}, _sections{}, _resourceDir{}, _sizeOfImage{}, _scannedBytes{} {}
+
+
+	ModuleScanner::~ModuleScanner() {}
+
+
+	bool ModuleScanner::setModule(HMODULE hMod) {
+		this->_base = nullptr;
+		this->_sections.resize(0u);
+		this->_resourceDir = IMAGE_DATA_DIRECTORY{};
+		this->_sizeOfImage = 0ul;
+		this->_scannedBytes = 0u;
+
+		if (!this->_pSource || !hMod) return false;
+
+		const BYTE* const pBase = reinterpret_cast<const BYTE*>(hMod);
+		const BYTE* headers = this->_pSource->view(pBase, HEADERS_SIZE);
+		BYTE headersCopy[HEADERS_SIZE]{};
+
+		if (!headers) {
+
+			if (!this->_pSource->read(pBase, headersCopy, HEADERS_SIZE)) return false;
+
+			headers = headersCopy;
+		}
+
+		const IMAGE_DOS_HEADER* const pDosHeader = reinterpret_cast<const IMAGE_DOS_HEADER*>(headers);
+
+		// getPeHeaders does not check if the headers fit into the buffer
+		if (pDosHeader->e_magic != IMAGE_DOS_SIGNATURE || pDosHeader->e_lfanew < 0 || static_cast<size_t>(pDosHeader->e_lfanew) + sizeof(IMAGE_NT_HEADERS64) > HEADERS_SIZE) return false;
+
+		proc::PeHeaders peHeaders{};
+
+		if (!proc::in::getPeHeaders(reinterpret_cast<HMODULE>(const_cast<BYTE*>(headers)), &peHeaders)) return false;
+
+		if (peHeaders.pOptHeader64) {
+			this->_resourceDir = peHeaders.pOptHeader64->DataDirectory[IMAGE_DIRECTORY_ENTRY_RESOURCE];
+			this->_sizeOfImage = peHeaders.pOptHeader64->SizeOfImage;
+		}
+		else if (peHeaders.pOptHeader32) {
+			this->_resourceDir = peHeaders.pOptHeader32->DataDirectory[IMAGE_DIRECTORY_ENTRY_RESOURCE];
+			this->_sizeOfImage = peHeaders.pOptHeader32->SizeOfImage;
+		}
+		else {
+			return false;
+		}
+
+		const size_t sectionsOffset = reinterpret_cast<const BYTE*>(peHeaders.pFileHeader) + sizeof(IMAGE_FILE_HEADER) + peHeaders.pFileHeader->SizeOfOptionalHeader - headers;
+		const size_t sectionCount = peHeaders.pFileHeader->NumberOfSections;
+
+		if (sectionsOffset + sectionCount * sizeof(IMAGE_SECTION_HEADER) > HEADERS_SIZE) return false;
+
+		const IMAGE_SECTION_HEADER* const sections = reinterpret_cast<const IMAGE_SECTION_HEADER*>(headers + sectionsOffset);
+
+		for (size_t i = 0u; i < sectionCount; i++) {
+			this->_sections.append(sections[i]);
+		}
+
+		this->_base = pBase;
+
+		return true;
+	}
+
+
+	DWORD ModuleScanner::findSigRva(const mem::Signature& signature, DWORD sectionTypes) {
+		DWORD rva = 0ul;
+
+		if (!this->findAllSigRvas(signature, sectionTypes, &rva, 1u)) return 0ul;
+
+		return rva;
+	}
+
+
+	size_t ModuleScanner::findAllSigRvas(const mem::Signature& signature, DWORD sectionTypes, DWORD rvas[], size_t limit) {
+		
+		if (!this->_base || !limit) return 0u;
+
+		Vector<SectionRange> ranges{};
+		this->getSectionRanges(sectionTypes, &ranges);
+
+		RvaCollection collection{ this->_base, rvas, limit, 0u };
+
+		// the ranges are in the order of the section table, which is sorted by address, so the matches are ascending as well
+		for (size_t i = 0u; i < ranges.size() && collection.count < limit; i++) {
+			this->_scanner.findAll(this->_base + ranges[i].rva, ranges[i].size, signature, collectRva, &collection);
+			this->_scannedBytes += ranges[i].size;
+		}
+
+		return collection.count;
+	}
+
+
+	size_t ModuleScanner::getSectionRanges(DWORD sectionTypes, Vector<SectionRange>* pRanges) const {
+
+		return getSectionRanges(this->_sections.data(), this->_sections.size(), &this->_resourceDir, this->_sizeOfImage, sectionTypes, pRanges);
+	}
+
+
+	size_t ModuleScanner::scannedBytes() const {
+
+		return this->_scannedBytes;
+	}
+
+
+	size_t ModuleScanner::getSectionRanges(const IMAGE_SECTION_HEADER* sections, size_t sectionCount, const IMAGE_DATA_DIRECTORY* pResourceDir, DWORD sizeOfImage, DWORD sectionTypes, Vector<SectionRange>* pRanges) {
+		size_t count = 0u;
+
+		for (size_t i = 0u; i < sectionCount; i++) {
+			const IMAGE_SECTION_HEADER* const pSection = &sections[i];
+
+			if (!isSectionOfType(pSection, sectionTypes) || pSection->VirtualAddress >= sizeOfImage) continue;
+
+			// the loader maps the virtual size, the raw size is only used by some packers that leave the virtual size empty
+			DWORD size = pSection->Misc.VirtualSize ? pSection->Misc.VirtualSize : pSection->SizeOfRawData;
+
+			if (size > sizeOfImage - pSection->VirtualAddress) {
+				size = sizeOfImage - pSection->VirtualAddress;
+			}
+
+			if (!size) continue;
+
+			// resources are usually readonly data but never contain code or data of interest
+			if (pResourceDir && pResourceDir->VirtualAddress && pResourceDir->VirtualAddress >= pSection->VirtualAddress && pResourceDir->VirtualAddress - pSection->VirtualAddress < size) continue;
+
+			pRanges->append(SectionRange{ pSection->VirtualAddress, size });
+			count++;
+		}
+
+		return count;
+	}
+
+
+	bool ModuleScanner::isSectionOfType(const IMAGE_SECTION_HEADER* pSection, DWORD sectionTypes) {
+		const DWORD characteristics = pSection->Characteristics;
+
+		if (characteristics & IMAGE_SCN_MEM_DISCARDABLE) return false;
+
+		if (characteristics & (IMAGE_SCN_MEM_EXECUTE | IMAGE_SCN_CNT_CODE)) return (sectionTypes & mem::SECTION_CODE) != 0u;
+
+		if (characteristics & IMAGE_SCN_MEM_WRITE) return (sectionTypes & mem::SECTION_WRITABLE_DATA) != 0u;
+
+		if (characteristics & IMAGE_SCN_MEM_READ) return (sectionTypes & mem::SECTION_READONLY_DATA) != 0u;
+
+		return false;
+	}
+
+
+	static bool collectRva(void* address, void* pArg) {
+		RvaCollection* const pCollection = reinterpret_cast<RvaCollection*>(pArg);
+		pCollection->rvas[pCollection->count] = static_cast<DWORD>(reinterpret_cast<const BYTE*>(address) - pCollection->base);
+		pCollection->count++;
+
+		return pCollection->count < pCollection->limit;
+	}
+
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include "SigScanner.h"
+#include "..\Vector.h"
+
+namespace hax {
+
+	// Class to scan only selected sections of a module for byte signatures.
+	// The section table is read from the headers of the module once. Scans are restricted to the sections of the requested types, so resources, relocations and padding are skipped.
+	// Matches are returned as relative virtual addresses, which stay valid across runs if the module is loaded at a different base.
+	// Example:
+	// hax::ex::MemorySource source(hProc);
+	// hax::ModuleScanner scanner(&source);
+	// scanner.setModule(hMod);
+	// const DWORD rva = scanner.findSigRva(sig, hax::mem::SECTION_CODE);
+	class ModuleScanner {
+	public:
+		typedef struct SectionRange {
+			DWORD rva;
+			DWORD size;
+		}SectionRange;
+
+	private:
+		IMemorySource* const _pSource;
+		SigScanner _scanner;
+		const BYTE* _base;
+		Vector<IMAGE_SECTION_HEADER> _sections;
+		IMAGE_DATA_DIRECTORY _resourceDir;
+		DWORD _sizeOfImage;
+		size_t _scannedBytes;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source that contains the module. Has to stay valid for the lifetime of the object.
+		ModuleScanner(IMemorySource* pSource);
+
+		ModuleScanner(ModuleScanner&&) = delete;
+
+		ModuleScanner(const ModuleScanner&) = delete;
+
+		ModuleScanner& operator=(ModuleScanner&&) = delete;
+
+		ModuleScanner& operator=(const ModuleScanner&) = delete;
+
+		~ModuleScanner();
+
+		// Sets the module that is scanned by reading its section table.
+		// 
+		// Parameters:
+		// 
+		// [in] hMod:
+		// Handle to the module within the address space of the memory source.
+		// 
+		// Return:
+		// True on success, false if the headers of the module could not be read or are invalid.
+		bool setModule(HMODULE hMod);
+
+		// Finds the first match of a byte signature within the sections of the types.
+		// 
+		// Parameters:
+		// 
+		// [in] signature:
+		// The byte signature that should be looked for.
+		// 
+		// [in] sectionTypes:
+		// Combination of mem::SectionType values of the sections that are scanned.
+		// 
+		// Return:
+		// The relative virtual address of the match or zero if the signature was not found.
+		DWORD findSigRva(const mem::Signature& signature, DWORD sectionTypes = mem::SECTION_CODE);
+
+		// Finds all matches of a byte signature within the sections of the types.
+		// 
+		// Parameters:
+		// 
+		// [in] signature:
+		// The byte signature that should be looked for.
+		// 
+		// [in] sectionTypes:
+		// Combination of mem::SectionType values of the sections that are scanned.
+		// 
+		// [out] rvas:
+		// Buffer that receives the relative virtual addresses of the matches in ascending order.
+		// 
+		// [in] limit:
+		// Maximum amount of matches written to the buffer. The scan stops when the buffer is full.
+		// 
+		// Return:
+		// The amount of matches written to the buffer.
+		size_t findAllSigRvas(const mem::Signature& signature, DWORD sectionTypes, DWORD rvas[], size_t limit);
+
+		// Gets the ranges of the sections of the types of the current module.
+		// 
+		// Parameters:
+		// 
+		// [in] sectionTypes:
+		// Combination of mem::SectionType values.
+		// 
+		// [out] pRanges:
+		// Vector the ranges are appended to in the order of the section table.
+		// 
+		// Return:
+		// The amount of appended ranges.
+		size_t getSectionRanges(DWORD sectionTypes, Vector<SectionRange>* pRanges) const;
+
+		// Gets the amount of bytes scanned by all scans since the module was set.
+		// 
+		// Return:
+		// The amount of scanned bytes.
+		size_t scannedBytes() const;
+
+		// Gets the ranges of the sections of the types from a section table.
+		// Works on the section table of any PE, eg. of a file on disk parsed by pe::Image.
+		// 
+		// Parameters:
+		// 
+		// [in] sections:
+		// The section table.
+		// 
+		// [in] sectionCount:
+		// Amount of sections in the section table.
+		// 
+		// [in] pResourceDir:
+		// The resource data directory of the PE. The section that contains it is skipped. Can be nullptr.
+		// 
+		// [in] sizeOfImage:
+		// Size of the image the ranges are clipped to.
+		// 
+		// [in] sectionTypes:
+		// Combination of mem::SectionType values.
+		// 
+		// [out] pRanges:
+		// Vector the ranges are appended to in the order of the section table.
+		// 
+		// Return:
+		// The amount of appended ranges.
+		static size_t getSectionRanges(const IMAGE_SECTION_HEADER* sections, size_t sectionCount, const IMAGE_DATA_DIRECTORY* pResourceDir, DWORD sizeOfImage, DWORD sectionTypes, Vector<SectionRange>* pRanges);
+
+		// Checks if a section is of one of the types.
+		// 
+		// Parameters:
+		// 
+		// [in] pSection:
+		// The section header.
+		// 
+		// [in] sectionTypes:
+		// Combination of mem::SectionType values.
+		// 
+		// Return:
+		// True if the section is of one of the types, false otherwise. Discardable sections are never of any type.
+		static bool isSectionOfType(const IMAGE_SECTION_HEADER* pSection, DWORD sectionTypes);
+	};
+
+}
@@ -0,0 +1,214 @@
+#include "PageCache.h"
+
+namespace hax {
+
+	PageCache::PageCache(IMemorySource* pSource, size_t pageCount) :
+		_pSource{ pSource }, _pageCount{ pageCount ? pageCount : 1u }, _pages{}, _data{}, _useCounter{}, _readCount{}, _lock{} {
+		InitializeSRWLock(&this->_lock);
+		this->_pages = new CachedPage[this->_pageCount]{};
+		this->_data = new BYTE[this->_pageCount * PAGE_SIZE];
+
+		return;
+	}
+
+
+	PageCache::~PageCache() {
+		delete[] this->_pages;
+		delete[] this->_data;
+
+		return;
+	}
+
+
+	bool PageCache::queryRegion(const void* address, MemoryRegion* pRegion) {
+
+		if (!this->_pSource) return false;
+
+		return this->_pSource->queryRegion(address, pRegion);
+	}
+
+
+	bool PageCache::read(const void* address, void* buffer, size_t size) {
+
+		if (!this->_pSource) return false;
+
+		AcquireSRWLockExclusive(&this->_lock);
+		const bool read = this->readCached(address, buffer, size);
+		ReleaseSRWLockExclusive(&this->_lock);
+
+		return read;
+	}
+
+
+	bool PageCache::readProtected(const void* address, void* buffer, size_t size) {
+
+		if (!this->_pSource) return false;
+
+		AcquireSRWLockExclusive(&this->_lock);
+		this->_readCount++;
+		const bool read = this->_pSource->readProtected(address, buffer, size);
+		ReleaseSRWLockExclusive(&this->_lock);
+
+		return read;
+	}
+
+
+	const BYTE* PageCache::view(const void* address, size_t size) {
+
+		if (!this->_pSource) return nullptr;
+
+		return this->_pSource->view(address, size);
+	}
+
+
+	void PageCache::invalidate() {
+		AcquireSRWLockExclusive(&this->_lock);
+
+		for (size_t i = 0u; i < this->_pageCount; i++) {
+			this->_pages[i].valid = false;
+		}
+
+		ReleaseSRWLockExclusive(&this->_lock);
+
+		return;
+	}
+
+
+	size_t PageCache::readCount() const {
+
+		return this->_readCount;
+	}
+
+
+	bool PageCache::readCached(const void* address, void* buffer, size_t size) {
+		const BYTE* const start = reinterpret_cast<const BYTE*>(address);
+		const BYTE* const firstPage = reinterpret_cast<const BYTE*>(reinterpret_cast<uintptr_t>(start) & ~(PAGE_SIZE - 1u));
+		const size_t spannedPages = (start + size - firstPage + PAGE_SIZE - 1u) / PAGE_SIZE;
+
+		// caching would evict pages of the same read
+		if (spannedPages > this->_pageCount) {
+			this->_readCount++;
+
+			return this->_pSource->read(address, buffer, size);
+		}
+
+		BYTE* dst = reinterpret_cast<BYTE*>(buffer);
+		const BYTE* cur = start;
+		const BYTE* const end = start + size;
+
+		while (cur < end) {
+			const BYTE* const pageAddress = reinterpret_cast<const BYTE*>(reinterpret_cast<uintptr_t>(cur) & ~(PAGE_SIZE - 1u));
+			const size_t pageOffset = cur - pageAddress;
+			const size_t remaining = end - cur;
+			const size_t copySize = remaining < PAGE_SIZE - pageOffset ? remaining : PAGE_SIZE - pageOffset;
+			const BYTE* const page = this->getPage(cur, copySize);
+
+			if (page) {
+				memcpy(dst, page + pageOffset, copySize);
+			}
+			else {
+				// the part of a page that is cached does not cover the bytes, eg. bytes of another region within the last page of a buffer
+				this->_readCount++;
+
+				if (!this->_pSource->read(cur, dst, copySize)) return false;
+
+			}
+
+			dst += copySize;
+			cur += copySize;
+		}
+
+		return true;
+	}
+
+
+	const BYTE* PageCache::getPage(const BYTE* address, size_t size) {
+		const BYTE* const pageAddress = reinterpret_cast<const BYTE*>(reinterpret_cast<uintptr_t>(address) & ~(PAGE_SIZE - 1u));
+		const size_t offset = address - pageAddress;
+		this->_useCounter++;
+
+		// the cache is small, so a linear search is cheaper than a single read of an external process
+		size_t replaced = 0u;
+
+		for (size_t i = 0u; i < this->_pageCount; i++) {
+			CachedPage* const pPage = this->_pages + i;
+
+			if (pPage->valid && pPage->address == pageAddress) {
+
+				if (offset >= pPage->begin && offset + size <= pPage->end) {
+					pPage->lastUse = this->_useCounter;
+
+					return this->_data + i * PAGE_SIZE;
+				}
+
+				// a partial page that does not cover the bytes is read again
+				replaced = i;
+
+				break;
+			}
+
+			if (!pPage->valid) {
+				// an unused slot is always replaced first
+				if (this->_pages[replaced].valid) {
+					replaced = i;
+				}
+
+			}
+			else if (this->_pages[replaced].valid && pPage->lastUse < this->_pages[replaced].lastUse) {
+				replaced = i;
+			}
+
+		}
+
+		CachedPage* const pReplaced = this->_pages + replaced;
+		BYTE* const data = this->_data + replaced * PAGE_SIZE;
+		size_t begin = 0u;
+		size_t end = PAGE_SIZE;
+		this->_readCount++;
+
+		if (!this->_pSource->read(pageAddress, data, PAGE_SIZE)) {
+			MemoryRegion region{};
+
+			// the page is clamped to the region of the address, eg. the last page of a buffer that does not end at a page boundary
+			if (!this->_pSource->queryRegion(address, &region) || region.access != REGION_READABLE) {
+				pReplaced->valid = false;
+
+				return nullptr;
+			}
+
+			const BYTE* const regionEnd = region.base + region.size;
+
+			if (region.base > pageAddress) {
+				begin = region.base - pageAddress;
+			}
+
+			if (regionEnd < pageAddress + PAGE_SIZE) {
+				end = regionEnd - pageAddress;
+			}
+
+			if (begin >= end || offset < begin || offset + size > end) {
+				pReplaced->valid = false;
+
+				return nullptr;
+			}
+
+			this->_readCount++;
+
+			if (!this->_pSource->read(pageAddress + begin, data + begin, end - begin)) {
+				pReplaced->valid = false;
+
+				return nullptr;
+			}
+
+		}
+
+		pReplaced->address = pageAddress;
+		pReplaced->begin = begin;
+		pReplaced->end = end;
+		pReplaced->lastUse = this->_useCounter;
+		pReplaced->valid = true;
+
+		return data;
+	}
+
+}
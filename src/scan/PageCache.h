@@ -0,0 +1,79 @@
+#pragma once
+#include "IMemorySource.h"
+
+namespace hax {
+
+	// Memory source that caches whole pages of another memory source.
+	// Meant for read-mostly memory like module headers or loader structures that is read in many small pieces.
+	// Every page that is not cached yet is read with one read of the underlying source, the least recently used page is replaced when the cache is full.
+	// Changes of the memory are not noticed, so the cache has to be invalidated when the memory might have changed.
+	// Pages are only cached if the underlying source could read them, so over an in::MemorySource unmapped or guarded pages fail instead of raising an access violation.
+	// The cache is locked for every call, so the object can be used from multiple threads at once, eg. by a ParallelSigScanner.
+	class PageCache : public IMemorySource {
+	public:
+		static constexpr size_t PAGE_SIZE = 0x1000u;
+
+	private:
+		typedef struct CachedPage {
+			const BYTE* address;
+			// offsets of the cached bytes within the page, pages that cross the bounds of a region that is not page aligned are cached partially
+			size_t begin;
+			size_t end;
+			size_t lastUse;
+			bool valid;
+		}CachedPage;
+
+		IMemorySource* const _pSource;
+		const size_t _pageCount;
+		CachedPage* _pages;
+		BYTE* _data;
+		size_t _useCounter;
+		size_t _readCount;
+		SRWLOCK _lock;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source that is cached. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] pageCount:
+		// Maximum amount of cached pages.
+		PageCache(IMemorySource* pSource, size_t pageCount = 0x40u);
+
+		PageCache(PageCache&&) = delete;
+
+		PageCache(const PageCache&) = delete;
+
+		PageCache& operator=(PageCache&&) = delete;
+
+		PageCache& operator=(const PageCache&) = delete;
+
+		~PageCache();
+
+		virtual bool queryRegion(const void* address, MemoryRegion* pRegion) override;
+		// Reads memory through the cache. Reads that span more pages than the cache can hold bypass it.
+		virtual bool read(const void* address, void* buffer, size_t size) override;
+		// Protected memory is not cached, the read is passed to the underlying source.
+		virtual bool readProtected(const void* address, void* buffer, size_t size) override;
+		virtual const BYTE* view(const void* address, size_t size) override;
+
+		// Drops all cached pages.
+		void invalidate();
+
+		// Gets the amount of reads of the underlying source since the object was constructed.
+		// 
+		// Return:
+		// The amount of reads, which is the amount of system calls for external processes.
+		size_t readCount() const;
+
+	private:
+		// reads through the cache, the lock has to be held
+		bool readCached(const void* address, void* buffer, size_t size);
+		// gets the cached page that contains a range within a single page, nullptr if the range can not be served from the cache
+		const BYTE* getPage(const BYTE* address, size_t size);
+	};
+
+}
@@ -0,0 +1,322 @@
+#include "ParallelSigScanner.h"
+#include "SigScanner.h"
+#include "..\Vector.h"
+
+namespace hax {
+
+	typedef struct ScanTask {
+		// first address a match may start at
+		const BYTE* start;
+		// amount of addresses matches may start at
+		size_t size;
+		// amount of bytes that are read, includes the bytes needed for matches starting at the end of the task
+		size_t readSize;
+		Vector<void*> matches;
+		bool complete;
+	}ScanTask;
+
+	// state shared by all worker threads of a scan
+	typedef struct ScanJob {
+		IMemorySource* pSource;
+		const mem::Signature* pSignature;
+		ScanTask* tasks;
+		LONG taskCount;
+		volatile LONG nextTask;
+		// index of the lowest task with a match, only maintained when looking for the first match
+		volatile LONG firstMatchTask;
+		bool firstOnly;
+		volatile LONG* pCanceled;
+		// only one worker thread at a time may change the protection of memory
+		SRWLOCK protectedReadLock;
+	}ScanJob;
+
+	// the task a worker thread currently scans
+	typedef struct TaskScan {
+		ScanJob* pJob;
+		ScanTask* pTask;
+	}TaskScan;
+
+	static DWORD WINAPI scanThread(void* pArg);
+	static bool collectMatch(void* address, void* pArg);
+	static size_t getProcessorCount();
+	// splits a run of accessable memory into tasks
+	static void addTasks(Vector<ScanTask>* pTasks, const BYTE* start, const BYTE* end, size_t sigSize, size_t taskSize);
+
+	ParallelSigScanner::WorkerSource::WorkerSource(IMemorySource* pSource, SRWLOCK* pLock) : _pSource{ pSource }, _pLock{ pLock } {}
+
+
+	bool ParallelSigScanner::WorkerSource::queryRegion(const void* address, MemoryRegion* pRegion) {
+
+		return this->_pSource->queryRegion(address, pRegion);
+	}
+
+
+	bool ParallelSigScanner::WorkerSource::read(const void* address, void* buffer, size_t size) {
+
+		return this->_pSource->read(address, buffer, size);
+	}
+
+
+	bool ParallelSigScanner::WorkerSource::readProtected(const void* address, void* buffer, size_t size) {
+		AcquireSRWLockExclusive(this->_pLock);
+		const bool read = this->_pSource->readProtected(address, buffer, size);
+		ReleaseSRWLockExclusive(this->_pLock);
+
+		return read;
+	}
+
+
+	const BYTE* ParallelSigScanner::WorkerSource::view(const void* address, size_t size) {
+
+		return this->_pSource->view(address, size);
+	}
+
+
+	ParallelSigScanner::ParallelSigScanner(IMemorySource* pSource, size_t threadCount, size_t taskSize) :
+		_pSource{ pSource }, _threadCount{ threadCount ? threadCount : getProcessorCount() }, _taskSize{ taskSize }, _canceled{} {}
+
+
+	const BYTE* ParallelSigScanner::find(const void* base, size_t size, const mem::Signature& signature) {
+		const BYTE* match = nullptr;
+		this->scan(base, size, &signature, true, nullptr, &match);
+
+		return match;
+	}
+
+
+	size_t ParallelSigScanner::findAll(const void* base, size_t size, const mem::Signature& signature, mem::tMatchCallback callback, void* pArg) {
+
+		if (!callback) return 0u;
+
+		return this->scan(base, size, &signature, false, callback, pArg);
+	}
+
+
+	void ParallelSigScanner::cancel() {
+		InterlockedExchange(&this->_canceled, 1l);
+
+		return;
+	}
+
+
+	bool ParallelSigScanner::canceled() const {
+
+		return this->_canceled != 0l;
+	}
+
+
+	size_t ParallelSigScanner::scan(const void* base, size_t size, const mem::Signature* pSignature, bool firstOnly, mem::tMatchCallback callback, void* pArg) {
+		InterlockedExchange(&this->_canceled, 0l);
+
+		if (!this->_pSource || !pSignature->valid() || !this->_taskSize) return 0u;
+
+		const size_t sigSize = pSignature->size();
+		const BYTE* cur = reinterpret_cast<const BYTE*>(base);
+		const BYTE* const end = size > UINTPTR_MAX - reinterpret_cast<uintptr_t>(cur) ? reinterpret_cast<const BYTE*>(UINTPTR_MAX) : cur + size;
+
+		// accessable memory is merged into runs of contiguous regions, matches can cross regions within a run but not between runs
+		Vector<ScanTask> tasks;
+		const BYTE* runStart = nullptr;
+
+		while (cur < end) {
+			MemoryRegion region{};
+
+			if (!this->_pSource->queryRegion(cur, &region)) break;
+
+			const BYTE* regionEnd = region.base + region.size;
+
+			if (regionEnd <= cur) break;
+
+			if (regionEnd > end) {
+				regionEnd = end;
+			}
+
+			if (region.access == REGION_NO_ACCESS) {
+
+				if (runStart) {
+					addTasks(&tasks, runStart, cur, sigSize, this->_taskSize);
+					runStart = nullptr;
+				}
+
+			}
+			else if (!runStart) {
+				runStart = cur;
+			}
+
+			cur = regionEnd;
+		}
+
+		if (runStart) {
+			addTasks(&tasks, runStart, cur, sigSize, this->_taskSize);
+		}
+
+		if (!tasks.size() || tasks.size() > LONG_MAX) return 0u;
+
+		ScanJob job{};
+		job.pSource = this->_pSource;
+		job.pSignature = pSignature;
+		job.tasks = tasks.data();
+		job.taskCount = static_cast<LONG>(tasks.size());
+		job.firstMatchTask = LONG_MAX;
+		job.firstOnly = firstOnly;
+		job.pCanceled = &this->_canceled;
+		InitializeSRWLock(&job.protectedReadLock);
+
+		size_t threadCount = this->_threadCount < tasks.size() ? this->_threadCount : tasks.size();
+
+		if (threadCount > MAXIMUM_WAIT_OBJECTS) {
+			threadCount = MAXIMUM_WAIT_OBJECTS;
+		}
+
+		HANDLE hThreads[MAXIMUM_WAIT_OBJECTS]{};
+		DWORD createdThreads = 0ul;
+
+		for (size_t i = 0u; i < threadCount; i++) {
+			const HANDLE hThread = CreateThread(nullptr, 0u, scanThread, &job, 0ul, nullptr);
+
+			if (!hThread) break;
+
+			hThreads[createdThreads] = hThread;
+			createdThreads++;
+		}
+
+		// scan on the calling thread if no worker thread could be created
+		if (!createdThreads) {
+			scanThread(&job);
+		}
+		else {
+			WaitForMultipleObjects(createdThreads, hThreads, TRUE, INFINITE);
+
+			for (DWORD i = 0ul; i < createdThreads; i++) {
+				CloseHandle(hThreads[i]);
+			}
+
+		}
+
+		size_t count = 0u;
+
+		// deliver the matches task by task in ascending order and stop at the first task that did not complete
+		for (size_t i = 0u; i < tasks.size() && tasks[i].complete; i++) {
+			const Vector<void*>& matches = tasks[i].matches;
+
+			if (firstOnly) {
+
+				if (!matches.size()) continue;
+
+				*reinterpret_cast<const BYTE**>(pArg) = reinterpret_cast<const BYTE*>(matches[0]);
+				count = 1u;
+
+				break;
+			}
+
+			bool stopped = false;
+
+			for (size_t j = 0u; j < matches.size(); j++) {
+				count++;
+
+				if (!callback(matches[j], pArg)) {
+					stopped = true;
+
+					break;
+				}
+
+			}
+
+			if (stopped) break;
+
+		}
+
+		return count;
+	}
+
+
+	static DWORD WINAPI scanThread(void* pArg) {
+		ScanJob* const pJob = reinterpret_cast<ScanJob*>(pArg);
+		ParallelSigScanner::WorkerSource source(pJob->pSource, &pJob->protectedReadLock);
+		SigScanner scanner(&source);
+
+		while (!*pJob->pCanceled) {
+			const LONG index = InterlockedIncrement(&pJob->nextTask) - 1l;
+
+			if (index >= pJob->taskCount) break;
+
+			ScanTask* const pTask = &pJob->tasks[index];
+
+			// a task at a lower address already has a match, so this task can not contain the first one
+			if (pJob->firstOnly && index > pJob->firstMatchTask) {
+				pTask->complete = true;
+
+				continue;
+			}
+
+			TaskScan taskScan{ pJob, pTask };
+			scanner.findAll(pTask->start, pTask->readSize, *pJob->pSignature, collectMatch, &taskScan);
+
+			if (*pJob->pCanceled) break;
+
+			pTask->complete = true;
+
+			if (!pJob->firstOnly || !pTask->matches.size()) continue;
+
+			LONG firstMatchTask = pJob->firstMatchTask;
+
+			// lower the index of the first task with a match if this task is lower
+			while (index < firstMatchTask) {
+				const LONG prevFirstMatchTask = InterlockedCompareExchange(&pJob->firstMatchTask, index, firstMatchTask);
+
+				if (prevFirstMatchTask == firstMatchTask) break;
+
+				firstMatchTask = prevFirstMatchTask;
+			}
+
+		}
+
+		return 0ul;
+	}
+
+
+	static bool collectMatch(void* address, void* pArg) {
+		TaskScan* const pTaskScan = reinterpret_cast<TaskScan*>(pArg);
+		ScanTask* const pTask = pTaskScan->pTask;
+
+		// matches starting in the overlap belong to the next task
+		if (reinterpret_cast<const BYTE*>(address) >= pTask->start + pTask->size) return false;
+
+		pTask->matches.append(address);
+
+		if (pTaskScan->pJob->firstOnly) return false;
+
+		return !*pTaskScan->pJob->pCanceled;
+	}
+
+
+	static void addTasks(Vector<ScanTask>* pTasks, const BYTE* start, const BYTE* end, size_t sigSize, size_t taskSize) {
+
+		for (const BYTE* taskStart = start; taskStart < end; taskStart += taskSize) {
+			const size_t rest = end - taskStart;
+
+			// matches have to fit into the run
+			if (rest < sigSize) break;
+
+			ScanTask task{};
+			task.start = taskStart;
+			task.size = rest < taskSize ? rest : taskSize;
+			task.readSize = rest < task.size + sigSize - 1u ? rest : task.size + sigSize - 1u;
+			pTasks->append(task);
+
+			if (rest <= taskSize) break;
+
+		}
+
+		return;
+	}
+
+
+	static size_t getProcessorCount() {
+		SYSTEM_INFO sysInfo{};
+		GetSystemInfo(&sysInfo);
+
+		return sysInfo.dwNumberOfProcessors ? sysInfo.dwNumberOfProcessors : 1u;
+	}
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "IMemorySource.h"
+#include "..\mem.h"
+
+namespace hax {
+
+	// Class to scan large parts of the memory of a memory source for byte signatures on multiple worker threads.
+	// The accessable memory is split into tasks of equal size that are distributed among the worker threads. Each worker thread reads with its own SigScanner.
+	// Results are always delivered in ascending order of the addresses, independent of the order the tasks finish in.
+	// Reads of protected memory change the protection temporarily and overlapping tasks may read the same page, so these reads are serialized among the worker threads.
+	// All other calls of the memory source are made concurrently. The memory sources of the library support this, PageCache by locking the cache for every call.
+	class ParallelSigScanner {
+	public:
+		// Default amount of memory a worker thread scans per task.
+		static constexpr size_t DEFAULT_TASK_SIZE = 0x400000u;
+
+	private:
+		IMemorySource* const _pSource;
+		const size_t _threadCount;
+		const size_t _taskSize;
+		volatile LONG _canceled;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source that should be scanned. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] threadCount:
+		// Maximum number of worker threads. Zero for one worker thread per logical processor.
+		// 
+		// [in] taskSize:
+		// Amount of memory a worker thread scans per task.
+		ParallelSigScanner(IMemorySource* pSource, size_t threadCount = 0u, size_t taskSize = DEFAULT_TASK_SIZE);
+
+		ParallelSigScanner(ParallelSigScanner&&) = delete;
+
+		ParallelSigScanner(const ParallelSigScanner&) = delete;
+
+		ParallelSigScanner& operator=(ParallelSigScanner&&) = delete;
+
+		ParallelSigScanner& operator=(const ParallelSigScanner&) = delete;
+
+		// Finds the lowest address of a byte signature within the memory source.
+		// Tasks at higher addresses than a task with a match are skipped.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] signature:
+		// The byte signature that should be looked for.
+		// 
+		// Return:
+		// The address where the byte signature was found within the address space of the memory source.
+		// Nullpointer if the signature was not found, the scan was canceled before a match was guaranteed to be the lowest or the function failed.
+		const BYTE* find(const void* base, size_t size, const mem::Signature& signature);
+
+		// Finds all addresses of a byte signature within the memory source.
+		// The callback is called on the calling thread after all worker threads finished.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] signature:
+		// The byte signature that should be looked for.
+		// 
+		// [in] callback:
+		// Called for every match in ascending order of the addresses within the address space of the memory source until it returns false.
+		// If the scan was canceled, only the matches below the first task that did not finish are passed.
+		// 
+		// [in] pArg:
+		// Argument passed to the callback.
+		// 
+		// Return:
+		// The number of matches passed to the callback.
+		size_t findAll(const void* base, size_t size, const mem::Signature& signature, mem::tMatchCallback callback, void* pArg);
+
+		// Cancels the scan that is currently running. Can be called from any thread.
+		// The worker threads finish at most their current task and the scan returns the results that are complete up to that point.
+		void cancel();
+
+		// Checks if the last scan was canceled.
+		// 
+		// Return:
+		// True if the last scan was canceled, false otherwise.
+		bool canceled() const;
+
+		// Memory source of a worker thread that forwards to the scanned memory source and serializes the reads of protected memory of all worker threads.
+		// Otherwise a worker thread could save the temporary protection set by another worker thread as the original protection and restore it.
+		class WorkerSource : public IMemorySource {
+		private:
+			IMemorySource* const _pSource;
+			SRWLOCK* const _pLock;
+
+		public:
+			WorkerSource(IMemorySource* pSource, SRWLOCK* pLock);
+
+			virtual bool queryRegion(const void* address, MemoryRegion* pRegion) override;
+			virtual bool read(const void* address, void* buffer, size_t size) override;
+			virtual bool readProtected(const void* address, void* buffer, size_t size) override;
+			virtual const BYTE* view(const void* address, size_t size) override;
+		};
+
+	private:
+		size_t scan(const void* base, size_t size, const mem::Signature* pSignature, bool firstOnly, mem::tMatchCallback callback, void* pArg);
+	};
+
+}
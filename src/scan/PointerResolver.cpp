@@ -0,0 +1,218 @@
+#include "PointerResolver.h"
+#include <stdlib.h>
+
+namespace hax {
+
+	// marks the parent of roots and the end of sibling lists
+	static constexpr size_t NO_NODE = SIZE_MAX;
+	// pointers within the same page are read at once
+	static constexpr uintptr_t PAGE_SIZE = 0x1000u;
+
+	PointerResolver::PointerResolver(IMemorySource* pSource, uintptr_t minAddress) :
+		_pSource{ pSource }, _minAddress{ minAddress }, _nodes{}, _chains{}, _requests{}, _firstRoot{ NO_NODE }, _frame{ 1u }, _buffer{} {
+		this->_buffer = new BYTE[PAGE_SIZE];
+
+		return;
+	}
+
+
+	PointerResolver::~PointerResolver() {
+		delete[] this->_buffer;
+
+		return;
+	}
+
+
+	size_t PointerResolver::addChain(const void* base, const size_t* offsets, size_t size) {
+		size_t node = this->addNode(NO_NODE, reinterpret_cast<uintptr_t>(base));
+
+		for (size_t i = 0u; i < size; i++) {
+			node = this->addNode(node, offsets[i]);
+		}
+
+		this->_chains.append(node);
+
+		return this->_chains.size() - 1u;
+	}
+
+
+	size_t PointerResolver::resolve() {
+
+		if (!this->_pSource) return 0u;
+
+		size_t readCount = 0u;
+
+		// every pass reads the pointers of the nodes whose parents got resolved in the last pass, which is one level of the tree
+		while (true) {
+			this->_requests.resize(0u);
+
+			// parents are always added before their children, so failures are passed down the tree within a single pass
+			for (size_t i = 0u; i < this->_nodes.size(); i++) {
+				ChainNode* const pNode = this->_nodes + i;
+
+				if (pNode->frame == this->_frame) continue;
+
+				if (pNode->parent == NO_NODE) {
+					pNode->address = reinterpret_cast<BYTE*>(pNode->offset);
+					pNode->frame = this->_frame;
+					pNode->valid = true;
+
+					continue;
+				}
+
+				const ChainNode* const pParent = this->_nodes + pNode->parent;
+
+				if (pParent->frame != this->_frame) continue;
+
+				if (!pParent->valid || reinterpret_cast<uintptr_t>(pParent->address) < this->_minAddress) {
+					pNode->address = nullptr;
+					pNode->frame = this->_frame;
+					pNode->valid = false;
+
+					continue;
+				}
+
+				this->_requests.append(ReadRequest{ pParent->address, i });
+			}
+
+			if (!this->_requests.size()) break;
+
+			readCount += this->readRequests();
+		}
+
+		return readCount;
+	}
+
+
+	void* PointerResolver::getAddress(size_t chain) const {
+
+		if (chain >= this->_chains.size()) return nullptr;
+
+		const ChainNode* const pNode = this->_nodes + this->_chains[chain];
+
+		if (pNode->frame != this->_frame || !pNode->valid) return nullptr;
+
+		return pNode->address;
+	}
+
+
+	void PointerResolver::invalidate() {
+		this->_frame++;
+
+		return;
+	}
+
+
+	size_t PointerResolver::chainCount() const {
+
+		return this->_chains.size();
+	}
+
+
+	size_t PointerResolver::pointerCount() const {
+		size_t rootCount = 0u;
+
+		for (size_t root = this->_firstRoot; root != NO_NODE; root = this->_nodes[root].nextSibling) {
+			rootCount++;
+		}
+
+		return this->_nodes.size() - rootCount;
+	}
+
+
+	void PointerResolver::clear() {
+		this->_nodes.resize(0u);
+		this->_chains.resize(0u);
+		this->_requests.resize(0u);
+		this->_firstRoot = NO_NODE;
+
+		return;
+	}
+
+
+	size_t PointerResolver::addNode(size_t parent, uintptr_t offset) {
+		size_t* pFirst = parent == NO_NODE ? &this->_firstRoot : &this->_nodes[parent].firstChild;
+
+		for (size_t node = *pFirst; node != NO_NODE; node = this->_nodes[node].nextSibling) {
+
+			if (this->_nodes[node].offset == offset) return node;
+
+		}
+
+		const size_t node = this->_nodes.size();
+		// a new node is not resolved in any frame yet
+		this->_nodes.append(ChainNode{ offset, parent, NO_NODE, *pFirst, nullptr, 0u, false });
+
+		// the vector might have been reallocated by the append
+		pFirst = parent == NO_NODE ? &this->_firstRoot : &this->_nodes[parent].firstChild;
+		*pFirst = node;
+
+		return node;
+	}
+
+
+	size_t PointerResolver::readRequests() {
+		ReadRequest* const requests = this->_requests.data();
+		const size_t count = this->_requests.size();
+
+		qsort(requests, count, sizeof(ReadRequest), compareRequests);
+
+		size_t readCount = 0u;
+		size_t first = 0u;
+
+		while (first < count) {
+			const BYTE* const start = requests[first].address;
+			const uintptr_t pageEnd = (reinterpret_cast<uintptr_t>(start) | (PAGE_SIZE - 1u)) + 1u;
+			// a pointer that crosses a page boundary is read on its own
+			const uintptr_t limit = pageEnd > reinterpret_cast<uintptr_t>(start) + sizeof(BYTE*) ? pageEnd : reinterpret_cast<uintptr_t>(start) + sizeof(BYTE*);
+			size_t last = first + 1u;
+
+			while (last < count && reinterpret_cast<uintptr_t>(requests[last].address) + sizeof(BYTE*) <= limit) {
+				last++;
+			}
+
+			const size_t size = requests[last - 1u].address + sizeof(BYTE*) - start;
+			// memory of the caller process can be accessed in place, the source checks that the range is readable
+			const BYTE* data = this->_pSource->view(start, size);
+
+			if (!data) {
+				data = this->_pSource->read(start, this->_buffer, size) ? this->_buffer : nullptr;
+				readCount++;
+			}
+
+			for (size_t i = first; i < last; i++) {
+				ChainNode* const pNode = this->_nodes + requests[i].node;
+				pNode->frame = this->_frame;
+
+				if (data) {
+					BYTE* pointer = nullptr;
+					memcpy(&pointer, data + (requests[i].address - start), sizeof(BYTE*));
+					pNode->address = pointer + pNode->offset;
+					pNode->valid = true;
+				}
+				else {
+					pNode->address = nullptr;
+					pNode->valid = false;
+				}
+
+			}
+
+			first = last;
+		}
+
+		return readCount;
+	}
+
+
+	int PointerResolver::compareRequests(const void* pRequest1, const void* pRequest2) {
+		const BYTE* const address1 = reinterpret_cast<const ReadRequest*>(pRequest1)->address;
+		const BYTE* const address2 = reinterpret_cast<const ReadRequest*>(pRequest2)->address;
+
+		if (address1 < address2) return -1;
+
+		if (address1 > address2) return 1;
+
+		return 0;
+	}
+
+}
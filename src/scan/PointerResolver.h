@@ -0,0 +1,140 @@
+#pragma once
+#include "IMemorySource.h"
+#include "..\Vector.h"
+#include <stdint.h>
+
+namespace hax {
+
+	// Class to resolve many multi level pointers of a memory source at once.
+	// Chains are merged into a tree, so chains that share a base and leading offsets read their common pointers only once.
+	// All pointers of one level of the tree are read together. Reads that lie within the same page are coalesced into a single read of the source.
+	// Resolved pointers are cached until the cache is invalidated, typically once per frame.
+	// Every pointer of a chain is validated by the memory source before it is dereferenced, also for an in::MemorySource,
+	// so chains that run into stale or garbage pointers of the caller process fail instead of raising an access violation.
+	// Example:
+	// hax::ex::MemorySource source(hProc);
+	// hax::PointerResolver resolver(&source);
+	// const size_t healthChain = resolver.addChain(pLocalPlayer, healthOffsets, _countof(healthOffsets));
+	// // every frame:
+	// resolver.invalidate();
+	// const size_t readCount = resolver.resolve();
+	// void* const pHealth = resolver.getAddress(healthChain);
+	class PointerResolver {
+	public:
+		// The first 64 KB of an address space are never mapped on Windows.
+		static constexpr uintptr_t DEFAULT_MIN_ADDRESS = 0x10000u;
+
+	private:
+		typedef struct ChainNode {
+			// the base address for roots, the offset added to the pointer read at the address of the parent otherwise
+			uintptr_t offset;
+			size_t parent;
+			size_t firstChild;
+			size_t nextSibling;
+			// the address the chain points to up to this node
+			BYTE* address;
+			// frame the address was resolved in
+			size_t frame;
+			bool valid;
+		}ChainNode;
+
+		typedef struct ReadRequest {
+			const BYTE* address;
+			size_t node;
+		}ReadRequest;
+
+		IMemorySource* const _pSource;
+		const uintptr_t _minAddress;
+		Vector<ChainNode> _nodes;
+		// index of the last node of every chain
+		Vector<size_t> _chains;
+		Vector<ReadRequest> _requests;
+		size_t _firstRoot;
+		size_t _frame;
+		BYTE* _buffer;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source the pointers are read from. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] minAddress:
+		// Lowest address that can be mapped in the memory source. Pointers below it fail without a read.
+		// Zero for memory sources that pose at low addresses, eg. a BufferMemorySource.
+		PointerResolver(IMemorySource* pSource, uintptr_t minAddress = DEFAULT_MIN_ADDRESS);
+
+		PointerResolver(PointerResolver&&) = delete;
+
+		PointerResolver(const PointerResolver&) = delete;
+
+		PointerResolver& operator=(PointerResolver&&) = delete;
+
+		PointerResolver& operator=(const PointerResolver&) = delete;
+
+		~PointerResolver();
+
+		// Adds a multi level pointer that is resolved by following calls to resolve.
+		// The chain is resolved the same way as by mem::ex::getMultiLevelPointer.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// The base pointer within the address space of the memory source. This is typically a static address.
+		// 
+		// [in] offsets:
+		// Buffer for the offsets.
+		// 
+		// [in] size:
+		// Size of the offset buffer.
+		// 
+		// Return:
+		// The index of the chain that is used to get its address.
+		size_t addChain(const void* base, const size_t* offsets, size_t size);
+
+		// Resolves all chains that are not resolved in the current frame yet.
+		// Pointers that were already resolved in the current frame are taken from the cache, so chains added during a frame are cheap to resolve.
+		// 
+		// Return:
+		// The amount of reads of the memory source, which is the amount of system calls for external processes.
+		size_t resolve();
+
+		// Gets the resolved address of a chain.
+		// 
+		// Parameters:
+		// 
+		// [in] chain:
+		// Index of the chain returned by addChain.
+		// 
+		// Return:
+		// The address pointed to by the chain or nullptr if a pointer could not be read or the chain was not resolved in the current frame.
+		void* getAddress(size_t chain) const;
+
+		// Invalidates all cached pointers, so the next call to resolve reads them again. Should be called once per frame.
+		void invalidate();
+
+		// Gets the amount of added chains.
+		// 
+		// Return:
+		// The amount of chains.
+		size_t chainCount() const;
+
+		// Gets the amount of distinct pointers of all chains after merging shared prefixes.
+		// 
+		// Return:
+		// The amount of nodes of the chain tree without the bases.
+		size_t pointerCount() const;
+
+		// Removes all chains.
+		void clear();
+
+	private:
+		size_t addNode(size_t parent, uintptr_t offset);
+		size_t readRequests();
+		// orders read requests by address for qsort
+		static int compareRequests(const void* pRequest1, const void* pRequest2);
+	};
+
+}
@@ -0,0 +1,190 @@
+#include "ReadBatch.h"
+#include <stdlib.h>
+
+namespace hax {
+
+	static constexpr size_t PAGE_SIZE = 0x1000u;
+
+	static uintptr_t getPageIndex(const BYTE* address);
+
+	ReadBatch::ReadBatch(IMemorySource* pSource, size_t maxSpan) :
+		_pSource{ pSource }, _maxSpan{ maxSpan ? (maxSpan + PAGE_SIZE - 1u) & ~(PAGE_SIZE - 1u) : PAGE_SIZE }, _requests{}, _buffer{}, _readCount{} {
+		this->_buffer = new BYTE[this->_maxSpan];
+
+		return;
+	}
+
+
+	ReadBatch::~ReadBatch() {
+		delete[] this->_buffer;
+
+		return;
+	}
+
+
+	void ReadBatch::add(const void* address, void* buffer, size_t size, bool* pSuccess) {
+
+		if (pSuccess) {
+			*pSuccess = false;
+		}
+
+		// empty reads always succeed and would only get in the way of merging
+		if (!size) {
+
+			if (pSuccess) {
+				*pSuccess = true;
+			}
+
+			return;
+		}
+
+		this->_requests.append(ReadRequest{ reinterpret_cast<const BYTE*>(address), reinterpret_cast<BYTE*>(buffer), size, pSuccess });
+
+		return;
+	}
+
+
+	bool ReadBatch::execute() {
+		this->_readCount = 0u;
+
+		ReadRequest* const requests = this->_requests.data();
+		const size_t count = this->_requests.size();
+
+		if (!this->_pSource) {
+			this->_requests.resize(0u);
+
+			return !count;
+		}
+
+		qsort(requests, count, sizeof(ReadRequest), compareRequests);
+
+		bool success = true;
+		size_t first = 0u;
+
+		while (first < count) {
+			const BYTE* const start = requests[first].address;
+			const BYTE* end = start + requests[first].size;
+			size_t last = first + 1u;
+
+			while (last < count) {
+				const ReadRequest* const pNext = requests + last;
+
+				// reads are merged if the gap between them is less than a page
+				if (getPageIndex(pNext->address) > getPageIndex(end - 1u) + 1u) break;
+
+				const BYTE* const nextEnd = pNext->address + pNext->size > end ? pNext->address + pNext->size : end;
+
+				if (static_cast<size_t>(nextEnd - start) > this->_maxSpan) break;
+
+				end = nextEnd;
+				last++;
+			}
+
+			if (!this->readSpan(requests + first, last - first, start, end - start)) {
+				success = false;
+			}
+
+			first = last;
+		}
+
+		this->_requests.resize(0u);
+
+		return success;
+	}
+
+
+	size_t ReadBatch::readCount() const {
+
+		return this->_readCount;
+	}
+
+
+	size_t ReadBatch::queuedCount() const {
+
+		return this->_requests.size();
+	}
+
+
+	bool ReadBatch::readSpan(const ReadRequest* requests, size_t count, const BYTE* start, size_t size) {
+
+		if (count == 1u) return this->readSingle(requests);
+
+		// memory of the caller process can be accessed in place, the source checks that the whole span is readable
+		const BYTE* data = this->_pSource->view(start, size);
+
+		if (!data) {
+			this->_readCount++;
+
+			if (this->_pSource->read(start, this->_buffer, size)) {
+				data = this->_buffer;
+			}
+
+		}
+
+		if (!data) {
+			// parts of the span might be inaccessible, so the reads are retried one by one
+			bool success = true;
+
+			for (size_t i = 0u; i < count; i++) {
+
+				if (!this->readSingle(requests + i)) {
+					success = false;
+				}
+
+			}
+
+			return success;
+		}
+
+		for (size_t i = 0u; i < count; i++) {
+			memcpy(requests[i].buffer, data + (requests[i].address - start), requests[i].size);
+
+			if (requests[i].pSuccess) {
+				*requests[i].pSuccess = true;
+			}
+
+		}
+
+		return true;
+	}
+
+
+	bool ReadBatch::readSingle(const ReadRequest* pRequest) {
+		const BYTE* const data = this->_pSource->view(pRequest->address, pRequest->size);
+		bool success = false;
+
+		if (data) {
+			memcpy(pRequest->buffer, data, pRequest->size);
+			success = true;
+		}
+		else {
+			this->_readCount++;
+			success = this->_pSource->read(pRequest->address, pRequest->buffer, pRequest->size);
+		}
+
+		if (pRequest->pSuccess) {
+			*pRequest->pSuccess = success;
+		}
+
+		return success;
+	}
+
+
+	int ReadBatch::compareRequests(const void* pRequest1, const void* pRequest2) {
+		const BYTE* const address1 = reinterpret_cast<const ReadRequest*>(pRequest1)->address;
+		const BYTE* const address2 = reinterpret_cast<const ReadRequest*>(pRequest2)->address;
+
+		if (address1 < address2) return -1;
+
+		if (address1 > address2) return 1;
+
+		return 0;
+	}
+
+
+	static uintptr_t getPageIndex(const BYTE* address) {
+
+		return reinterpret_cast<uintptr_t>(address) / PAGE_SIZE;
+	}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "IMemorySource.h"
+#include "..\Vector.h"
+
+namespace hax {
+
+	// Class to combine many small reads of a memory source into few large ones.
+	// Reads are queued and executed at once. Queued reads are sorted by address and reads within the same or neighbouring pages are merged into one read of the source.
+	// The merged memory is scattered back into the buffers of the queued reads.
+	// Ranges are validated by the memory source before they are accessed, also for an in::MemorySource, so reads of unmapped or guarded memory fail instead of raising an access violation.
+	// Example:
+	// hax::ex::MemorySource source(hProc);
+	// hax::ReadBatch batch(&source);
+	// batch.add(pHealth, &health, sizeof(health));
+	// batch.add(pPosition, &position, sizeof(position));
+	// const bool success = batch.execute();
+	class ReadBatch {
+	private:
+		typedef struct ReadRequest {
+			const BYTE* address;
+			BYTE* buffer;
+			size_t size;
+			bool* pSuccess;
+		}ReadRequest;
+
+		IMemorySource* const _pSource;
+		const size_t _maxSpan;
+		Vector<ReadRequest> _requests;
+		BYTE* _buffer;
+		size_t _readCount;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source that is read. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] maxSpan:
+		// Maximum amount of bytes read at once when merging reads. Rounded up to the page size.
+		ReadBatch(IMemorySource* pSource, size_t maxSpan = 0x10000u);
+
+		ReadBatch(ReadBatch&&) = delete;
+
+		ReadBatch(const ReadBatch&) = delete;
+
+		ReadBatch& operator=(ReadBatch&&) = delete;
+
+		ReadBatch& operator=(const ReadBatch&) = delete;
+
+		~ReadBatch();
+
+		// Queues a read that is done by the next call to execute.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address to read from.
+		// 
+		// [out] buffer:
+		// Buffer that receives the memory. Has to stay valid until the batch is executed.
+		// 
+		// [in] size:
+		// Amount of bytes to read.
+		// 
+		// [out] pSuccess:
+		// Optional pointer that receives if the read succeeded when the batch is executed.
+		void add(const void* address, void* buffer, size_t size, bool* pSuccess = nullptr);
+
+		// Executes all queued reads and clears the queue.
+		// If a merged read fails, the reads it was merged from are retried one by one, so only reads of inaccessible memory fail.
+		// 
+		// Return:
+		// True if all queued reads succeeded, false otherwise.
+		bool execute();
+
+		// Gets the amount of reads of the memory source by the last call to execute.
+		// 
+		// Return:
+		// The amount of reads, which is the amount of system calls for external processes.
+		size_t readCount() const;
+
+		// Gets the amount of queued reads.
+		// 
+		// Return:
+		// The amount of reads that are done by the next call to execute.
+		size_t queuedCount() const;
+
+	private:
+		bool readSpan(const ReadRequest* requests, size_t count, const BYTE* start, size_t size);
+		bool readSingle(const ReadRequest* pRequest);
+		// orders read requests by address for qsort
+		static int compareRequests(const void* pRequest1, const void* pRequest2);
+	};
+
+}
@@ -0,0 +1,304 @@
+#include "SigScanner.h"
+
+namespace hax {
+
+	// reports all matches within a buffer that holds the memory at an address of the memory source, false if the callback stopped the scan
+	static bool reportMatches(const BYTE* buffer, size_t size, const BYTE* address, const SigScanner::Pattern* pPattern, mem::tMatchCallback callback, void* pArg, size_t* pCount);
+	static bool storeFirstMatch(void* address, void* pArg);
+
+	// matches found in the buffer are translated back to the address within the memory source before passing them on
+	typedef struct Translation {
+		const BYTE* buffer;
+		const BYTE* address;
+		mem::tMatchCallback callback;
+		void* pArg;
+		bool stopped;
+	}Translation;
+
+	static bool translateMatch(void* match, void* pArg);
+
+	// state of a scan for a single pattern
+	typedef struct PatternScan {
+		const SigScanner::Pattern* pPattern;
+		mem::tMatchCallback callback;
+		void* pArg;
+		size_t count;
+	}PatternScan;
+
+	static bool scanPattern(const BYTE* buffer, size_t size, const BYTE* address, void* pArg);
+
+	// state of a scan for the first matches of multiple signatures
+	typedef struct MultiScan {
+		const BYTE* const* bytes;
+		const BYTE* const* masks;
+		const size_t* sizes;
+		void** addresses;
+		// addresses found within the current buffer
+		void** inBufferAddresses;
+		size_t count;
+		size_t pending;
+		size_t found;
+	}MultiScan;
+
+	static bool scanSignatures(const BYTE* buffer, size_t size, const BYTE* address, void* pArg);
+
+	SigScanner::SigScanner(IMemorySource* pSource, size_t chunkSize) : _pSource{ pSource }, _chunkSize{ chunkSize }, _buffer{} {
+		this->_buffer = new BYTE[this->_chunkSize];
+
+		return;
+	}
+
+
+	SigScanner::~SigScanner() {
+
+		if (this->_buffer) {
+			delete[] this->_buffer;
+		}
+
+		return;
+	}
+
+
+	const BYTE* SigScanner::find(const void* base, size_t size, const mem::Signature& signature) {
+
+		if (!signature.valid()) return nullptr;
+
+		const Pattern pattern{ signature.bytes(), signature.mask(), signature.size(), &signature };
+		const BYTE* match = nullptr;
+		this->scan(base, size, &pattern, storeFirstMatch, &match);
+
+		return match;
+	}
+
+
+	const BYTE* SigScanner::find(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize) {
+		const Pattern pattern{ bytes, mask, sigSize, nullptr };
+		const BYTE* match = nullptr;
+		this->scan(base, size, &pattern, storeFirstMatch, &match);
+
+		return match;
+	}
+
+
+	size_t SigScanner::findAll(const void* base, size_t size, const mem::Signature& signature, mem::tMatchCallback callback, void* pArg) {
+
+		if (!signature.valid()) return 0u;
+
+		const Pattern pattern{ signature.bytes(), signature.mask(), signature.size(), &signature };
+
+		return this->scan(base, size, &pattern, callback, pArg);
+	}
+
+
+	size_t SigScanner::findAll(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize, mem::tMatchCallback callback, void* pArg) {
+		const Pattern pattern{ bytes, mask, sigSize, nullptr };
+
+		return this->scan(base, size, &pattern, callback, pArg);
+	}
+
+
+	size_t SigScanner::findEach(const void* base, size_t size, const BYTE* const bytes[], const BYTE* const masks[], const size_t sigSizes[], void* addresses[], size_t count) {
+
+		if (!this->_pSource || !this->_buffer || !bytes || !masks || !sigSizes || !addresses || !count) return 0u;
+
+		size_t maxSize = 0u;
+		size_t pending = 0u;
+
+		for (size_t i = 0u; i < count; i++) {
+
+			if (addresses[i]) continue;
+
+			if (sigSizes[i] > maxSize) {
+				maxSize = sigSizes[i];
+			}
+
+			pending++;
+		}
+
+		// the chunk has to fit the kept bytes of the last chunk and at least as many new bytes
+		if (!pending || !maxSize || maxSize > this->_chunkSize / 2u) return 0u;
+
+		MultiScan multiScan{ bytes, masks, sigSizes, addresses, new void*[count]{}, count, pending, 0u };
+		this->walk(base, size, maxSize - 1u, scanSignatures, &multiScan);
+
+		delete[] multiScan.inBufferAddresses;
+
+		return multiScan.found;
+	}
+
+
+	size_t SigScanner::scan(const void* base, size_t size, const Pattern* pPattern, mem::tMatchCallback callback, void* pArg) {
+		const size_t sigSize = pPattern->size;
+
+		// the chunk has to fit the kept bytes of the last chunk and at least as many new bytes
+		if (!this->_pSource || !this->_buffer || !callback || !sigSize || sigSize > this->_chunkSize / 2u) return 0u;
+
+		PatternScan patternScan{ pPattern, callback, pArg, 0u };
+		this->walk(base, size, sigSize - 1u, scanPattern, &patternScan);
+
+		return patternScan.count;
+	}
+
+
+	void SigScanner::walk(const void* base, size_t size, size_t overlap, tScanBuffer scanBuffer, void* pArg) {
+		const BYTE* cur = reinterpret_cast<const BYTE*>(base);
+		const BYTE* const end = size > UINTPTR_MAX - reinterpret_cast<uintptr_t>(cur) ? reinterpret_cast<const BYTE*>(UINTPTR_MAX) : cur + size;
+		// bytes at the end of the last scanned memory kept in front of the buffer to find signatures across chunk and region boundaries
+		size_t carried = 0u;
+
+		while (cur < end) {
+			MemoryRegion region{};
+
+			if (!this->_pSource->queryRegion(cur, &region)) break;
+
+			const BYTE* regionEnd = region.base + region.size;
+
+			if (regionEnd <= cur) break;
+
+			if (regionEnd > end) {
+				regionEnd = end;
+			}
+
+			if (region.access == REGION_NO_ACCESS) {
+				carried = 0u;
+				cur = regionEnd;
+
+				continue;
+			}
+
+			const size_t regionSize = regionEnd - cur;
+			const BYTE* const view = region.access == REGION_READABLE ? this->_pSource->view(cur, regionSize) : nullptr;
+
+			// memory that can be accessed in place is scanned without copying it
+			if (view) {
+
+				if (carried) {
+					// only the first bytes of the region are needed for matches that start in the carried bytes
+					const size_t appended = overlap < regionSize ? overlap : regionSize;
+					memcpy(this->_buffer + carried, view, appended);
+
+					if (!scanBuffer(this->_buffer, carried + appended, cur - carried, pArg)) return;
+
+				}
+
+				if (!scanBuffer(view, regionSize, cur, pArg)) return;
+
+				if (regionSize < overlap) {
+
+					// regions shorter than the signature are appended to the carried bytes
+					if (!carried) {
+						memcpy(this->_buffer, view, regionSize);
+					}
+
+					const size_t filled = carried + regionSize;
+					carried = overlap < filled ? overlap : filled;
+					memmove(this->_buffer, this->_buffer + filled - carried, carried);
+				}
+				else {
+					carried = overlap;
+					memcpy(this->_buffer, view + regionSize - carried, carried);
+				}
+
+				cur = regionEnd;
+
+				continue;
+			}
+
+			while (cur < regionEnd) {
+				const size_t chunk = this->_chunkSize - carried < static_cast<size_t>(regionEnd - cur) ? this->_chunkSize - carried : regionEnd - cur;
+
+				bool read = false;
+
+				if (region.access == REGION_READABLE) {
+					read = this->_pSource->read(cur, this->_buffer + carried, chunk);
+				}
+				else {
+					read = this->_pSource->readProtected(cur, this->_buffer + carried, chunk);
+				}
+
+				if (!read) {
+					carried = 0u;
+					cur += chunk;
+
+					continue;
+				}
+
+				const size_t filled = carried + chunk;
+
+				if (!scanBuffer(this->_buffer, filled, cur - carried, pArg)) return;
+
+				carried = overlap < filled ? overlap : filled;
+				memmove(this->_buffer, this->_buffer + filled - carried, carried);
+				cur += chunk;
+			}
+
+		}
+
+		return;
+	}
+
+
+	static bool reportMatches(const BYTE* buffer, size_t size, const BYTE* address, const SigScanner::Pattern* pPattern, mem::tMatchCallback callback, void* pArg, size_t* pCount) {
+		Translation translation{ buffer, address, callback, pArg, false };
+
+		if (pPattern->pSignature) {
+			*pCount += mem::helper::findAllSignatures(buffer, size, *pPattern->pSignature, translateMatch, &translation);
+		}
+		else {
+			*pCount += mem::helper::findAllSignatures(buffer, size, pPattern->bytes, pPattern->mask, pPattern->size, translateMatch, &translation);
+		}
+
+		return !translation.stopped;
+	}
+
+
+	static bool scanPattern(const BYTE* buffer, size_t size, const BYTE* address, void* pArg) {
+		PatternScan* const pScan = reinterpret_cast<PatternScan*>(pArg);
+
+		return reportMatches(buffer, size, address, pScan->pPattern, pScan->callback, pScan->pArg, &pScan->count);
+	}
+
+
+	static bool scanSignatures(const BYTE* buffer, size_t size, const BYTE* address, void* pArg) {
+		MultiScan* const pScan = reinterpret_cast<MultiScan*>(pArg);
+
+		// signatures that were already found are skipped by the buffer scan
+		for (size_t i = 0u; i < pScan->count; i++) {
+			pScan->inBufferAddresses[i] = pScan->addresses[i];
+		}
+
+		const size_t found = mem::helper::findSignatures(buffer, size, pScan->bytes, pScan->masks, pScan->sizes, pScan->inBufferAddresses, pScan->count);
+
+		if (!found) return true;
+
+		// translate the addresses found in this buffer back to the memory source
+		for (size_t i = 0u; i < pScan->count; i++) {
+
+			if (pScan->addresses[i] || !pScan->inBufferAddresses[i]) continue;
+
+			pScan->addresses[i] = const_cast<BYTE*>(address + (reinterpret_cast<BYTE*>(pScan->inBufferAddresses[i]) - buffer));
+		}
+
+		pScan->found += found;
+		pScan->pending -= found;
+
+		return pScan->pending != 0u;
+	}
+
+
+	static bool translateMatch(void* match, void* pArg) {
+		Translation* const pTranslation = reinterpret_cast<Translation*>(pArg);
+		const BYTE* const address = pTranslation->address + (reinterpret_cast<BYTE*>(match) - pTranslation->buffer);
+		pTranslation->stopped = !pTranslation->callback(const_cast<BYTE*>(address), pTranslation->pArg);
+
+		return !pTranslation->stopped;
+	}
+
+
+	static bool storeFirstMatch(void* address, void* pArg) {
+		*reinterpret_cast<const BYTE**>(pArg) = reinterpret_cast<const BYTE*>(address);
+
+		return false;
+	}
+
+}
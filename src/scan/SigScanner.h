@@ -0,0 +1,186 @@
+#pragma once
+#include "IMemorySource.h"
+#include "..\mem.h"
+
+namespace hax {
+
+	// Class to scan the memory of a memory source for byte signatures.
+	// Memory that can not be accessed in place is read in chunks into one buffer that is reused for all reads, so no allocations are done while scanning.
+	// The last bytes of a chunk are kept in front of the next chunk, so signatures that straddle chunk or region boundaries are found as well.
+	// The protection of readable regions is not changed. Only regions that are not readable with their current protection are read with a temporary protection change.
+	class SigScanner {
+	public:
+		// Default size of the chunks memory is read in.
+		static constexpr size_t DEFAULT_CHUNK_SIZE = 0x40000u;
+
+		typedef struct Pattern {
+			const BYTE* bytes;
+			const BYTE* mask;
+			size_t size;
+			// parsed signature the bytes and mask belong to, nullptr for plain bytes and mask
+			const mem::Signature* pSignature;
+		}Pattern;
+
+	private:
+		IMemorySource* const _pSource;
+		const size_t _chunkSize;
+		BYTE* _buffer;
+
+	public:
+		// Initializes members and allocates the chunk buffer.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source that should be scanned. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] chunkSize:
+		// Size of the chunks memory is read in. Signatures may be at most half as long as a chunk.
+		SigScanner(IMemorySource* pSource, size_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+		SigScanner(SigScanner&&) = delete;
+
+		SigScanner(const SigScanner&) = delete;
+
+		SigScanner& operator=(SigScanner&&) = delete;
+
+		SigScanner& operator=(const SigScanner&) = delete;
+
+		~SigScanner();
+
+		// Finds the first address of a byte signature within the memory source.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] signature:
+		// The byte signature that should be looked for.
+		// 
+		// Return:
+		// The address where the byte signature was found within the address space of the memory source.
+		// Nullpointer if the signature was not found or the function failed.
+		const BYTE* find(const void* base, size_t size, const mem::Signature& signature);
+
+		// Finds the first address of a byte signature within the memory source.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] bytes:
+		// Bytes of the signature. Bytes at wildcard positions are ignored.
+		// 
+		// [in] mask:
+		// Mask of the signature. 0xFF if the byte at the position has to match, 0x00 for wildcards.
+		// 
+		// [in] sigSize:
+		// Size of the signature in bytes.
+		// 
+		// Return:
+		// The address where the byte signature was found within the address space of the memory source.
+		// Nullpointer if the signature was not found or the function failed.
+		const BYTE* find(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize);
+
+		// Finds all addresses of a byte signature within the memory source.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] signature:
+		// The byte signature that should be looked for.
+		// 
+		// [in] callback:
+		// Called for every match in ascending order of the addresses within the address space of the memory source until it returns false.
+		// 
+		// [in] pArg:
+		// Argument passed to the callback.
+		// 
+		// Return:
+		// The number of matches passed to the callback.
+		size_t findAll(const void* base, size_t size, const mem::Signature& signature, mem::tMatchCallback callback, void* pArg);
+
+		// Finds all addresses of a byte signature within the memory source.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] bytes:
+		// Bytes of the signature. Bytes at wildcard positions are ignored.
+		// 
+		// [in] mask:
+		// Mask of the signature. 0xFF if the byte at the position has to match, 0x00 for wildcards.
+		// 
+		// [in] sigSize:
+		// Size of the signature in bytes.
+		// 
+		// [in] callback:
+		// Called for every match in ascending order of the addresses within the address space of the memory source until it returns false.
+		// 
+		// [in] pArg:
+		// Argument passed to the callback.
+		// 
+		// Return:
+		// The number of matches passed to the callback.
+		size_t findAll(const void* base, size_t size, const BYTE* bytes, const BYTE* mask, size_t sigSize, mem::tMatchCallback callback, void* pArg);
+
+		// Finds the first addresses of multiple byte signatures within the memory source.
+		// Every chunk is only read and scanned once for all signatures. The scan stops as soon as all signatures are found.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] bytes:
+		// Array of the bytes of the signatures. Bytes at wildcard positions are ignored.
+		// 
+		// [in] masks:
+		// Array of the masks of the signatures. 0xFF if the byte at the position has to match, 0x00 for wildcards.
+		// 
+		// [in] sigSizes:
+		// Array of the sizes of the signatures in bytes.
+		// 
+		// [in/out] addresses:
+		// Array that receives the addresses where the signatures were found within the address space of the memory source.
+		// Entries that are not nullptr on input are treated as already found and are not searched for.
+		// Entries of signatures that were not found are left untouched.
+		// 
+		// [in] count:
+		// Number of signatures. All arrays need to have this many entries.
+		// 
+		// Return:
+		// Number of signatures found by the call.
+		size_t findEach(const void* base, size_t size, const BYTE* const bytes[], const BYTE* const masks[], const size_t sigSizes[], void* addresses[], size_t count);
+
+	private:
+		// scans a buffer that holds the memory at an address of the memory source, returns false to stop the walk
+		typedef bool (*tScanBuffer)(const BYTE* buffer, size_t size, const BYTE* address, void* pArg);
+
+		size_t scan(const void* base, size_t size, const Pattern* pPattern, mem::tMatchCallback callback, void* pArg);
+		// walks the memory and passes it to the buffer scan in chunks that overlap by the passed amount of bytes
+		void walk(const void* base, size_t size, size_t overlap, tScanBuffer scanBuffer, void* pArg);
+	};
+
+}
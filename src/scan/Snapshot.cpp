@@ -0,0 +1,478 @@
+#include "Snapshot.h"
+#include <intrin.h>
+
+namespace hax {
+
+	// layout of the beginning of a snapshot file, followed by the page table and the deduplicated page data at dataOffset
+	typedef struct SnapshotFileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint64_t pageSize;
+		uint64_t pageCount;
+		uint64_t uniqueCount;
+		uint64_t pagesOffset;
+		uint64_t dataOffset;
+	}SnapshotFileHeader;
+
+	// "HXSS"
+	static constexpr uint32_t SNAPSHOT_MAGIC = 0x53535848u;
+	static constexpr uint32_t SNAPSHOT_VERSION = 1u;
+
+	static uint64_t hashPage(const BYTE* content);
+	static bool isPageEqual(const BYTE* content1, const BYTE* content2);
+	// appends the ranges of differing bytes of two buffers
+	static void diffBytes(const BYTE* old, const BYTE* cur, size_t size, const BYTE* address, Vector<ChangedRange>* pChanges);
+	static void appendChange(Vector<ChangedRange>* pChanges, const BYTE* address, size_t size);
+	static bool writeAll(HANDLE hFile, const void* buffer, size_t size);
+
+	Snapshot::Snapshot() :
+		_ownPages{}, _ownData{}, _ownDataCapacity{}, _hashes{}, _hashTable{}, _hashTableCapacity{},
+		_pages{}, _pageCount{}, _data{}, _uniqueCount{} {}
+
+
+	Snapshot::~Snapshot() {
+		this->clear();
+
+		return;
+	}
+
+
+	size_t Snapshot::capture(IMemorySource* pSource, const void* base, size_t size) {
+		this->clear();
+
+		if (!pSource || !size) return 0u;
+
+		const uintptr_t start = reinterpret_cast<uintptr_t>(base) & ~(PAGE_SIZE - 1u);
+		const uintptr_t end = size > UINTPTR_MAX - reinterpret_cast<uintptr_t>(base) ? UINTPTR_MAX & ~(PAGE_SIZE - 1u) : (reinterpret_cast<uintptr_t>(base) + size + PAGE_SIZE - 1u) & ~(PAGE_SIZE - 1u);
+		BYTE* const buffer = new BYTE[PAGE_SIZE];
+		uintptr_t cur = start;
+
+		while (cur < end) {
+			MemoryRegion region{};
+
+			if (!pSource->queryRegion(reinterpret_cast<const BYTE*>(cur), &region)) break;
+
+			uintptr_t regionEnd = reinterpret_cast<uintptr_t>(region.base) + region.size;
+
+			if (regionEnd <= cur) break;
+
+			if (regionEnd > end) {
+				regionEnd = end;
+			}
+
+			for (; region.access != REGION_NO_ACCESS && cur + PAGE_SIZE <= regionEnd; cur += PAGE_SIZE) {
+				const BYTE* const address = reinterpret_cast<const BYTE*>(cur);
+				const BYTE* content = region.access == REGION_READABLE ? pSource->view(address, PAGE_SIZE) : nullptr;
+
+				if (!content) {
+					bool read = false;
+
+					if (region.access == REGION_READABLE) {
+						read = pSource->read(address, buffer, PAGE_SIZE);
+					}
+					else {
+						read = pSource->readProtected(address, buffer, PAGE_SIZE);
+					}
+
+					if (!read) continue;
+
+					content = buffer;
+				}
+
+				this->addPage(address, content);
+			}
+
+			// regions not aligned to pages are only captured in whole pages
+			cur = (regionEnd + PAGE_SIZE - 1u) & ~(PAGE_SIZE - 1u);
+		}
+
+		delete[] buffer;
+
+		// lookup is only needed while capturing
+		this->_hashes.resize(0u);
+		delete[] this->_hashTable;
+		this->_hashTable = nullptr;
+		this->_hashTableCapacity = 0u;
+
+		return this->_pageCount;
+	}
+
+
+	bool Snapshot::open(const BYTE* data, size_t size) {
+		this->clear();
+
+		if (!data || size < sizeof(SnapshotFileHeader)) return false;
+
+		const SnapshotFileHeader* const pHeader = reinterpret_cast<const SnapshotFileHeader*>(data);
+
+		if (pHeader->magic != SNAPSHOT_MAGIC || pHeader->version != SNAPSHOT_VERSION || pHeader->pageSize != PAGE_SIZE) return false;
+
+		if (pHeader->pagesOffset > size || pHeader->pageCount > (size - pHeader->pagesOffset) / sizeof(Page)) return false;
+
+		if (pHeader->dataOffset > size || pHeader->uniqueCount > (size - pHeader->dataOffset) / PAGE_SIZE) return false;
+
+		const Page* const pages = reinterpret_cast<const Page*>(data + pHeader->pagesOffset);
+
+		for (uint64_t i = 0u; i < pHeader->pageCount; i++) {
+
+			if (pages[i].dataIndex >= pHeader->uniqueCount) return false;
+
+			// lookup relies on the order
+			if (i && pages[i].address <= pages[i - 1u].address) return false;
+
+		}
+
+		this->_pages = pages;
+		this->_pageCount = static_cast<size_t>(pHeader->pageCount);
+		this->_data = data + pHeader->dataOffset;
+		this->_uniqueCount = static_cast<size_t>(pHeader->uniqueCount);
+
+		return true;
+	}
+
+
+	DWORD Snapshot::save(const char* path) const {
+		const HANDLE hFile = CreateFileA(path, GENERIC_WRITE, 0ul, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+		if (hFile == INVALID_HANDLE_VALUE) {
+
+			return GetLastError();
+		}
+
+		SnapshotFileHeader header{};
+		header.magic = SNAPSHOT_MAGIC;
+		header.version = SNAPSHOT_VERSION;
+		header.pageSize = PAGE_SIZE;
+		header.pageCount = this->_pageCount;
+		header.uniqueCount = this->_uniqueCount;
+		header.pagesOffset = sizeof(SnapshotFileHeader);
+		// page data is aligned to pages within the file, so mapped pages are aligned as well
+		header.dataOffset = (header.pagesOffset + this->_pageCount * sizeof(Page) + PAGE_SIZE - 1u) & ~(PAGE_SIZE - 1u);
+
+		const size_t padding = static_cast<size_t>(header.dataOffset - header.pagesOffset - this->_pageCount * sizeof(Page));
+		BYTE* const zeros = new BYTE[PAGE_SIZE]{};
+
+		const bool written = writeAll(hFile, &header, sizeof(header)) && writeAll(hFile, this->_pages, this->_pageCount * sizeof(Page)) &&
+			writeAll(hFile, zeros, padding) && writeAll(hFile, this->_data, this->_uniqueCount * PAGE_SIZE);
+
+		delete[] zeros;
+
+		if (!written) {
+			const DWORD error = GetLastError();
+			CloseHandle(hFile);
+
+			return error;
+		}
+
+		CloseHandle(hFile);
+
+		return ERROR_SUCCESS;
+	}
+
+
+	size_t Snapshot::diff(const Snapshot& newer, Vector<ChangedRange>* pChanges, bool pagesOnly) const {
+		const size_t prevSize = pChanges->size();
+		size_t i = 0u;
+		size_t j = 0u;
+
+		// both page tables are sorted, so they are walked in one pass
+		while (i < this->_pageCount || j < newer._pageCount) {
+			const Page* const pOld = i < this->_pageCount ? &this->_pages[i] : nullptr;
+			const Page* const pNew = j < newer._pageCount ? &newer._pages[j] : nullptr;
+
+			if (!pNew || (pOld && pOld->address < pNew->address)) {
+				appendChange(pChanges, reinterpret_cast<const BYTE*>(pOld->address), PAGE_SIZE);
+				i++;
+
+				continue;
+			}
+
+			if (!pOld || pNew->address < pOld->address) {
+				appendChange(pChanges, reinterpret_cast<const BYTE*>(pNew->address), PAGE_SIZE);
+				j++;
+
+				continue;
+			}
+
+			const BYTE* const oldContent = this->_data + pOld->dataIndex * PAGE_SIZE;
+			const BYTE* const newContent = newer._data + pNew->dataIndex * PAGE_SIZE;
+
+			if (pagesOnly) {
+
+				if (!isPageEqual(oldContent, newContent)) {
+					appendChange(pChanges, reinterpret_cast<const BYTE*>(pOld->address), PAGE_SIZE);
+				}
+
+			}
+			else {
+				diffBytes(oldContent, newContent, PAGE_SIZE, reinterpret_cast<const BYTE*>(pOld->address), pChanges);
+			}
+
+			i++;
+			j++;
+		}
+
+		return pChanges->size() - prevSize;
+	}
+
+
+	const BYTE* Snapshot::getPage(const void* address) const {
+		const uint64_t pageAddress = reinterpret_cast<uintptr_t>(address) & ~(PAGE_SIZE - 1u);
+		size_t low = 0u;
+		size_t high = this->_pageCount;
+
+		while (low < high) {
+			const size_t mid = low + (high - low) / 2u;
+
+			if (this->_pages[mid].address < pageAddress) {
+				low = mid + 1u;
+			}
+			else {
+				high = mid;
+			}
+
+		}
+
+		if (low == this->_pageCount || this->_pages[low].address != pageAddress) return nullptr;
+
+		return this->_data + this->_pages[low].dataIndex * PAGE_SIZE;
+	}
+
+
+	size_t Snapshot::pageCount() const {
+
+		return this->_pageCount;
+	}
+
+
+	size_t Snapshot::uniquePageCount() const {
+
+		return this->_uniqueCount;
+	}
+
+
+	void Snapshot::clear() {
+		this->_ownPages.resize(0u);
+		this->_hashes.resize(0u);
+
+		if (this->_ownData) {
+			free(this->_ownData);
+			this->_ownData = nullptr;
+		}
+
+		if (this->_hashTable) {
+			delete[] this->_hashTable;
+			this->_hashTable = nullptr;
+		}
+
+		this->_ownDataCapacity = 0u;
+		this->_hashTableCapacity = 0u;
+		this->_pages = nullptr;
+		this->_pageCount = 0u;
+		this->_data = nullptr;
+		this->_uniqueCount = 0u;
+
+		return;
+	}
+
+
+	void Snapshot::addPage(const BYTE* address, const BYTE* content) {
+		const uint64_t hash = hashPage(content);
+
+		// keeps the table at most half full
+		if (2u * (this->_uniqueCount + 1u) > this->_hashTableCapacity) {
+			this->growHashTable();
+		}
+
+		size_t slot = static_cast<size_t>(hash) & (this->_hashTableCapacity - 1u);
+		size_t dataIndex = SIZE_MAX;
+
+		for (; this->_hashTable[slot]; slot = (slot + 1u) & (this->_hashTableCapacity - 1u)) {
+			const size_t index = this->_hashTable[slot] - 1u;
+
+			if (this->_hashes[index] == hash && isPageEqual(this->_ownData + index * PAGE_SIZE, content)) {
+				dataIndex = index;
+
+				break;
+			}
+
+		}
+
+		if (dataIndex == SIZE_MAX) {
+
+			if (this->_uniqueCount == this->_ownDataCapacity) {
+				const size_t capacity = this->_ownDataCapacity ? 2u * this->_ownDataCapacity : 0x10u;
+				BYTE* const data = reinterpret_cast<BYTE*>(realloc(this->_ownData, capacity * PAGE_SIZE));
+
+				if (!data) return;
+
+				this->_ownData = data;
+				this->_ownDataCapacity = capacity;
+			}
+
+			dataIndex = this->_uniqueCount;
+			memcpy(this->_ownData + dataIndex * PAGE_SIZE, content, PAGE_SIZE);
+			this->_hashes.append(hash);
+			this->_hashTable[slot] = dataIndex + 1u;
+			this->_uniqueCount++;
+		}
+
+		const Page page{ reinterpret_cast<uintptr_t>(address), dataIndex };
+		this->_ownPages.append(page);
+
+		this->_pages = this->_ownPages.data();
+		this->_pageCount = this->_ownPages.size();
+		this->_data = this->_ownData;
+
+		return;
+	}
+
+
+	void Snapshot::growHashTable() {
+		const size_t capacity = this->_hashTableCapacity ? 2u * this->_hashTableCapacity : 0x40u;
+		size_t* const table = new size_t[capacity]{};
+
+		for (size_t i = 0u; i < this->_uniqueCount; i++) {
+			size_t slot = static_cast<size_t>(this->_hashes[i]) & (capacity - 1u);
+
+			while (table[slot]) {
+				slot = (slot + 1u) & (capacity - 1u);
+			}
+
+			table[slot] = i + 1u;
+		}
+
+		delete[] this->_hashTable;
+		this->_hashTable = table;
+		this->_hashTableCapacity = capacity;
+
+		return;
+	}
+
+
+	static uint64_t hashPage(const BYTE* content) {
+		// four independent lanes so the multiplications do not wait for each other
+		uint64_t lanes[4]{ 0xCBF29CE484222325ull, 0x84222325CBF29CE4ull, 0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full };
+
+		for (size_t i = 0u; i < Snapshot::PAGE_SIZE; i += sizeof(lanes)) {
+
+			for (size_t lane = 0u; lane < 4u; lane++) {
+				uint64_t word = 0u;
+				memcpy(&word, content + i + lane * sizeof(uint64_t), sizeof(word));
+				lanes[lane] = (lanes[lane] ^ word) * 0x100000001B3ull;
+				lanes[lane] ^= lanes[lane] >> 29u;
+			}
+
+		}
+
+		// good enough for a table that compares the pages on hits anyway
+		return lanes[0] ^ lanes[1] * 3u ^ lanes[2] * 5u ^ lanes[3] * 7u;
+	}
+
+
+
+	static bool isPageEqual(const BYTE* content1, const BYTE* content2) {
+
+		for (size_t i = 0u; i < Snapshot::PAGE_SIZE; i += 4u * sizeof(__m128i)) {
+			const __m128i* const p1 = reinterpret_cast<const __m128i*>(content1 + i);
+			const __m128i* const p2 = reinterpret_cast<const __m128i*>(content2 + i);
+			const __m128i equal01 = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(p1), _mm_loadu_si128(p2)), _mm_cmpeq_epi8(_mm_loadu_si128(p1 + 1), _mm_loadu_si128(p2 + 1)));
+			const __m128i equal23 = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(p1 + 2), _mm_loadu_si128(p2 + 2)), _mm_cmpeq_epi8(_mm_loadu_si128(p1 + 3), _mm_loadu_si128(p2 + 3)));
+
+			if (_mm_movemask_epi8(_mm_and_si128(equal01, equal23)) != 0xFFFF) return false;
+
+		}
+
+		return true;
+	}
+
+
+	static void diffBytes(const BYTE* old, const BYTE* cur, size_t size, const BYTE* address, Vector<ChangedRange>* pChanges) {
+		size_t i = 0u;
+
+		while (i + sizeof(__m128i) <= size) {
+			const __m128i* const pOld = reinterpret_cast<const __m128i*>(old + i);
+			const __m128i* const pCur = reinterpret_cast<const __m128i*>(cur + i);
+
+			// skips four equal vectors at once
+			if (i + 4u * sizeof(__m128i) <= size) {
+				const __m128i equal01 = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(pOld), _mm_loadu_si128(pCur)), _mm_cmpeq_epi8(_mm_loadu_si128(pOld + 1), _mm_loadu_si128(pCur + 1)));
+				const __m128i equal23 = _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128(pOld + 2), _mm_loadu_si128(pCur + 2)), _mm_cmpeq_epi8(_mm_loadu_si128(pOld + 3), _mm_loadu_si128(pCur + 3)));
+
+				if (_mm_movemask_epi8(_mm_and_si128(equal01, equal23)) == 0xFFFF) {
+					i += 4u * sizeof(__m128i);
+
+					continue;
+				}
+
+			}
+
+			uint32_t changed = ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(pOld), _mm_loadu_si128(pCur)))) & 0xFFFFu;
+
+			// runs of changed bytes within the vector
+			while (changed) {
+				unsigned long first = 0ul;
+				_BitScanForward(&first, changed);
+				unsigned long length = 0ul;
+
+				// the inverted bits above the run have a lowest set bit where the run ends
+				const uint32_t above = ~(changed >> first);
+				_BitScanForward(&length, above);
+
+				appendChange(pChanges, address + i + first, length);
+				changed &= ~(((1u << length) - 1u) << first);
+			}
+
+			i += sizeof(__m128i);
+		}
+
+		for (; i < size; i++) {
+
+			if (old[i] != cur[i]) {
+				appendChange(pChanges, address + i, 1u);
+			}
+
+		}
+
+		return;
+	}
+
+
+	static void appendChange(Vector<ChangedRange>* pChanges, const BYTE* address, size_t size) {
+
+		if (pChanges->size()) {
+			ChangedRange* const pLast = &(*pChanges)[pChanges->size() - 1u];
+
+			if (pLast->address + pLast->size == address) {
+				pLast->size += size;
+
+				return;
+			}
+
+		}
+
+		const ChangedRange range{ address, size };
+		pChanges->append(range);
+
+		return;
+	}
+
+
+	static bool writeAll(HANDLE hFile, const void* buffer, size_t size) {
+		const BYTE* cur = reinterpret_cast<const BYTE*>(buffer);
+
+		// WriteFile takes sizes of 32 bits
+		while (size) {
+			const DWORD toWrite = size > 0x40000000u ? 0x40000000ul : static_cast<DWORD>(size);
+			DWORD written = 0ul;
+
+			if (!WriteFile(hFile, cur, toWrite, &written, nullptr) || !written) return false;
+
+			cur += written;
+			size -= written;
+		}
+
+		return true;
+	}
+
+}
@@ -0,0 +1,150 @@
+#pragma once
+#include "IMemorySource.h"
+#include "..\Vector.h"
+#include <stdint.h>
+
+namespace hax {
+
+	// Range of bytes that differ between two snapshots.
+	typedef struct ChangedRange {
+		const BYTE* address;
+		size_t size;
+	}ChangedRange;
+
+	// Class to capture the pages of a memory source and diff them against another capture.
+	// Pages with identical content are only stored once.
+	// A snapshot can be saved to a file and reopened from the file mapped into memory, eg. by a FileMapper object, without copying it.
+	// Capturing and diffing only depends on the memory source, so it works the same for processes and buffers.
+	class Snapshot {
+	public:
+		static constexpr size_t PAGE_SIZE = 0x1000u;
+
+		// Entry of the page table sorted by address. Layout is shared with the file format.
+		typedef struct Page {
+			uint64_t address;
+			// index of the content of the page within the deduplicated page data
+			uint64_t dataIndex;
+		}Page;
+
+	private:
+		Vector<Page> _ownPages;
+		BYTE* _ownData;
+		size_t _ownDataCapacity;
+		// hashes of the deduplicated pages and an open addressing table of their indices plus one for lookup while capturing
+		Vector<uint64_t> _hashes;
+		size_t* _hashTable;
+		size_t _hashTableCapacity;
+
+		// either the own page table and data or memory of an opened file
+		const Page* _pages;
+		size_t _pageCount;
+		const BYTE* _data;
+		size_t _uniqueCount;
+
+	public:
+		Snapshot();
+
+		Snapshot(Snapshot&&) = delete;
+
+		Snapshot(const Snapshot&) = delete;
+
+		Snapshot& operator=(Snapshot&&) = delete;
+
+		Snapshot& operator=(const Snapshot&) = delete;
+
+		~Snapshot();
+
+		// Captures all accessable pages of a range of a memory source. Replaces the current content of the snapshot.
+		// The range is extended to whole pages.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source that should be captured.
+		// 
+		// [in] base:
+		// Address where the capture should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be captured.
+		// 
+		// Return:
+		// The number of captured pages.
+		size_t capture(IMemorySource* pSource, const void* base, size_t size);
+
+		// Opens a snapshot from memory that holds a saved snapshot file. The memory is used in place and has to stay valid until the snapshot is cleared or destroyed.
+		// Replaces the current content of the snapshot.
+		// 
+		// Parameters:
+		// 
+		// [in] data:
+		// Pointer to the file content, eg. FileMapper::data().
+		// 
+		// [in] size:
+		// Size of the file content in bytes.
+		// 
+		// Return:
+		// True on success, false if the memory does not hold a valid snapshot file.
+		bool open(const BYTE* data, size_t size);
+
+		// Saves the snapshot to a file that can be mapped and opened again.
+		// 
+		// Parameters:
+		// 
+		// [in] path:
+		// Path of the file. An existing file is overwritten.
+		// 
+		// Return:
+		// ERROR_SUCCESS on success, last WinError on failure.
+		DWORD save(const char* path) const;
+
+		// Compares the snapshot to a newer one of the same memory.
+		// Pages that are only contained in one of the snapshots count as completely changed.
+		// 
+		// Parameters:
+		// 
+		// [in] newer:
+		// The snapshot to compare to.
+		// 
+		// [out] pChanges:
+		// Vector the changes are appended to in ascending order. Adjacent changes are merged into one range.
+		// 
+		// [in] pagesOnly:
+		// Report whole changed pages instead of the exact changed bytes. Faster, as comparing a page stops at the first difference.
+		// 
+		// Return:
+		// The number of ranges appended.
+		size_t diff(const Snapshot& newer, Vector<ChangedRange>* pChanges, bool pagesOnly = false) const;
+
+		// Gets the content of a captured page.
+		// 
+		// Parameters:
+		// 
+		// [in] address:
+		// Address within the page.
+		// 
+		// Return:
+		// Pointer to the content of the page or nullptr if the page was not captured.
+		const BYTE* getPage(const void* address) const;
+
+		// Gets the number of captured pages.
+		// 
+		// Return:
+		// The number of captured pages.
+		size_t pageCount() const;
+
+		// Gets the number of pages with distinct content that are actually stored.
+		// 
+		// Return:
+		// The number of stored pages.
+		size_t uniquePageCount() const;
+
+		// Drops all pages.
+		void clear();
+
+	private:
+		void addPage(const BYTE* address, const BYTE* content);
+		void growHashTable();
+	};
+
+}
@@ -0,0 +1,533 @@
+#include "ValueScanner.h"
+#include <intrin.h>
+
+namespace hax {
+
+	// candidates are grouped in blocks of this size to store their addresses as 16 bit offsets
+	static constexpr size_t BLOCK_SIZE = 0x10000u;
+	// memory of the first scan is read in chunks of this size
+	static constexpr size_t CHUNK_SIZE = 0x10000u;
+	// maximum number of values compared at once
+	static constexpr size_t BATCH_COUNT = 0x400u;
+
+	static size_t getValueSize(ValueType type);
+	// compares values to references and stores the result for every value, references is a single value if singleReference is set
+	static void compareValues(ValueType type, ValueCondition condition, const BYTE* values, const BYTE* references, bool singleReference, size_t count, bool* results);
+
+	ValueScanner::ValueScanner(IMemorySource* pSource, ValueType type, size_t alignment) :
+		_pSource{ pSource }, _type{ type }, _valueSize{ getValueSize(type) }, _alignment{ alignment ? alignment : getValueSize(type) },
+		_blocks{}, _offsets{}, _values{}, _buffer{}, _batch{}, _results{} {
+		// values starting at the end of a chunk reach into the following bytes
+		this->_buffer = new BYTE[CHUNK_SIZE + sizeof(uint64_t)];
+		this->_batch = new BYTE[BATCH_COUNT * sizeof(uint64_t)];
+		this->_results = new bool[BATCH_COUNT];
+
+		return;
+	}
+
+
+	ValueScanner::~ValueScanner() {
+		delete[] this->_buffer;
+		delete[] this->_batch;
+		delete[] this->_results;
+
+		return;
+	}
+
+
+	size_t ValueScanner::firstScan(const void* base, size_t size, const void* pValue) {
+		this->reset();
+
+		if (!this->_pSource || !pValue) return 0u;
+
+		const BYTE* cur = reinterpret_cast<const BYTE*>(base);
+		const BYTE* const end = size > UINTPTR_MAX - reinterpret_cast<uintptr_t>(cur) ? reinterpret_cast<const BYTE*>(UINTPTR_MAX) : cur + size;
+
+		while (cur < end) {
+			MemoryRegion region{};
+
+			if (!this->_pSource->queryRegion(cur, &region)) break;
+
+			const BYTE* regionEnd = region.base + region.size;
+
+			if (regionEnd <= cur) break;
+
+			if (regionEnd > end) {
+				regionEnd = end;
+			}
+
+			if (region.access == REGION_NO_ACCESS) {
+				cur = regionEnd;
+
+				continue;
+			}
+
+			while (cur < regionEnd) {
+				const size_t rest = regionEnd - cur;
+				const size_t chunkSize = rest < CHUNK_SIZE ? rest : CHUNK_SIZE;
+				// values starting at the end of the chunk may reach into the following bytes of the region
+				const size_t dataSize = rest < chunkSize + this->_valueSize - 1u ? rest : chunkSize + this->_valueSize - 1u;
+				const BYTE* data = region.access == REGION_READABLE ? this->_pSource->view(cur, dataSize) : nullptr;
+
+				if (!data) {
+					bool read = false;
+
+					if (region.access == REGION_READABLE) {
+						read = this->_pSource->read(cur, this->_buffer, dataSize);
+					}
+					else {
+						read = this->_pSource->readProtected(cur, this->_buffer, dataSize);
+					}
+
+					data = read ? this->_buffer : nullptr;
+				}
+
+				if (data) {
+					this->scanChunk(cur, data, chunkSize, dataSize, pValue);
+				}
+
+				cur += chunkSize;
+			}
+
+		}
+
+		return this->count();
+	}
+
+
+	size_t ValueScanner::nextScan(ValueCondition condition, const void* pValue) {
+
+		if (!this->_pSource || (condition == VALUE_EQUALS && !pValue)) return this->count();
+
+		size_t kept = 0u;
+		size_t keptBlocks = 0u;
+
+		for (size_t i = 0u; i < this->_blocks.size(); i++) {
+			const size_t keptInBlock = this->narrowBlock(i, kept, condition, pValue);
+
+			if (!keptInBlock) continue;
+
+			// blocks are compacted in place as well, the block at keptBlocks has already been narrowed
+			const CandidateBlock block{ this->_blocks[i].base, kept, keptInBlock };
+			this->_blocks[keptBlocks] = block;
+			keptBlocks++;
+			kept += keptInBlock;
+		}
+
+		this->_blocks.resize(keptBlocks);
+		this->_offsets.resize(kept);
+		this->_values.resize(kept * this->_valueSize);
+
+		return kept;
+	}
+
+
+	size_t ValueScanner::count() const {
+
+		return this->_offsets.size();
+	}
+
+
+	bool ValueScanner::getCandidate(size_t index, const BYTE** pAddress, void* pValue) const {
+
+		if (index >= this->count()) return false;
+
+		// binary search for the block of the candidate
+		size_t low = 0u;
+		size_t high = this->_blocks.size();
+
+		while (high - low > 1u) {
+			const size_t mid = low + (high - low) / 2u;
+
+			if (this->_blocks[mid].first <= index) {
+				low = mid;
+			}
+			else {
+				high = mid;
+			}
+
+		}
+
+		*pAddress = this->_blocks[low].base + this->_offsets[index];
+
+		if (pValue) {
+			memcpy(pValue, this->_values.data() + index * this->_valueSize, this->_valueSize);
+		}
+
+		return true;
+	}
+
+
+	void ValueScanner::reset() {
+		this->_blocks.resize(0u);
+		this->_offsets.resize(0u);
+		this->_values.resize(0u);
+
+		return;
+	}
+
+
+	void ValueScanner::scanChunk(const BYTE* address, const BYTE* data, size_t chunkSize, size_t dataSize, const void* pValue) {
+		// offset of the first aligned address within the chunk
+		size_t offset = (this->_alignment - reinterpret_cast<uintptr_t>(address) % this->_alignment) % this->_alignment;
+
+		while (offset < chunkSize && offset + this->_valueSize <= dataSize) {
+			const BYTE* values = data + offset;
+			size_t count = 0u;
+
+			// values aligned to their size are contiguous and compared in place
+			if (this->_alignment == this->_valueSize) {
+				count = (dataSize - offset) / this->_valueSize;
+				const size_t chunkCount = (chunkSize - offset + this->_valueSize - 1u) / this->_valueSize;
+
+				if (count > chunkCount) {
+					count = chunkCount;
+				}
+
+				if (count > BATCH_COUNT) {
+					count = BATCH_COUNT;
+				}
+
+			}
+			else {
+
+				for (size_t cur = offset; count < BATCH_COUNT && cur < chunkSize && cur + this->_valueSize <= dataSize; cur += this->_alignment) {
+					memcpy(this->_batch + count * this->_valueSize, data + cur, this->_valueSize);
+					count++;
+				}
+
+				values = this->_batch;
+			}
+
+			compareValues(this->_type, VALUE_EQUALS, values, reinterpret_cast<const BYTE*>(pValue), true, count, this->_results);
+
+			for (size_t i = 0u; i < count; i++) {
+
+				if (!this->_results[i]) continue;
+
+				this->appendCandidate(address + offset + i * this->_alignment, values + i * this->_valueSize);
+			}
+
+			offset += count * this->_alignment;
+		}
+
+		return;
+	}
+
+
+	void ValueScanner::appendCandidate(const BYTE* address, const BYTE* pValue) {
+		CandidateBlock* pBlock = this->_blocks.size() ? this->_blocks + (this->_blocks.size() - 1u) : nullptr;
+
+		if (!pBlock || address >= pBlock->base + BLOCK_SIZE) {
+			const CandidateBlock block{ reinterpret_cast<const BYTE*>(reinterpret_cast<uintptr_t>(address) & ~(BLOCK_SIZE - 1u)), this->_offsets.size(), 0u };
+			this->_blocks.append(block);
+			pBlock = this->_blocks + (this->_blocks.size() - 1u);
+		}
+
+		this->_offsets.append(static_cast<uint16_t>(address - pBlock->base));
+
+		for (size_t i = 0u; i < this->_valueSize; i++) {
+			this->_values.append(pValue[i]);
+		}
+
+		pBlock->count++;
+
+		return;
+	}
+
+
+	size_t ValueScanner::narrowBlock(size_t blockIndex, size_t kept, ValueCondition condition, const void* pValue) {
+		const CandidateBlock block = this->_blocks[blockIndex];
+		const size_t end = block.first + block.count;
+		const BYTE* cur = block.base + this->_offsets[block.first];
+		const BYTE* const rangeEnd = block.base + this->_offsets[end - 1u] + this->_valueSize;
+		size_t index = block.first;
+		size_t written = kept;
+
+		while (cur < rangeEnd && index < end) {
+			MemoryRegion region{};
+
+			if (!this->_pSource->queryRegion(cur, &region)) break;
+
+			const BYTE* pieceEnd = region.base + region.size;
+
+			if (pieceEnd <= cur) break;
+
+			if (pieceEnd > rangeEnd) {
+				pieceEnd = rangeEnd;
+			}
+
+			const size_t pieceSize = pieceEnd - cur;
+			const BYTE* data = nullptr;
+
+			if (region.access == REGION_READABLE) {
+				data = this->_pSource->view(cur, pieceSize);
+
+				if (!data && this->_pSource->read(cur, this->_buffer, pieceSize)) {
+					data = this->_buffer;
+				}
+
+			}
+			else if (region.access == REGION_PROTECTED && this->_pSource->readProtected(cur, this->_buffer, pieceSize)) {
+				data = this->_buffer;
+			}
+
+			// candidates that are not readable or cross into the next region are dropped
+			while (data && index < end) {
+				size_t count = 0u;
+
+				while (index + count < end && count < BATCH_COUNT) {
+					const BYTE* const address = block.base + this->_offsets[index + count];
+
+					if (address + this->_valueSize > pieceEnd) break;
+
+					memcpy(this->_batch + count * this->_valueSize, data + (address - cur), this->_valueSize);
+					count++;
+				}
+
+				if (!count) break;
+
+				if (condition == VALUE_EQUALS) {
+					compareValues(this->_type, condition, this->_batch, reinterpret_cast<const BYTE*>(pValue), true, count, this->_results);
+				}
+				else {
+					compareValues(this->_type, condition, this->_batch, this->_values + index * this->_valueSize, false, count, this->_results);
+				}
+
+				for (size_t i = 0u; i < count; i++) {
+
+					if (!this->_results[i]) continue;
+
+					this->_offsets[written] = this->_offsets[index + i];
+					memcpy(this->_values + written * this->_valueSize, this->_batch + i * this->_valueSize, this->_valueSize);
+					written++;
+				}
+
+				index += count;
+			}
+
+			while (index < end && block.base + this->_offsets[index] < pieceEnd) {
+				index++;
+			}
+
+			cur = pieceEnd;
+		}
+
+		return written - kept;
+	}
+
+
+	template <typename T>
+	static bool compareScalar(ValueCondition condition, T value, T reference) {
+
+		switch (condition) {
+		case VALUE_EQUALS:
+		case VALUE_UNCHANGED:
+
+			return value == reference;
+		case VALUE_CHANGED:
+
+			return value != reference;
+		case VALUE_INCREASED:
+
+			return value > reference;
+		case VALUE_DECREASED:
+
+			return value < reference;
+		default:
+
+			return false;
+		}
+
+	}
+
+
+	// compares four 32 bit integers, returns all bits set for every lane that meets the condition
+	static __m128i compareVector(ValueCondition condition, __m128i values, __m128i references, int32_t) {
+
+		switch (condition) {
+		case VALUE_EQUALS:
+		case VALUE_UNCHANGED:
+
+			return _mm_cmpeq_epi32(values, references);
+		case VALUE_CHANGED:
+
+			return _mm_xor_si128(_mm_cmpeq_epi32(values, references), _mm_set1_epi32(-1));
+		case VALUE_INCREASED:
+
+			return _mm_cmpgt_epi32(values, references);
+		case VALUE_DECREASED:
+
+			return _mm_cmplt_epi32(values, references);
+		default:
+
+			return _mm_setzero_si128();
+		}
+
+	}
+
+
+	// compares two 64 bit integers, SSE2 has no 64 bit greater than so only equality is supported
+	static __m128i compareVector(ValueCondition condition, __m128i values, __m128i references, int64_t) {
+		const __m128i equal32 = _mm_cmpeq_epi32(values, references);
+		// both halves of a lane have to be equal
+		const __m128i equal64 = _mm_and_si128(equal32, _mm_shuffle_epi32(equal32, _MM_SHUFFLE(2, 3, 0, 1)));
+
+		if (condition == VALUE_CHANGED) return _mm_xor_si128(equal64, _mm_set1_epi32(-1));
+
+		return equal64;
+	}
+
+
+	static __m128i compareVector(ValueCondition condition, __m128i values, __m128i references, float) {
+		const __m128 valuesPs = _mm_castsi128_ps(values);
+		const __m128 referencesPs = _mm_castsi128_ps(references);
+
+		switch (condition) {
+		case VALUE_EQUALS:
+		case VALUE_UNCHANGED:
+
+			return _mm_castps_si128(_mm_cmpeq_ps(valuesPs, referencesPs));
+		case VALUE_CHANGED:
+
+			return _mm_castps_si128(_mm_cmpneq_ps(valuesPs, referencesPs));
+		case VALUE_INCREASED:
+
+			return _mm_castps_si128(_mm_cmpgt_ps(valuesPs, referencesPs));
+		case VALUE_DECREASED:
+
+			return _mm_castps_si128(_mm_cmplt_ps(valuesPs, referencesPs));
+		default:
+
+			return _mm_setzero_si128();
+		}
+
+	}
+
+
+	static __m128i compareVector(ValueCondition condition, __m128i values, __m128i references, double) {
+		const __m128d valuesPd = _mm_castsi128_pd(values);
+		const __m128d referencesPd = _mm_castsi128_pd(references);
+
+		switch (condition) {
+		case VALUE_EQUALS:
+		case VALUE_UNCHANGED:
+
+			return _mm_castpd_si128(_mm_cmpeq_pd(valuesPd, referencesPd));
+		case VALUE_CHANGED:
+
+			return _mm_castpd_si128(_mm_cmpneq_pd(valuesPd, referencesPd));
+		case VALUE_INCREASED:
+
+			return _mm_castpd_si128(_mm_cmpgt_pd(valuesPd, referencesPd));
+		case VALUE_DECREASED:
+
+			return _mm_castpd_si128(_mm_cmplt_pd(valuesPd, referencesPd));
+		default:
+
+			return _mm_setzero_si128();
+		}
+
+	}
+
+
+	template <typename T>
+	static bool isVectorizable(ValueCondition) {
+
+		return true;
+	}
+
+
+	// 64 bit integers can only be compared for equality with SSE2
+	template <>
+	bool isVectorizable<int64_t>(ValueCondition condition) {
+
+		return condition == VALUE_EQUALS || condition == VALUE_UNCHANGED || condition == VALUE_CHANGED;
+	}
+
+
+	template <typename T>
+	static void compareValues(ValueCondition condition, const BYTE* values, const BYTE* references, bool singleReference, size_t count, bool* results) {
+		constexpr size_t LANES = sizeof(__m128i) / sizeof(T);
+		size_t i = 0u;
+
+		if (isVectorizable<T>(condition)) {
+			T broadcast[LANES]{};
+
+			if (singleReference) {
+
+				for (size_t lane = 0u; lane < LANES; lane++) {
+					memcpy(&broadcast[lane], references, sizeof(T));
+				}
+
+			}
+
+			const __m128i single = _mm_loadu_si128(reinterpret_cast<const __m128i*>(broadcast));
+
+			for (; i + LANES <= count; i += LANES) {
+				const __m128i cur = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i * sizeof(T)));
+				const __m128i ref = singleReference ? single : _mm_loadu_si128(reinterpret_cast<const __m128i*>(references + i * sizeof(T)));
+				const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(compareVector(condition, cur, ref, T{})));
+
+				for (size_t lane = 0u; lane < LANES; lane++) {
+					results[i + lane] = (mask >> (lane * sizeof(T))) & 1u;
+				}
+
+			}
+
+		}
+
+		for (; i < count; i++) {
+			T value{};
+			T reference{};
+			memcpy(&value, values + i * sizeof(T), sizeof(T));
+			memcpy(&reference, singleReference ? references : references + i * sizeof(T), sizeof(T));
+			results[i] = compareScalar(condition, value, reference);
+		}
+
+		return;
+	}
+
+
+	static void compareValues(ValueType type, ValueCondition condition, const BYTE* values, const BYTE* references, bool singleReference, size_t count, bool* results) {
+
+		switch (type) {
+		case VALUE_INT32:
+			compareValues<int32_t>(condition, values, references, singleReference, count, results);
+			break;
+		case VALUE_INT64:
+			compareValues<int64_t>(condition, values, references, singleReference, count, results);
+			break;
+		case VALUE_FLOAT:
+			compareValues<float>(condition, values, references, singleReference, count, results);
+			break;
+		case VALUE_DOUBLE:
+			compareValues<double>(condition, values, references, singleReference, count, results);
+			break;
+		default:
+			break;
+		}
+
+		return;
+	}
+
+
+	static size_t getValueSize(ValueType type) {
+
+		switch (type) {
+		case VALUE_INT32:
+		case VALUE_FLOAT:
+
+			return sizeof(int32_t);
+		case VALUE_INT64:
+		case VALUE_DOUBLE:
+
+			return sizeof(int64_t);
+		default:
+
+			return 0u;
+		}
+
+	}
+
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "IMemorySource.h"
+#include "..\Vector.h"
+#include <stdint.h>
+
+namespace hax {
+
+	typedef enum ValueType {
+		VALUE_INT32,
+		VALUE_INT64,
+		VALUE_FLOAT,
+		VALUE_DOUBLE
+	}ValueType;
+
+	typedef enum ValueCondition {
+		// the value equals a passed value
+		VALUE_EQUALS,
+		// the value differs from the value of the last scan
+		VALUE_CHANGED,
+		// the value equals the value of the last scan
+		VALUE_UNCHANGED,
+		// the value is greater than the value of the last scan
+		VALUE_INCREASED,
+		// the value is less than the value of the last scan
+		VALUE_DECREASED
+	}ValueCondition;
+
+	// Class to hunt for typed values in the memory of a memory source.
+	// A first scan collects all addresses that hold a value. Following scans narrow these candidates down by comparing their current values to a passed value or to the values of the last scan.
+	// Candidates are stored sorted by address as 16 bit offsets to 64 KB blocks together with their last values, memory around them is not kept.
+	// Values are compared with SSE2.
+	class ValueScanner {
+	private:
+		// candidates within 64 KB of memory
+		typedef struct CandidateBlock {
+			const BYTE* base;
+			// index of the first candidate of the block
+			size_t first;
+			size_t count;
+		}CandidateBlock;
+
+		IMemorySource* const _pSource;
+		const ValueType _type;
+		const size_t _valueSize;
+		const size_t _alignment;
+		Vector<CandidateBlock> _blocks;
+		Vector<uint16_t> _offsets;
+		Vector<BYTE> _values;
+		// holds memory that can not be accessed in place
+		BYTE* _buffer;
+		// holds a batch of values that are compared at once
+		BYTE* _batch;
+		bool* _results;
+
+	public:
+		// Initializes members.
+		// 
+		// Parameters:
+		// 
+		// [in] pSource:
+		// The memory source that should be scanned. Has to stay valid for the lifetime of the object.
+		// 
+		// [in] type:
+		// Type of the values.
+		// 
+		// [in] alignment:
+		// Alignment of the addresses values are looked for at. Zero to align to the size of the type.
+		// Values are only compared with SSE2 in the first scan if they are aligned to their size.
+		ValueScanner(IMemorySource* pSource, ValueType type, size_t alignment = 0u);
+
+		ValueScanner(ValueScanner&&) = delete;
+
+		ValueScanner(const ValueScanner&) = delete;
+
+		ValueScanner& operator=(ValueScanner&&) = delete;
+
+		ValueScanner& operator=(const ValueScanner&) = delete;
+
+		~ValueScanner();
+
+		// Collects all addresses within a range of the memory source that hold a value. Replaces all candidates of previous scans.
+		// 
+		// Parameters:
+		// 
+		// [in] base:
+		// Address where the search should start.
+		// 
+		// [in] size:
+		// Amount of bytes that should be searched.
+		// 
+		// [in] pValue:
+		// Pointer to the value that should be looked for. Has to be of the type of the scanner.
+		// 
+		// Return:
+		// The number of candidates.
+		size_t firstScan(const void* base, size_t size, const void* pValue);
+
+		// Narrows down the candidates of the previous scans to the ones whose current value meets a condition.
+		// Candidates that can not be read anymore are dropped.
+		// 
+		// Parameters:
+		// 
+		// [in] condition:
+		// The condition the current value of a candidate has to meet to be kept.
+		// 
+		// [in] pValue:
+		// Pointer to the value the current values are compared to for VALUE_EQUALS. Has to be of the type of the scanner. Ignored for the other conditions.
+		// 
+		// Return:
+		// The number of remaining candidates.
+		size_t nextScan(ValueCondition condition, const void* pValue = nullptr);
+
+		// Gets the number of candidates.
+		// 
+		// Return:
+		// The number of candidates.
+		size_t count() const;
+
+		// Gets a candidate by index. Candidates are sorted by address.
+		// 
+		// Parameters:
+		// 
+		// [in] index:
+		// Index of the candidate.
+		// 
+		// [out] pAddress:
+		// Receives the address of the candidate within the address space of the memory source.
+		// 
+		// [out] pValue:
+		// Receives the value of the candidate at the last scan. Has to be of the type of the scanner. Can be nullptr.
+		// 
+		// Return:
+		// True on success, false if the index is out of range.
+		bool getCandidate(size_t index, const BYTE** pAddress, void* pValue) const;
+
+		// Drops all candidates.
+		void reset();
+
+	private:
+		void scanChunk(const BYTE* address, const BYTE* data, size_t chunkSize, size_t dataSize, const void* pValue);
+		void appendCandidate(const BYTE* address, const BYTE* pValue);
+		size_t narrowBlock(size_t blockIndex, size_t kept, ValueCondition condition, const void* pValue);
+	};
+
+}